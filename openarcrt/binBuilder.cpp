@@ -25,8 +25,7 @@
 #include <sstream>
 
 #include "openacc.h"
-
-#define MAX_SOURCE_SIZE (0x100000)
+#include "kernel_source.h"
 
 static const char *omp_num_threads_env = "OMP_NUM_THREADS";
 static const char *acc_device_type_env = "ACC_DEVICE_TYPE";
@@ -481,19 +480,15 @@ int main (int argc, char * argv[]){
 	for(int i=0; i< numDevices; i++) {
 		clDevice = devices[i];
 		
-		FILE *fp;
 		char *source_str;
 		size_t source_size;
 		std::string outFile = fileNameBase + std::string(".cl");
 		const char *filename = outFile.c_str();
-		fp = fopen(filename, "r");
-		if (!fp) {
+		source_str = HI_load_kernel_source(filename, &source_size);
+		if (source_str == NULL) {
 			fprintf(stderr, "[INFO in OpenCL binary creation] Failed to read the kernel file %s, so skipping binary generation for OpenCL devices %d\n", filename, i);
 			exit(1);
 		}
-		source_str = (char*)malloc(MAX_SOURCE_SIZE);
-		source_size = fread( source_str, 1, MAX_SOURCE_SIZE, fp);
-		fclose( fp );
 
 		cl_int err;
 		clContext = clCreateContext( NULL, 1, &clDevice, NULL, NULL, &err);
@@ -590,6 +585,7 @@ int main (int argc, char * argv[]){
 		fwrite(binary, 1 , size, fpbin);
 		fclose(fpbin);
 		delete[] binary;
+		free(source_str);
 	}	
 
 #endif
@@ -302,12 +302,13 @@ HI_error_t BrisbaneDriver::init(int threadID) {
   }
 */
 
-  masterAddressTableMap[thread_id] = new addresstable_t();
+  masterAddressTableMap[thread_id] = new presenttable_t();
   masterHandleTable[thread_id] = new memhandlemap_t();
   postponedFreeTableMap[thread_id] = new asyncfreetable_t();
   postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
   postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-  memPoolMap[thread_id] = new memPool_t();
+  postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+  memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
   tempMallocSizeMap[thread_id] = new sizemap_t();
   threadAsyncMap[thread_id] = NO_QUEUE;
   //threadTaskMap[thread_id] = NULL;
@@ -370,14 +371,15 @@ HI_error_t BrisbaneDriver::HI_register_kernels(std::set<std::string>kernelNames,
   return HI_success;
 }
 
-HI_error_t BrisbaneDriver::HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID) {
+HI_error_t BrisbaneDriver::HI_register_kernel_numargs(int kernel_id, int num_args, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter BrisbaneDriver::HI_register_kernel_numargs(thread ID = %d)\n", threadID);
     }
 #endif
   HostConf_t *tconf = getHostConf(threadID);
-  kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+  kernelParams_t *kernelParams = kernelHandle->kernelParams;
   if( kernelParams->num_args == 0 ) {
     if( num_args > 0 ) {
       kernelParams->num_args = num_args;
@@ -386,7 +388,7 @@ HI_error_t BrisbaneDriver::HI_register_kernel_numargs(std::string kernel_name, i
       kernelParams->kernelParamsInfo = (int*)malloc(sizeof(int) * num_args);
       kernelParams->kernelParamMems = (brisbane_mem*)malloc(sizeof(brisbane_mem) * num_args);
     } else {
-      fprintf(stderr, "[ERROR in BrisbaneDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernel_name.c_str(), num_args);
+      fprintf(stderr, "[ERROR in BrisbaneDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernelHandle->kernelName, num_args);
       exit(1);
     }
   }
@@ -398,7 +400,7 @@ HI_error_t BrisbaneDriver::HI_register_kernel_numargs(std::string kernel_name, i
   return HI_success;
 }
 
-HI_error_t BrisbaneDriver::HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
+HI_error_t BrisbaneDriver::HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter BrisbaneDriver::HI_register_kernel_arg(thread ID = %d)\n", threadID);
@@ -408,7 +410,8 @@ HI_error_t BrisbaneDriver::HI_register_kernel_arg(std::string kernel_name, int a
 	}
 #endif
   HostConf_t *tconf = getHostConf(threadID);
-  kernelParams_t * kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+  kernelParams_t * kernelParams = kernelHandle->kernelParams;
   int err;
   if( arg_type == 0 ) {
     *(kernelParams->kernelParams + arg_index) = arg_value;
@@ -416,7 +419,7 @@ HI_error_t BrisbaneDriver::HI_register_kernel_arg(std::string kernel_name, int a
     *(kernelParams->kernelParamsInfo + arg_index) = (int)arg_size;
     brisbane_mem iMem;
     *(kernelParams->kernelParamMems + arg_index) = iMem;
-    //err = brisbane_kernel_setarg((brisbane_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, arg_size, arg_value);
+    //err = brisbane_kernel_setarg((brisbane_kernel)(kernelHandle->kernel), arg_index, arg_size, arg_value);
   } else {
     HI_device_mem_handle_t tHandle;
     if( HI_get_device_mem_handle(*((void **)arg_value), &tHandle, tconf->threadID) == HI_success ) {
@@ -434,10 +437,10 @@ HI_error_t BrisbaneDriver::HI_register_kernel_arg(std::string kernel_name, int a
       	*(kernelParams->kernelParamsInfo + arg_index) = 0;
       }
       *(kernelParams->kernelParamMems + arg_index) = tHandle.memHandle;
-      //err = brisbane_kernel_setmem_off((brisbane_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, *((brisbane_mem*) &(tHandle.memHandle)), tHandle.offset, brisbane_rw);
+      //err = brisbane_kernel_setmem_off((brisbane_kernel)(kernelHandle->kernel), arg_index, *((brisbane_mem*) &(tHandle.memHandle)), tHandle.offset, brisbane_rw);
       //if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
     } else {
-		fprintf(stderr, "[ERROR in BrisbaneDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (Brisbane Device)\n", arg_index, kernel_name.c_str());
+		fprintf(stderr, "[ERROR in BrisbaneDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (Brisbane Device)\n", arg_index, kernelHandle->kernelName);
 #ifdef _OPENARC_PROFILE_
 		HI_print_device_address_mapping_entries(tconf->threadID);
 #endif
@@ -452,14 +455,15 @@ HI_error_t BrisbaneDriver::HI_register_kernel_arg(std::string kernel_name, int a
   return HI_success;
 }
 
-HI_error_t BrisbaneDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
-    const char* c_kernel_name = kernel_name.c_str();
+HI_error_t BrisbaneDriver::HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
+    HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+    const char* c_kernel_name = kernelHandle->kernelName;
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter BrisbaneDriver::HI_kernel_call(%s, async ID = %d, thread ID = %d)\n",c_kernel_name, async, threadID);
     }
 #endif
-  HostConf_t *tconf = getHostConf(threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -476,15 +480,15 @@ HI_error_t BrisbaneDriver::HI_kernel_call(std::string kernel_name, size_t gridSi
     brisbane_task_create(&task);
   }
   size_t gws[3] = { gridSize[0] * blockSize[0], gridSize[1] * blockSize[1], gridSize[2] * blockSize[2] };
-  kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelParams_t *kernelParams = kernelHandle->kernelParams;
   int num_args = kernelParams->num_args;
   for(int i=0; i<num_args; i++) {
     if( kernelParams->kernelParams[i] == NULL ) {
         kernelParams->kernelParams[i] = kernelParams->kernelParamMems[i];
     }
   }
-  //brisbane_task_kernel(task, kernel_name.c_str(), 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsInfo);
-  brisbane_task_kernel_v2(task, kernel_name.c_str(), 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsOffset, kernelParams->kernelParamsInfo);
+  //brisbane_task_kernel(task, kernelHandle->kernelName, 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsInfo);
+  brisbane_task_kernel_v2(task, kernelHandle->kernelName, 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsOffset, kernelParams->kernelParamsInfo);
 
   threadtaskmapbrisbane_t *asyncTaskMap = threadAsyncTaskMap[threadID];
   int nTasks = 0;
@@ -571,14 +575,14 @@ HI_error_t BrisbaneDriver::HI_kernel_call(std::string kernel_name, size_t gridSi
   	threadAsyncMap[threadID] = async;
   }
 #ifdef _OPENARC_PROFILE_
-    if(tconf->KernelCNTMap.count(kernel_name) == 0) {
-        tconf->KernelCNTMap[kernel_name] = 0;
+    if(tconf->KernelCNTMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelCNTMap[kernelHandle->kernelName] = 0;
     }        
-    tconf->KernelCNTMap[kernel_name] += 1;
-    if(tconf->KernelTimingMap.count(kernel_name) == 0) {
-        tconf->KernelTimingMap[kernel_name] = 0.0;
+    tconf->KernelCNTMap[kernelHandle->kernelName] += 1;
+    if(tconf->KernelTimingMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelTimingMap[kernelHandle->kernelName] = 0.0;
     }        
-    tconf->KernelTimingMap[kernel_name] += HI_get_localtime() - ltime;
+    tconf->KernelTimingMap[kernelHandle->kernelName] += HI_get_localtime() - ltime;
 #endif   
 
   if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
@@ -651,6 +655,42 @@ HI_error_t BrisbaneDriver::destroy(int threadID) {
   return HI_success;
 }
 
+//Return the least recently freed chunks in the memory pool to the device, 
+//until at least size bytes are released or no entirely free chunk is left,
+//and return the number of bytes released.
+size_t BrisbaneDriver::evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter BrisbaneDriver::evict_mempool_chunks(%lu)\n", size);
+	}
+#endif
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	void *tDevPtr;
+	size_t chunkSize;
+	while( (releasedSize < size) && memPool->popFreeChunk(&tDevPtr, &chunkSize) ) {
+		HI_device_mem_handle_t tHandle;
+		if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
+			int err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
+			if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
+			HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
+		}
+		free(tDevPtr);
+		current_mempool_size -= chunkSize;
+		releasedSize += chunkSize;
+#ifdef _OPENARC_PROFILE_
+		tconf->IDFreeCnt++;
+		tconf->CIDMemorySize -= chunkSize;
+#endif
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit BrisbaneDriver::evict_mempool_chunks(%lu)\n", releasedSize);
+	}
+#endif
+	return releasedSize;
+}
+
 HI_error_t BrisbaneDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
@@ -668,69 +708,41 @@ HI_error_t BrisbaneDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_
 		exit(1);
 	}    
   } else {
+    size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
     memPool_t *memPool = memPoolMap[tconf->threadID];
-    std::multimap<size_t, void *>::iterator it = memPool->find(count);
-	if( it != memPool->end()) {
-      *devPtr = it->second;
-      memPool->erase(it);
-      current_mempool_size -= count;
+    size_t blockSize = 0;
+    allocSize = memPool->getAllocSize(count);
+	if( memPool->allocate(count, devPtr, &blockSize) ) {
+      current_mempool_size -= blockSize;
       HI_set_device_address(hostPtr, *devPtr, count, asyncID, tconf->threadID);
 	} else
 #endif
 	{
 #if VICTIM_CACHE_MODE > 0
 		if( current_mempool_size > tconf->max_mempool_size ) {
-    		HI_device_mem_handle_t tHandle;
-			void * tDevPtr;
-			for( it = memPool->begin(); it != memPool->end(); ++it ) {
-				tDevPtr = it->second;
-    			if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      				err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      				if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      				HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      				free(tDevPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-    			}
-			}	
-			memPool->clear();
+			evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 		}
 #endif
-      	err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
+      	err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
 #if VICTIM_CACHE_MODE > 0
       	if (err != BRISBANE_OK) {
-    		HI_device_mem_handle_t tHandle;
-			void * tDevPtr;
-			for( it = memPool->begin(); it != memPool->end(); ++it ) {
-				tDevPtr = it->second;
-    			if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      				err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      				if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      				HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      				free(tDevPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-    			}
-			}	
-			memPool->clear();
-      		err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
+			while( (err != BRISBANE_OK) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+				err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
+			}
       		if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 		}
 #endif
-      	*devPtr = malloc(count);
+      	*devPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+		memPool->addChunk(*devPtr, allocSize, count);
+#endif
       	HI_set_device_address(hostPtr, *devPtr, count, asyncID, tconf->threadID);
-      	HI_set_device_mem_handle(*devPtr, memHandle, count, tconf->threadID);
+      	HI_set_device_mem_handle(*devPtr, memHandle, allocSize, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 		tconf->IDMallocCnt++;
-		tconf->IDMallocSize += count;
-		tconf->CIDMemorySize += count;
+		tconf->IDMallocSize += allocSize;
+		tconf->CIDMemorySize += allocSize;
 		if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 			tconf->MIDMemorySize = tconf->CIDMemorySize;
 		}    
@@ -949,8 +961,7 @@ HI_error_t BrisbaneDriver::HI_free( const void *hostPtr, int asyncID, int thread
             //We do not free the device memory; instead put it in the memory pool
             //and remove host-pointer-to-device-pointer mapping
             memPool_t *memPool = memPoolMap[tconf->threadID];
-            memPool->insert(std::pair<size_t, void *>(size, devPtr));
-            current_mempool_size += size;
+            current_mempool_size += memPool->release(devPtr, size);
             HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
 #else
     		HI_device_mem_handle_t tHandle;
@@ -1236,8 +1247,7 @@ void BrisbaneDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threa
 #if VICTIM_CACHE_MODE > 0
 			if( tempMallocSize->count((const void *)tempPtr) > 0 ) {
 				size_t size = tempMallocSize->at((const void *)tempPtr);
-				memPool->insert(std::pair<size_t, void *>(size, tempPtr));
-            	current_mempool_size += size;
+				current_mempool_size += memPool->release(tempPtr, size);
 				tempMallocSize->erase((const void *)tempPtr);
 			} else 
 #endif
@@ -1311,18 +1321,18 @@ void BrisbaneDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t
     devType == acc_device_altera || devType == acc_device_altera_emulator ||
     devType == acc_device_current) {
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
+        size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
         memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_tempMalloc1D(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= count;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
       		//HI_set_device_address(hostPtr, *tempPtr, count, asyncID, tconf->threadID);
         } else 
@@ -1337,26 +1347,10 @@ void BrisbaneDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_tempMalloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      					if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
-                }
-				memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
 #endif
-			err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
+			err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
 #if VICTIM_CACHE_MODE > 0
 			if (err != BRISBANE_OK) {
 #ifdef _OPENARC_PROFILE_
@@ -1364,35 +1358,23 @@ void BrisbaneDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_tempMalloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      					if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
+                while( (err != BRISBANE_OK) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
                 }
-				memPool->clear();
-      			err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
       			if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 			}
 #endif
-			*tempPtr = malloc(count);
-			HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+			*tempPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+			memPool->addChunk(*tempPtr, allocSize, count);
+#endif
+			HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 			//New temporary device memory is allocated.
             (*tempMallocSize)[(const void *)*tempPtr] = count;
 #ifdef _OPENARC_PROFILE_
         	tconf->IDMallocCnt++;
-        	tconf->IDMallocSize += count;
-        	tconf->CIDMemorySize += count;
+        	tconf->IDMallocSize += allocSize;
+        	tconf->CIDMemorySize += allocSize;
         	if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
             	tconf->MIDMemorySize = tconf->CIDMemorySize;
         	}   
@@ -1447,18 +1429,18 @@ void BrisbaneDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_de
     devType == acc_device_altera || devType == acc_device_altera_emulator ||
     devType == acc_device_current) {
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
+        size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
         memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_tempMalloc1D_async(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= it->first;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
       		//HI_set_device_address(hostPtr, *tempPtr, count, asyncID, tconf->threadID);
         } else 
@@ -1473,26 +1455,10 @@ void BrisbaneDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_de
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_malloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      					if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
-                }
-				memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
 #endif
-			err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
+			err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
 #if VICTIM_CACHE_MODE > 0
 			if (err != BRISBANE_OK) {
 #ifdef _OPENARC_PROFILE_
@@ -1500,35 +1466,23 @@ void BrisbaneDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_de
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tBrisbaneDriver::HI_malloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = brisbane_mem_release((brisbane_mem) tHandle.memHandle);
-      					if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
+                while( (err != BRISBANE_OK) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	err = brisbane_mem_create(allocSize, (brisbane_mem*) &memHandle);
                 }
-				memPool->clear();
-      			err = brisbane_mem_create(count, (brisbane_mem*) &memHandle);
       			if (err != BRISBANE_OK) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 			}
 #endif
-			*tempPtr = malloc(count);
-			HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+			*tempPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+			memPool->addChunk(*tempPtr, allocSize, count);
+#endif
+			HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 			//New temporary device memory is allocated.
             (*tempMallocSize)[(const void *)*tempPtr] = count;
 #ifdef _OPENARC_PROFILE_
         	tconf->IDMallocCnt++;
-        	tconf->IDMallocSize += count;
-			tconf->CIDMemorySize += count;
+        	tconf->IDMallocSize += allocSize;
+			tconf->CIDMemorySize += allocSize;
 			if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 				tconf->MIDMemorySize = tconf->CIDMemorySize;
 			}
@@ -1815,6 +1769,7 @@ HI_error_t BrisbaneDriver::createKernelArgMap(int threadID) {
 
   tconf->kernelArgsMap[this] = kernelArgs;
   tconf->kernelsMap[this]=kernelMap;
+  tconf->resetKernelHandles(this);
   }
 #ifdef _THREAD_SAFETY
   pthread_mutex_unlock(&mutex_clContext);
@@ -1822,12 +1777,13 @@ HI_error_t BrisbaneDriver::createKernelArgMap(int threadID) {
 
 	int thread_id = tconf->threadID;
   if (masterHandleTable.count(thread_id) == 0) {
-    masterAddressTableMap[thread_id] = new addresstable_t();
+    masterAddressTableMap[thread_id] = new presenttable_t();
     masterHandleTable[thread_id] = new memhandlemap_t();
     postponedFreeTableMap[thread_id] = new asyncfreetable_t();
     postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
     postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-    memPoolMap[thread_id] = new memPool_t();
+    postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+    memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
     tempMallocSizeMap[thread_id] = new sizemap_t();
   	threadAsyncMap[threadID] = NO_QUEUE;
   	//threadTaskMap[thread_id] = NULL;
@@ -23,7 +23,6 @@
 //std::map<std::string, CUfunction> CudaDriver::kernelMap;
 //std::set<std::string> CudaDriver::kernelNameSet;
 std::map<CUdeviceptr,int> CudaDriver::pinnedHostMemCounter;
-std::vector<const void *> CudaDriver::hostMemToUnpin;
 
 const char * cuda_error_code(CUresult err) {
 	static std::string str = "";
@@ -341,12 +340,13 @@ HI_error_t CudaDriver::init(int threadID) {
 #endif
     	eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
     	threadQueueEventMap[thread_id] = eventMap;
-		masterAddressTableMap[thread_id] = new addresstable_t();
+		masterAddressTableMap[thread_id] = new presenttable_t();
 		masterHandleTable[thread_id] = new memhandlemap_t();
 		postponedFreeTableMap[thread_id] = new asyncfreetable_t();
 		postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
 		postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-		memPoolMap[thread_id] = new memPool_t();
+		postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+		memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit, MEMPOOL_MIN_BLOCK_SIZE);
 		tempMallocSizeMap[thread_id] = new sizemap_t();
 #ifdef INIT_DEBUG
     	fprintf(stderr, "[DEBUG] CUDA events are created.\n");
@@ -399,6 +399,7 @@ HI_error_t CudaDriver::createKernelArgMap(int threadID) {
 
     tconf->kernelArgsMap[this] = kernelArgs;
     tconf->kernelsMap[this]=kernelMap;
+    tconf->resetKernelHandles(this);
 
 	int thread_id = tconf->threadID;
 	if( queueMap.count(0+thread_id*MAX_NUM_QUEUES_PER_THREAD) == 0 ) {
@@ -462,12 +463,13 @@ HI_error_t CudaDriver::createKernelArgMap(int threadID) {
 #endif
     	eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
     	threadQueueEventMap[thread_id] = eventMap;
-		masterAddressTableMap[thread_id] = new addresstable_t();
+		masterAddressTableMap[thread_id] = new presenttable_t();
 		masterHandleTable[thread_id] = new memhandlemap_t();
 		postponedFreeTableMap[thread_id] = new asyncfreetable_t();
 		postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
 		postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-		memPoolMap[thread_id] = new memPool_t();
+		postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+		memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit, MEMPOOL_MIN_BLOCK_SIZE);
 		tempMallocSizeMap[thread_id] = new sizemap_t();
 #ifdef INIT_DEBUG
     	fprintf(stderr, "[DEBUG] CUDA events are created.\n");
@@ -789,231 +791,98 @@ void CudaDriver::inc_pinned_host_memory_counter(const void* hostPtr)
 #endif
 }
 
-//Unpin host memories whose counters are less than 1.
-//This also frees corresponding device memory.
-void CudaDriver::unpin_host_memory_all(int asyncID, int threadID)
-{
+//Release the least recently cached entries in the victim cache of the 
+//host thread, until at least size bytes are released or the cache is 
+//empty, and return the number of bytes released.
+//The prepinned host memory of a released entry is also unpinned, unless 
+//the host memory is mapped again.
+size_t CudaDriver::evict_victim_cache_entries(size_t size, int threadID) {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::unpin_host_memory_all(%d)\n", asyncID);
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::evict_victim_cache_entries(%lu)\n", size);
 	}
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_pin_host_memory);
-#else
-#ifdef _OPENMP
-    #pragma omp critical (pin_host_memory_critical)
 #endif
-#endif
-    {
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	victimcache_entry_t entry;
+	while( (releasedSize < size) && (HI_pop_victim_cache_entry(&entry, tconf->threadID) == HI_success) ) {
+		if( tconf->prepin_host_memory == 1 ) {
 #ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
+        	pthread_mutex_lock(&mutex_pin_host_memory);
 #else
 #ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
-		addresstable_t::iterator it = CudaDriver::auxAddressTable.find(asyncID);
-		if(it != CudaDriver::auxAddressTable.end()) {
-			CudaDriver::hostMemToUnpin.clear();
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-        		CUdeviceptr host = (CUdeviceptr)it2->first;
-        		//If the hostPtr is already pinned
-        		if(CudaDriver::pinnedHostMemCounter.find(host) != CudaDriver::pinnedHostMemCounter.end()) {
-            		if(CudaDriver::pinnedHostMemCounter[host] < 1) {
-                		CUresult cuResult = cuMemHostUnregister((void*)host);
-                		if(cuResult == CUDA_SUCCESS){
-                			CudaDriver::pinnedHostMemCounter.erase(host);
-							CudaDriver::hostMemToUnpin.push_back(it2->first);
-#ifdef _OPENARC_PROFILE_
-							tconf->IPFreeCnt++;
-#endif
-                		} else {
-                			fprintf(stderr, "[ERROR in CudaDriver::unpin_host_memory_all(%d)] Cannot unpin host memory with error %d (%s)\n", asyncID, cuResult, cuda_error_code(cuResult));
-							exit(1);
-                		}
-						//Free corresponding device memory.
-						addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-						cuMemFree((CUdeviceptr)aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-						tconf->IDFreeCnt++;
-						//[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-				
-            		}
-        		}
-			}
-			while( !CudaDriver::hostMemToUnpin.empty() ) {
-				(it->second)->erase(CudaDriver::hostMemToUnpin.back());
-				CudaDriver::hostMemToUnpin.pop_back();
-			}
-		}
-		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+    		#pragma omp critical (pin_host_memory_critical)
 #endif
-    }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_pin_host_memory);
-#endif
-#ifdef _OPENARC_PROFILE_
-	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::unpin_host_memory_all(%d)\n", asyncID);
-	}
 #endif
-}
-
-//Unpin host memories whose counters are less than 1.
-void CudaDriver::unpin_host_memory_all(int threadID)
-{
+			{
+        	CUdeviceptr host = (CUdeviceptr)entry.hostPtr;
+			std::map<CUdeviceptr,int>::iterator it = CudaDriver::pinnedHostMemCounter.find(host);
+        	if( (it != CudaDriver::pinnedHostMemCounter.end()) && (it->second < 1) ) {
+            	CUresult cuResult = cuMemHostUnregister((void*)host);
+            	if(cuResult == CUDA_SUCCESS){
+            		CudaDriver::pinnedHostMemCounter.erase(it);
 #ifdef _OPENARC_PROFILE_
-	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::unpin_host_memory_all()\n");
-	}
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_pin_host_memory);
-#else
-#ifdef _OPENMP
-    #pragma omp critical (pin_host_memory_critical)
-#endif
+					tconf->IPFreeCnt++;
 #endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		for( addresstable_t::iterator it = CudaDriver::auxAddressTable.begin(); it != CudaDriver::auxAddressTable.end(); ++it) {
-			CudaDriver::hostMemToUnpin.clear();
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-        		CUdeviceptr host = (CUdeviceptr)it2->first;
-        		//If the hostPtr is already pinned
-        		if(CudaDriver::pinnedHostMemCounter.find(host) != CudaDriver::pinnedHostMemCounter.end()) {
-            		if(CudaDriver::pinnedHostMemCounter[host] < 1) {
-                		CUresult cuResult = cuMemHostUnregister((void*)host);
-                		if(cuResult == CUDA_SUCCESS){
-                			CudaDriver::pinnedHostMemCounter.erase(host);
-							CudaDriver::hostMemToUnpin.push_back(it2->first);
-#ifdef _OPENARC_PROFILE_
-							tconf->IDFreeCnt++;
-							//[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-                		} else {
-                			fprintf(stderr, "[ERROR in CudaDriver::unpin_host_memory_all()] Cannot unpin host memory with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-							exit(1);
-                		}
-						//Free corresponding device memory.
-						addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-						cuMemFree((CUdeviceptr)aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-						tconf->IDFreeCnt++;
-						//[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-            		}
-        		}
+            	} else {
+            		fprintf(stderr, "[ERROR in CudaDriver::evict_victim_cache_entries()] Cannot unpin host memory with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
+					exit(1);
+            	}
 			}
-			while( !CudaDriver::hostMemToUnpin.empty() ) {
-				(it->second)->erase(CudaDriver::hostMemToUnpin.back());
-				CudaDriver::hostMemToUnpin.pop_back();
 			}
-		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-    }
 #ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_pin_host_memory);
-#endif
-#ifdef _OPENARC_PROFILE_
-	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::unpin_host_memory_all()\n");
-	}
-#endif
-}
-
-void CudaDriver::release_freed_device_memory(int asyncID, int threadID)
-{
-#ifdef _OPENARC_PROFILE_
-	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::release_freed_device_memory(%d)\n", asyncID);
-	}
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
-		addresstable_t::iterator it = CudaDriver::auxAddressTable.find(asyncID);
-		if(it != CudaDriver::auxAddressTable.end()) {
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-				//Free corresponding device memory.
-				addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-				cuMemFree((CUdeviceptr)aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-				tconf->IDFreeCnt++;
-				//[FIXME] tconf->CIDMemorySize should be adjusted here.
+        	pthread_mutex_unlock(&mutex_pin_host_memory);
 #endif
-			}
 		}
+		CUresult cuResult = cuMemFree((CUdeviceptr)entry.devPtr);
+		if( cuResult != CUDA_SUCCESS ) {
+			fprintf(stderr, "[ERROR in CudaDriver::evict_victim_cache_entries()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
 		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+		releasedSize += entry.size;
+#ifdef _OPENARC_PROFILE_
+		tconf->IDFreeCnt++;
+		tconf->CIDMemorySize -= entry.size;
 #endif
-    }
+	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::release_freed_device_memory(%d)\n", asyncID);
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::evict_victim_cache_entries(%lu)\n", releasedSize);
 	}
 #endif
+	return releasedSize;
 }
 
-void CudaDriver::release_freed_device_memory(int threadID)
-{
+//Return the least recently freed chunks in the memory pool to the device, 
+//until at least size bytes are released or no entirely free chunk is left,
+//and return the number of bytes released.
+size_t CudaDriver::evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID) {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::release_freed_device_memory()\n");
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::evict_mempool_chunks(%lu)\n", size);
 	}
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		for( addresstable_t::iterator it = CudaDriver::auxAddressTable.begin(); it != CudaDriver::auxAddressTable.end(); ++it ) {
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-				//Free corresponding device memory.
-				addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-				cuMemFree((CUdeviceptr)aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-				tconf->IDFreeCnt++;
-				//[FIXME] tconf->CIDMemorySize should be adjusted here.
 #endif
-			}
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	void *tDevPtr;
+	size_t chunkSize;
+	while( (releasedSize < size) && memPool->popFreeChunk(&tDevPtr, &chunkSize) ) {
+		CUresult cuResult = cuMemFree((CUdeviceptr)tDevPtr);
+		if( cuResult != CUDA_SUCCESS ) {
+			fprintf(stderr, "[ERROR in CudaDriver::evict_mempool_chunks()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
 		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+		current_mempool_size -= chunkSize;
+		releasedSize += chunkSize;
+#ifdef _OPENARC_PROFILE_
+		tconf->IDFreeCnt++;
+		tconf->CIDMemorySize -= chunkSize;
 #endif
-    }
+	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::release_freed_device_memory()\n");
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit CudaDriver::evict_mempool_chunks(%lu)\n", releasedSize);
 	}
 #endif
+	return releasedSize;
 }
 
 HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags, int threadID) {
@@ -1051,16 +920,15 @@ HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t c
         CUresult cuResult = CUDA_SUCCESS;
 #if VICTIM_CACHE_MODE <= 1
 		memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, devPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
 			if( HI_openarcrt_verbosity > 2 ) {
 				fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_malloc1D(%d, %lu) reuses memories in the memPool\n", asyncID, count);
 			}
 #endif
-			*devPtr = it->second;
-            memPool->erase(it);
-			current_mempool_size -= count;
+			current_mempool_size -= blockSize;
         } else {
 			if( current_mempool_size > tconf->max_mempool_size ) {
 #ifdef _OPENARC_PROFILE_
@@ -1068,25 +936,13 @@ HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t c
 					fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_malloc1D(%d, %lu) releases memories in the memPool\n", asyncID, count);
 				}
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-            		*devPtr = it->second;
-					cuResult = cuMemFree((CUdeviceptr)(*devPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-            		tconf->IDFreeCnt++;
-					tconf->CIDMemorySize -= it->first;
-#endif
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_malloc1D()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
-                }
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
-            cuResult = cuMemAlloc((CUdeviceptr*)devPtr, count);
+            cuResult = cuMemAlloc((CUdeviceptr*)devPtr, allocSize);
 #ifdef _OPENARC_PROFILE_
             tconf->IDMallocCnt++;
-            tconf->IDMallocSize += count;
-            tconf->CIDMemorySize += count;
+            tconf->IDMallocSize += allocSize;
+            tconf->CIDMemorySize += allocSize;
 			if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 				tconf->MIDMemorySize = tconf->CIDMemorySize;
 			}
@@ -1097,20 +953,12 @@ HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t c
 					fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_malloc1D(%d, %lu) releases memories in the memPool\n", asyncID, count);
 				}
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-            		*devPtr = it->second;
-					cuResult = cuMemFree((CUdeviceptr)(*devPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-            		tconf->IDFreeCnt++;
-					tconf->CIDMemorySize -= it->first;
-#endif
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_malloc1D()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
+                while( (cuResult != CUDA_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	cuResult = cuMemAlloc((CUdeviceptr*)devPtr, allocSize);
                 }
-                memPool->clear();
-                cuResult = cuMemAlloc((CUdeviceptr*)devPtr, count);
+            }
+            if( cuResult == CUDA_SUCCESS ) {
+                memPool->addChunk(*devPtr, allocSize, count);
             }
         }
         if( cuResult == CUDA_SUCCESS ) {
@@ -1136,12 +984,15 @@ HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t c
 		///////////////////////////
 		// VICTIM_CACHE_MODE = 2 //
 		///////////////////////////
-    	if(HI_get_device_address_from_victim_cache(hostPtr, devPtr, NULL, NULL, asyncID, tconf->threadID) == HI_success ) {
+    	size_t allocSize = 0;
+    	if(HI_get_device_address_from_victim_cache(hostPtr, (size_t) count, (tconf->prepin_host_memory == 0), devPtr, &allocSize, asyncID, tconf->threadID) == HI_success ) {
 			result = HI_success;
+			if( allocSize > count ) {
+				HI_set_victim_cache_alloc_size(*devPtr, allocSize, tconf->threadID);
+			}
             if( tconf->prepin_host_memory == 1 ) {
 				inc_pinned_host_memory_counter(hostPtr);
 			}
-			HI_remove_device_address_from_victim_cache(hostPtr, asyncID, tconf->threadID);
         } else {
 #ifdef _OPENARC_PROFILE_
             tconf->IDMallocCnt++;
@@ -1152,36 +1003,16 @@ HI_error_t  CudaDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t c
 			}
 #endif
             cuResult = cuMemAlloc((CUdeviceptr*)devPtr, (size_t) count);
-            if (cuResult != CUDA_SUCCESS) {
-            	if( tconf->prepin_host_memory == 1 ) {
-					unpin_host_memory_all(asyncID, tconf->threadID);
-				} else {
-					release_freed_device_memory(asyncID, tconf->threadID);
-					HI_reset_victim_cache(asyncID);
-				}
-				//Try to allocate device memory again.
+			//Release the least recently cached device memory until the 
+			//allocation succeeds.
+            while( (cuResult != CUDA_SUCCESS) && (evict_victim_cache_entries((size_t) count, tconf->threadID) > 0) ) {
             	cuResult = cuMemAlloc((CUdeviceptr*)devPtr, (size_t) count);
-            	if (cuResult != CUDA_SUCCESS) {
-            		if( tconf->prepin_host_memory == 1 ) {
-						unpin_host_memory_all(tconf->threadID);
-					} else {
-						release_freed_device_memory(tconf->threadID);
-						HI_reset_victim_cache_all();
-					}
-					//Try to allocate device memory again.
-            		cuResult = cuMemAlloc((CUdeviceptr*)devPtr, (size_t) count);
-				}
 			}
         	if( cuResult == CUDA_SUCCESS ) {
           		//Pin host memory
             	if( tconf->prepin_host_memory == 1 ) {
             		result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
-					if( result != HI_success ) {
-						unpin_host_memory_all(asyncID);
-            			result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
-					}
-					if( result != HI_success ) {
-						unpin_host_memory_all();
+					while( (result != HI_success) && (evict_victim_cache_entries((size_t) count, tconf->threadID) > 0) ) {
             			result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
 					}
 					if( result != HI_success ) {
@@ -1433,8 +1264,7 @@ HI_error_t CudaDriver::HI_free( const void *hostPtr, int asyncID, int threadID)
 			//We do not free the device memory; instead put it in the memory pool 
 			//and remove host-pointer-to-device-pointer mapping.
 			memPool_t *memPool = memPoolMap[tconf->threadID];
-            memPool->insert(std::pair<size_t, void *>(size, devPtr));
-			current_mempool_size += size;
+            current_mempool_size += memPool->release(devPtr, size);
 			HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
 			// Unpin host memory
 			HI_unpin_host_memory(hostPtr, tconf->threadID);
@@ -1444,6 +1274,8 @@ HI_error_t CudaDriver::HI_free( const void *hostPtr, int asyncID, int threadID)
 			// VICTIM_CACHE_MODE = 2 //
 			///////////////////////////
 			HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
+			//A buffer taken from the cache can be larger than its mapping.
+			size = HI_remove_victim_cache_alloc_size(devPtr, size, tconf->threadID);
 			HI_set_device_address_in_victim_cache(hostPtr, devPtr, size, asyncID, tconf->threadID);
            // Decrease pinned host memory counter
             if( tconf->prepin_host_memory == 1 ) {
@@ -1451,6 +1283,10 @@ HI_error_t CudaDriver::HI_free( const void *hostPtr, int asyncID, int threadID)
 			} else {
 				HI_unpin_host_memory(hostPtr, tconf->threadID);
 			}
+			//Keep the victim cache within the memory pool budget.
+			if( HI_get_victim_cache_size(tconf->threadID) > tconf->max_mempool_size ) {
+				evict_victim_cache_entries(HI_get_victim_cache_size(tconf->threadID) - tconf->max_mempool_size, tconf->threadID);
+			}
 #endif
 #if VICTIM_CACHE_MODE == 0
             CUresult cuResult = CUDA_SUCCESS;
@@ -1796,16 +1632,15 @@ void CudaDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
     	CUresult cuResult = CUDA_SUCCESS;
         memPool_t *memPool = memPoolMap[tconf->threadID];
 		sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_tempMalloc1D(%lu) reuses memories in the memPool\n", count);
             }
 #endif           
-            *tempPtr = it->second;
-            memPool->erase(it);
-			current_mempool_size -= count;
+			current_mempool_size -= blockSize;
 			(*tempMallocSize)[(const void *)*tempPtr] = count;
         } else { 
 			if( current_mempool_size > tconf->max_mempool_size ) {
@@ -1814,49 +1649,27 @@ void CudaDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_malloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif               
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    cuResult = cuMemFree((CUdeviceptr)(*tempPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-        			tconf->CIDMemorySize -= it->first;
-#endif                   
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_tempMalloc1D()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
-                }        
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
-            cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, count);
+            cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, allocSize);
             if (cuResult != CUDA_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_malloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif               
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    cuResult = cuMemFree((CUdeviceptr)(*tempPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-        			tconf->CIDMemorySize -= it->first;
-#endif                   
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_tempMalloc1D()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
-                }        
-                memPool->clear();
-                cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, count);
+                while( (cuResult != CUDA_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, allocSize);
+                }
             }        
     		if(cuResult == CUDA_SUCCESS) {
 				//New temporary device memory is allocated.
 				(*tempMallocSize)[(const void *)*tempPtr] = count;
+				memPool->addChunk(*tempPtr, allocSize, count);
 #ifdef _OPENARC_PROFILE_
 		        tconf->IDMallocCnt++;
-        		tconf->IDMallocSize += count;
-        		tconf->CIDMemorySize += count;
+        		tconf->IDMallocSize += allocSize;
+        		tconf->CIDMemorySize += allocSize;
 				if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 					tconf->MIDMemorySize = tconf->CIDMemorySize;
 				}
@@ -1924,16 +1737,15 @@ void CudaDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
     	CUresult cuResult = CUDA_SUCCESS;
         memPool_t *memPool = memPoolMap[tconf->threadID];
 		sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_tempMalloc1D_async(%lu) reuses memories in the memPool\n", count);
             }
 #endif           
-            *tempPtr = it->second;
-            memPool->erase(it);
-			current_mempool_size -= count;
+			current_mempool_size -= blockSize;
 			(*tempMallocSize)[(const void *)*tempPtr] = count;
         } else { 
 			if( current_mempool_size > tconf->max_mempool_size ) {
@@ -1942,49 +1754,27 @@ void CudaDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif               
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    cuResult = cuMemFree((CUdeviceptr)(*tempPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-        			tconf->CIDMemorySize -= it->first;
-#endif                   
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_tempMalloc1D_async()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
-                }        
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
-            cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, count);
+            cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, allocSize);
             if (cuResult != CUDA_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tCudaDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif               
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    cuResult = cuMemFree((CUdeviceptr)(*tempPtr));
-					current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-        			tconf->CIDMemorySize -= it->first;
-#endif                   
-                    if(cuResult != CUDA_SUCCESS) {
-                        fprintf(stderr, "[ERROR in CudaDriver::HI_tempMalloc1D_async()] failed to free on CUDA with error %d (%s)\n", cuResult, cuda_error_code(cuResult));
-                    }
-                }        
-                memPool->clear();
-                cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, count);
+                while( (cuResult != CUDA_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	cuResult = cuMemAlloc((CUdeviceptr*)tempPtr, allocSize);
+                }
             }        
     		if(cuResult == CUDA_SUCCESS) {
 				//New temporary device memory is allocated.
 				(*tempMallocSize)[(const void *)*tempPtr] = count;
+				memPool->addChunk(*tempPtr, allocSize, count);
 #ifdef _OPENARC_PROFILE_
 		        tconf->IDMallocCnt++;
-        		tconf->IDMallocSize += count;
-        		tconf->CIDMemorySize += count;
+        		tconf->IDMallocSize += allocSize;
+        		tconf->CIDMemorySize += allocSize;
 				if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 					tconf->MIDMemorySize = tconf->CIDMemorySize;
 				}
@@ -2067,8 +1857,7 @@ void CudaDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threadID)
 				}
 			} else {
 				size_t size = tempMallocSize->at((const void *)tempPtr);
-            	memPool->insert(std::pair<size_t, void *>(size, tempPtr));
-				current_mempool_size += size;
+            	current_mempool_size += memPool->release(tempPtr, size);
 				tempMallocSize->erase((const void *)tempPtr);
 			}
         }
@@ -2909,7 +2698,7 @@ HI_error_t CudaDriver::HI_memcpy2D_async(void *dst, size_t dpitch, const void *s
     return HI_success;
 }
 
-HI_error_t CudaDriver::HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID)
+HI_error_t CudaDriver::HI_register_kernel_numargs(int kernel_id, int num_args, int threadID)
 {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2917,24 +2706,25 @@ HI_error_t CudaDriver::HI_register_kernel_numargs(std::string kernel_name, int n
 	}
 #endif
     HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
 	//fprintf(stderr, "find kernelargs map for the current device\n");
-    //(tconf->kernelArgsMap.at(this).at(kernel_name))->insert(std::pair<int, argument_t>(arg_index, arg));
+    //kernelHandle->kernelParams->insert(std::pair<int, argument_t>(arg_index, arg));
 /*
 	if( tconf->kernelArgsMap.count(this) == 0 ) {
-        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] kernelArgsMap does not exist for the current device.\n",kernel_name.c_str(), num_args);
+        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] kernelArgsMap does not exist for the current device.\n",kernelHandle->kernelName, num_args);
 			exit(1);
-	} else if( tconf->kernelArgsMap.at(this).count(kernel_name) == 0 ) {
-        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] kernelArgsMap does not have an entry for the current kernel.\n",kernel_name.c_str(), num_args);
+	} else if( tconf->kernelArgsMap.at(this).count(kernelHandle->kernelName) == 0 ) {
+        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] kernelArgsMap does not have an entry for the current kernel.\n",kernelHandle->kernelName, num_args);
 			exit(1);
 	}
 */
-	kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+	kernelParams_t *kernelParams = kernelHandle->kernelParams;
 	if( kernelParams->num_args == 0 ) {
 		if( num_args > 0 ) {
 			kernelParams->num_args = num_args;
     		kernelParams->kernelParams = (void**)malloc(sizeof(void*) * num_args);
 		} else {
-        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernel_name.c_str(), num_args);
+        	fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernelHandle->kernelName, num_args);
 			exit(1);
 		}
 	}
@@ -2947,7 +2737,7 @@ HI_error_t CudaDriver::HI_register_kernel_numargs(std::string kernel_name, int n
 }
 
 
-HI_error_t CudaDriver::HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
+HI_error_t CudaDriver::HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
 {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2955,13 +2745,14 @@ HI_error_t CudaDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
 	}
 #endif
     HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
 	//fprintf(stderr, "find kernelargs map for the current device\n");
 
-	kernelParams_t * kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+	kernelParams_t * kernelParams = kernelHandle->kernelParams;
 	if( kernelParams->num_args > arg_index ) {
 		*(kernelParams->kernelParams + arg_index) = arg_value;
 	} else {
-		fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_arg()] Kernel %s is registered to have %d arguments, but the current argument index %d is out of the bound.\n",kernel_name.c_str(), kernelParams->num_args, arg_index);
+		fprintf(stderr, "[ERROR in CudaDriver::HI_register_kernel_arg()] Kernel %s is registered to have %d arguments, but the current argument index %d is out of the bound.\n",kernelHandle->kernelName, kernelParams->num_args, arg_index);
 		exit(1);
 	}
 
@@ -2978,9 +2769,11 @@ HI_error_t CudaDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
 
 
 
-HI_error_t CudaDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID)
+HI_error_t CudaDriver::HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID)
 {
-	const char* c_kernel_name = kernel_name.c_str();
+	HostConf_t *tconf = getHostConf(threadID);
+	kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+	const char* c_kernel_name = kernelHandle->kernelName;
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter CudaDriver::HI_kernel_call(%s, %d)\n",c_kernel_name, async);
@@ -2994,7 +2787,6 @@ HI_error_t CudaDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3
         fprintf(stderr, "[ERROR in CudaDriver::HI_kernel_call()] Kernel [%s] Launch FAIL due to too large threadBlock configuration (%lu, %lu, %lu); exit!\n",c_kernel_name, blockSize[2], blockSize[1], blockSize[0]);
 		exit(1);
 	}
-    HostConf_t *tconf = getHostConf(threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -3006,12 +2798,12 @@ HI_error_t CudaDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3
     CUstream stream = getQueue(async, tconf->threadID);
     CUevent event = getEvent(async, tconf->threadID);
     if(async != DEFAULT_QUEUE+tconf->asyncID_offset) {
-        err = cuLaunchKernel(tconf->kernelsMap.at(this).at(kernel_name), gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, stream, (tconf->kernelArgsMap.at(this).at(kernel_name))->kernelParams, NULL);
+        err = cuLaunchKernel(kernelHandle->kernel, gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, stream, kernelHandle->kernelParams->kernelParams, NULL);
 
         cuEventRecord(event, stream);
 
     } else {
-        err = cuLaunchKernel(tconf->kernelsMap.at(this).at(kernel_name), gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, 0, (tconf->kernelArgsMap.at(this).at(kernel_name))->kernelParams, NULL);
+        err = cuLaunchKernel(kernelHandle->kernel, gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, 0, kernelHandle->kernelParams->kernelParams, NULL);
     }
     if (err != CUDA_SUCCESS) {
         fprintf(stderr, "[ERROR in CudaDriver::HI_kernel_call(%s)] Kernel Launch FAIL with error %d (%s)\n",c_kernel_name, err, cuda_error_code(err));
@@ -3022,16 +2814,16 @@ HI_error_t CudaDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3
     }
 
 #ifdef _OPENARC_PROFILE_
-	if(tconf->KernelCNTMap.count(kernel_name) == 0) {
-		tconf->KernelCNTMap[kernel_name] = 0;
+	if(tconf->KernelCNTMap.count(kernelHandle->kernelName) == 0) {
+		tconf->KernelCNTMap[kernelHandle->kernelName] = 0;
 	}
-    tconf->KernelCNTMap[kernel_name] += 1;
-	if(tconf->KernelTimingMap.count(kernel_name) == 0) {
-		tconf->KernelTimingMap[kernel_name] = 0.0;
+    tconf->KernelCNTMap[kernelHandle->kernelName] += 1;
+	if(tconf->KernelTimingMap.count(kernelHandle->kernelName) == 0) {
+		tconf->KernelTimingMap[kernelHandle->kernelName] = 0.0;
 	}
     err = cuStreamSynchronize(stream);
     err = cuStreamSynchronize(0);
-    tconf->KernelTimingMap[kernel_name] += HI_get_localtime() - ltime;
+    tconf->KernelTimingMap[kernelHandle->kernelName] += HI_get_localtime() - ltime;
 #endif
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -3256,6 +3048,8 @@ void CudaDriver::HI_set_async(int asyncId, int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     int thread_id = tconf->threadID;
+    CUstream asyncStream;
+    CUevent markerEvent;
 #ifdef _THREAD_SAFETY
         pthread_mutex_lock(&mutex_set_async);
 #else
@@ -3280,6 +3074,17 @@ void CudaDriver::HI_set_async(int asyncId, int threadID) {
             cuStreamCreate(&str, CU_STREAM_NON_BLOCKING);
 #endif
             queueMap[asyncId] = str;
+            asyncStream = str;
+        } else {
+            asyncStream = it->second;
+        }
+
+        std::map<int, CUevent>::iterator mit = threadMarkerEventMap.find(thread_id);
+        if(mit == threadMarkerEventMap.end()) {
+            cuEventCreate(&markerEvent, CU_EVENT_DISABLE_TIMING);
+            threadMarkerEventMap[thread_id] = markerEvent;
+        } else {
+            markerEvent = mit->second;
         }
 
         std::map<int, std::map<int, CUevent> >::iterator threadIt;
@@ -3311,19 +3116,26 @@ void CudaDriver::HI_set_async(int asyncId, int threadID) {
 		//We need explicit synchronization here for the default queue 
 		//since HI_synchronize() does not explicitly synchronize if 
 		//unified memory is not used.
+		//Instead of blocking the host until the default stream (and the NULL 
+		//stream) drain, the async stream waits for a marker event recorded 
+		//on them; no wait is added if the marker has already completed.
     	//CUresult err = cuCtxSynchronize();
-    	//CUresult err = cuStreamSynchronize(getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID));
-    	//err = cuStreamSynchronize(0);
     	CUstream stream = getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID);
-    	CUresult err = cuStreamSynchronize(stream);
-    	if (err != CUDA_SUCCESS) {
-        	fprintf(stderr, "[ERROR in CudaDriver::HI_set_async()] DEFAULT_QUEUE Context Synchronization FAIL with error %d (%s)\n", err, cuda_error_code(err));
-			exit(1);
-    	}
-		if( stream != 0 ) {
-    		err = cuStreamSynchronize(0);
+		CUstream depStreams[2] = {stream, 0};
+		int numDepStreams = (stream != 0) ? 2 : 1;
+		for( int i=0; i<numDepStreams; i++ ) {
+			if( depStreams[i] == asyncStream ) {
+				continue;
+			}
+    		CUresult err = cuEventRecord(markerEvent, depStreams[i]);
+			if( err == CUDA_SUCCESS ) {
+				err = cuEventQuery(markerEvent);
+				if( err == CUDA_ERROR_NOT_READY ) {
+					err = cuStreamWaitEvent(asyncStream, markerEvent, 0);
+				}
+			}
     		if (err != CUDA_SUCCESS) {
-        		fprintf(stderr, "[ERROR in CudaDriver::HI_set_async()] Default Context Synchronization FAIL with error %d (%s)\n", err, cuda_error_code(err));
+        		fprintf(stderr, "[ERROR in CudaDriver::HI_set_async()] failed to order async stream %d after the default stream with error %d (%s)\n", asyncId-2, err, cuda_error_code(err));
 				exit(1);
     		}
 		}
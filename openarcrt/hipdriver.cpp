@@ -3,7 +3,6 @@
 #include <sstream>
 
 std::map<const void *, int> HipDriver::pinnedHostMemCounter;
-std::vector<const void *> HipDriver::hostMemToUnpin;
 
 HipDriver::HipDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char *baseFileName) {
 #ifdef _OPENARC_PROFILE_
@@ -151,12 +150,13 @@ HI_error_t HipDriver::init(int threadID) {
     eventMap[0+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e0;
     eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
     threadQueueEventMap[thread_id] = eventMap;
-    masterAddressTableMap[thread_id] = new addresstable_t();
+    masterAddressTableMap[thread_id] = new presenttable_t();
     masterHandleTable[thread_id] = new memhandlemap_t();
     postponedFreeTableMap[thread_id] = new asyncfreetable_t();
     postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
     postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-    memPoolMap[thread_id] = new memPool_t();
+    postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+    memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit, MEMPOOL_MIN_BLOCK_SIZE);
     tempMallocSizeMap[thread_id] = new sizemap_t();
 
     createKernelArgMap();
@@ -201,6 +201,7 @@ HI_error_t HipDriver::createKernelArgMap(int threadID) {
 
 	tconf->kernelArgsMap[this] = kernelArgs;
     tconf->kernelsMap[this]=kernelMap;
+    tconf->resetKernelHandles(this);
     int thread_id = tconf->threadID;
     if( queueMap.count(0+thread_id*MAX_NUM_QUEUES_PER_THREAD) == 0 ) {
 		hipStream_t s0, s1;
@@ -259,12 +260,13 @@ HI_error_t HipDriver::createKernelArgMap(int threadID) {
 #endif
         eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
         threadQueueEventMap[thread_id] = eventMap;
-        masterAddressTableMap[thread_id] = new addresstable_t();
+        masterAddressTableMap[thread_id] = new presenttable_t();
         masterHandleTable[thread_id] = new memhandlemap_t();
         postponedFreeTableMap[thread_id] = new asyncfreetable_t();
         postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
         postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-        memPoolMap[thread_id] = new memPool_t();
+        postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+        memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit, MEMPOOL_MIN_BLOCK_SIZE);
         tempMallocSizeMap[thread_id] = new sizemap_t();
 #ifdef INIT_DEBUG
         fprintf(stderr, "[DEBUG] HIP events are created.\n");
@@ -389,12 +391,13 @@ HI_error_t HipDriver::HI_register_kernels(std::set<std::string>kernelNames, int
 #endif
         eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
         threadQueueEventMap[thread_id] = eventMap;
-        masterAddressTableMap[thread_id] = new addresstable_t();
+        masterAddressTableMap[thread_id] = new presenttable_t();
         masterHandleTable[thread_id] = new memhandlemap_t();
         postponedFreeTableMap[thread_id] = new asyncfreetable_t();
         postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
         postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-        memPoolMap[thread_id] = new memPool_t();
+        postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+        memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit, MEMPOOL_MIN_BLOCK_SIZE);
         tempMallocSizeMap[thread_id] = new sizemap_t();
 #ifdef INIT_DEBUG
         fprintf(stderr, "[DEBUG] HIP events are created.\n");
@@ -661,231 +664,97 @@ void HipDriver::inc_pinned_host_memory_counter(const void* hostPtr)
 #endif
 }
 
-//Unpin host memories whose counters are less than 1.
-//This also frees corresponding device memory.
-void HipDriver::unpin_host_memory_all(int asyncID, int threadID)
-{
-#ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::unpin_host_memory_all(%d)\n", asyncID);
-    }
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_pin_host_memory);
-#else
-#ifdef _OPENMP
-    #pragma omp critical (pin_host_memory_critical)
-#endif
-#endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-        #pragma omp critical (victim_cache_critical)
-#endif
-#endif
-        {
-        addresstable_t::iterator it = HipDriver::auxAddressTable.find(asyncID);
-        if(it != HipDriver::auxAddressTable.end()) {
-            HipDriver::hostMemToUnpin.clear();
-            for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-                const void * host = it2->first;
-                //If the hostPtr is already pinned
-                if(HipDriver::pinnedHostMemCounter.find(host) != HipDriver::pinnedHostMemCounter.end()) {
-                    if(HipDriver::pinnedHostMemCounter[host] < 1) {
-                        hipError_t hipResult = hipHostUnregister((void*)host);
-                        if(hipResult == hipSuccess){
-                            HipDriver::pinnedHostMemCounter.erase(host);
-                            HipDriver::hostMemToUnpin.push_back(it2->first);
-#ifdef _OPENARC_PROFILE_
-                            tconf->IPFreeCnt++;
-#endif
-                        } else {
-                            fprintf(stderr, "[ERROR in HipDriver::unpin_host_memory_all(%d)] Cannot unpin host memory with error %d\n", asyncID, hipResult);
-                            exit(1);
-                        }
-                        //Free corresponding device memory.
-                        addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-                        hipFree(aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-                        tconf->IDFreeCnt++;
-                        //[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-
-                    }
-                }
-            }
-            while( !HipDriver::hostMemToUnpin.empty() ) {
-                (it->second)->erase(HipDriver::hostMemToUnpin.back());
-                HipDriver::hostMemToUnpin.pop_back();
-            }
-        }
-        }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-    }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_pin_host_memory);
-#endif
+//Release the least recently cached entries in the victim cache of the 
+//host thread, until at least size bytes are released or the cache is 
+//empty, and return the number of bytes released.
+//The prepinned host memory of a released entry is also unpinned, unless 
+//the host memory is mapped again.
+size_t HipDriver::evict_victim_cache_entries(size_t size, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::unpin_host_memory_all(%d)\n", asyncID);
+        fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::evict_victim_cache_entries(%lu)\n", size);
     }
 #endif
-}
-
-//Unpin host memories whose counters are less than 1.
-void HipDriver::unpin_host_memory_all(int threadID)
-{
-#ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::unpin_host_memory_all()\n");
-    }
     HostConf_t * tconf = getHostConf(threadID);
-#endif
+    size_t releasedSize = 0;
+    victimcache_entry_t entry;
+    while( (releasedSize < size) && (HI_pop_victim_cache_entry(&entry, tconf->threadID) == HI_success) ) {
+        if( tconf->prepin_host_memory == 1 ) {
 #ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_pin_host_memory);
+            pthread_mutex_lock(&mutex_pin_host_memory);
 #else
 #ifdef _OPENMP
-    #pragma omp critical (pin_host_memory_critical)
+            #pragma omp critical (pin_host_memory_critical)
 #endif
 #endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-        #pragma omp critical (victim_cache_critical)
-#endif
-#endif
-        for( addresstable_t::iterator it = HipDriver::auxAddressTable.begin(); it != HipDriver::auxAddressTable.end(); ++it) {
-            HipDriver::hostMemToUnpin.clear();
-            for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-                const void * host = it2->first;
-                //If the hostPtr is already pinned
-                if(HipDriver::pinnedHostMemCounter.find(host) != HipDriver::pinnedHostMemCounter.end()) {
-                    if(HipDriver::pinnedHostMemCounter[host] < 1) {
-                        hipError_t hipResult = hipHostUnregister((void*)host);
-                        if(hipResult == hipSuccess){
-                            HipDriver::pinnedHostMemCounter.erase(host);
-                            HipDriver::hostMemToUnpin.push_back(it2->first);
-#ifdef _OPENARC_PROFILE_
-                            tconf->IDFreeCnt++;
-                            //[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-                        } else {
-                            fprintf(stderr, "[ERROR in HipDriver::unpin_host_memory_all()] Cannot unpin host memory with error %d\n", hipResult);
-                            exit(1);
-                        }
-                        //Free corresponding device memory.
-                        addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-                        hipFree(aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-                        tconf->IDFreeCnt++;
-                        //[FIXME] tconf->CIDMemorySize should be adjusted here.
+            {
+            std::map<const void *,int>::iterator it = HipDriver::pinnedHostMemCounter.find(entry.hostPtr);
+            if( (it != HipDriver::pinnedHostMemCounter.end()) && (it->second < 1) ) {
+                hipError_t hipResult = hipHostUnregister((void*)entry.hostPtr);
+                if(hipResult == hipSuccess){
+                    HipDriver::pinnedHostMemCounter.erase(it);
+#ifdef _OPENARC_PROFILE_
+                    tconf->IPFreeCnt++;
 #endif
-                    }
+                } else {
+                    fprintf(stderr, "[ERROR in HipDriver::evict_victim_cache_entries()] Cannot unpin host memory with error %d\n", hipResult);
+                    exit(1);
                 }
             }
-            while( !HipDriver::hostMemToUnpin.empty() ) {
-                (it->second)->erase(HipDriver::hostMemToUnpin.back());
-                HipDriver::hostMemToUnpin.pop_back();
             }
-        }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-    }
 #ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_pin_host_memory);
-#endif
-#ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::unpin_host_memory_all()\n");
-    }
-#endif
-}
-
-void HipDriver::release_freed_device_memory(int asyncID, int threadID)
-{
-#ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::release_freed_device_memory(%d)\n", asyncID);
-    }
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-        #pragma omp critical (victim_cache_critical)
-#endif
+            pthread_mutex_unlock(&mutex_pin_host_memory);
 #endif
-        {
-        addresstable_t::iterator it = HipDriver::auxAddressTable.find(asyncID);
-        if(it != HipDriver::auxAddressTable.end()) {
-            for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-                //Free corresponding device memory.
-                addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-                hipFree(aet->basePtr);
-#ifdef _OPENARC_PROFILE_
-                tconf->IDFreeCnt++;
-                //[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-            }
         }
+        hipError_t hipResult = hipFree(entry.devPtr);
+        if( hipResult != hipSuccess ) {
+            fprintf(stderr, "[ERROR in HipDriver::evict_victim_cache_entries()] failed to free on HIP with error %d\n", hipResult);
         }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+        releasedSize += entry.size;
+#ifdef _OPENARC_PROFILE_
+        tconf->IDFreeCnt++;
+        tconf->CIDMemorySize -= entry.size;
 #endif
     }
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::release_freed_device_memory(%d)\n", asyncID);
+        fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::evict_victim_cache_entries(%lu)\n", releasedSize);
     }
 #endif
+    return releasedSize;
 }
 
-void HipDriver::release_freed_device_memory(int threadID)
-{
+//Return the least recently freed chunks in the memory pool to the device, 
+//until at least size bytes are released or no entirely free chunk is left,
+//and return the number of bytes released.
+size_t HipDriver::evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID) {
 #ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::release_freed_device_memory()\n");
-    }
-    HostConf_t * tconf = getHostConf(threadID);
-#endif
-    {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-        #pragma omp critical (victim_cache_critical)
-#endif
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::evict_mempool_chunks(%lu)\n", size);
+	}
 #endif
-        for( addresstable_t::iterator it = HipDriver::auxAddressTable.begin(); it != HipDriver::auxAddressTable.end(); ++it ) {
-            for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-                //Free corresponding device memory.
-                addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-                hipFree(aet->basePtr);
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	void *tDevPtr;
+	size_t chunkSize;
+	while( (releasedSize < size) && memPool->popFreeChunk(&tDevPtr, &chunkSize) ) {
+		hipError_t hipResult = hipFree(tDevPtr);
+		if( hipResult != hipSuccess ) {
+			fprintf(stderr, "[ERROR in HipDriver::evict_mempool_chunks()] failed to free on HIP with error %d\n", hipResult);
+		}
+		current_mempool_size -= chunkSize;
+		releasedSize += chunkSize;
 #ifdef _OPENARC_PROFILE_
-                tconf->IDFreeCnt++;
-                //[FIXME] tconf->CIDMemorySize should be adjusted here.
-#endif
-            }
-        }
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+		tconf->IDFreeCnt++;
+		tconf->CIDMemorySize -= chunkSize;
 #endif
-    }
+	}
 #ifdef _OPENARC_PROFILE_
-    if( HI_openarcrt_verbosity > 2 ) {
-        fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::release_freed_device_memory()\n");
-    }
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit HipDriver::evict_mempool_chunks(%lu)\n", releasedSize);
+	}
 #endif
+	return releasedSize;
 }
 
 HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags, int threadID) {
@@ -922,16 +791,15 @@ HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t cou
     	hipError_t hipResult = hipSuccess;
 #if VICTIM_CACHE_MODE <= 1
         memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, devPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_malloc1D(%d, %lu) reuses memories in the memPool\n", asyncID, count);
             }
 #endif
-            *devPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= count;
+            current_mempool_size -= blockSize;
         } else {
             if( current_mempool_size > tconf->max_mempool_size ) {
 #ifdef _OPENARC_PROFILE_
@@ -939,25 +807,13 @@ HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t cou
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_malloc1D(%d, %lu) releases memories in the memPool\n", asyncID, count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *devPtr = it->second;
-					hipResult = hipFree(*devPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_malloc1D()] failed to free on HIP with error %d\n", hipResult);
-                    }
-                }
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
             }
-    		hipResult = hipMalloc(devPtr, count);
+    		hipResult = hipMalloc(devPtr, allocSize);
 #ifdef _OPENARC_PROFILE_
             tconf->IDMallocCnt++;
-            tconf->IDMallocSize += count;
-            tconf->CIDMemorySize += count;
+            tconf->IDMallocSize += allocSize;
+            tconf->CIDMemorySize += allocSize;
             if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
                 tconf->MIDMemorySize = tconf->CIDMemorySize;
             }
@@ -968,20 +824,12 @@ HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t cou
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_malloc1D(%d, %lu) releases memories in the memPool\n", asyncID, count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *devPtr = it->second;
-					hipResult = hipFree(*devPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_malloc1D()] failed to free on HIP with error %d\n", hipResult);
-                    }
+                while( (hipResult != hipSuccess) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	hipResult = hipMalloc(devPtr, allocSize);
                 }
-                memPool->clear();
-    			hipResult = hipMalloc(devPtr, count);
+            }
+            if( hipResult == hipSuccess ) {
+                memPool->addChunk(*devPtr, allocSize, count);
             }
         }
         if( hipResult == hipSuccess ) {
@@ -1007,12 +855,15 @@ HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t cou
         ///////////////////////////
         // VICTIM_CACHE_MODE = 2 //
         ///////////////////////////
-        if(HI_get_device_address_from_victim_cache(hostPtr, devPtr, NULL, NULL, asyncID, tconf->threadID) == HI_success ) {
+        size_t allocSize = 0;
+        if(HI_get_device_address_from_victim_cache(hostPtr, (size_t) count, (tconf->prepin_host_memory == 0), devPtr, &allocSize, asyncID, tconf->threadID) == HI_success ) {
             result = HI_success;
+            if( allocSize > count ) {
+                HI_set_victim_cache_alloc_size(*devPtr, allocSize, tconf->threadID);
+            }
             if( tconf->prepin_host_memory == 1 ) {
                 inc_pinned_host_memory_counter(hostPtr);
             }
-            HI_remove_device_address_from_victim_cache(hostPtr, asyncID, tconf->threadID);
         } else {
 #ifdef _OPENARC_PROFILE_
             tconf->IDMallocCnt++;
@@ -1023,36 +874,16 @@ HI_error_t HipDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t cou
             }
 #endif
     		hipResult = hipMalloc(devPtr, count);
-            if (hipResult != hipSuccess) {
-                if( tconf->prepin_host_memory == 1 ) {
-                    unpin_host_memory_all(asyncID, tconf->threadID);
-                } else {
-                    release_freed_device_memory(asyncID, tconf->threadID);
-                    HI_reset_victim_cache(asyncID);
-                }
-                //Try to allocate device memory again.
+            //Release the least recently cached device memory until the 
+            //allocation succeeds.
+            while( (hipResult != hipSuccess) && (evict_victim_cache_entries((size_t) count, tconf->threadID) > 0) ) {
     			hipResult = hipMalloc(devPtr, count);
-                if (hipResult != hipSuccess) {
-                    if( tconf->prepin_host_memory == 1 ) {
-                        unpin_host_memory_all(tconf->threadID);
-                    } else {
-                        release_freed_device_memory(tconf->threadID);
-                        HI_reset_victim_cache_all();
-                    }
-                    //Try to allocate device memory again.
-    				hipResult = hipMalloc(devPtr, count);
-                }
             }
             if( hipResult == hipSuccess ) {
                 //Pin host memory
                 if( tconf->prepin_host_memory == 1 ) {
                     result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
-                    if( result != HI_success ) {
-                        unpin_host_memory_all(asyncID);
-                        result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
-                    }
-                    if( result != HI_success ) {
-                        unpin_host_memory_all();
+                    while( (result != HI_success) && (evict_victim_cache_entries((size_t) count, tconf->threadID) > 0) ) {
                         result = HI_pin_host_memory(hostPtr, (size_t) count, tconf->threadID);
                     }
                     if( result != HI_success ) {
@@ -1115,8 +946,7 @@ HI_error_t HipDriver::HI_free( const void *hostPtr, int asyncID, int threadID) {
             //We do not free the device memory; instead put it in the memory pool 
             //and remove host-pointer-to-device-pointer mapping.
             memPool_t *memPool = memPoolMap[tconf->threadID];
-            memPool->insert(std::pair<size_t, void *>(size, devPtr));
-            current_mempool_size += size;
+            current_mempool_size += memPool->release(devPtr, size);
             HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
             // Unpin host memory
             HI_unpin_host_memory(hostPtr, tconf->threadID);
@@ -1126,6 +956,8 @@ HI_error_t HipDriver::HI_free( const void *hostPtr, int asyncID, int threadID) {
             // VICTIM_CACHE_MODE = 2 //
             ///////////////////////////
             HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
+            //A buffer taken from the cache can be larger than its mapping.
+            size = HI_remove_victim_cache_alloc_size(devPtr, size, tconf->threadID);
             HI_set_device_address_in_victim_cache(hostPtr, devPtr, size, asyncID, tconf->threadID);
            // Decrease pinned host memory counter
             if( tconf->prepin_host_memory == 1 ) {
@@ -1133,6 +965,10 @@ HI_error_t HipDriver::HI_free( const void *hostPtr, int asyncID, int threadID) {
             } else {
                 HI_unpin_host_memory(hostPtr, tconf->threadID);
             }
+            //Keep the victim cache within the memory pool budget.
+            if( HI_get_victim_cache_size(tconf->threadID) > tconf->max_mempool_size ) {
+                evict_victim_cache_entries(HI_get_victim_cache_size(tconf->threadID) - tconf->max_mempool_size, tconf->threadID);
+            }
 #endif
 #if VICTIM_CACHE_MODE == 0
             hipError_t hipResult = hipSuccess;
@@ -1427,16 +1263,15 @@ void HipDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t devT
         hipError_t hipResult = hipSuccess;
         memPool_t *memPool = memPoolMap[tconf->threadID];
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_tempMalloc1D(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= count;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
         } else {
             if( current_mempool_size > tconf->max_mempool_size ) {
@@ -1445,49 +1280,27 @@ void HipDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t devT
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_malloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    hipResult = hipFree(*tempPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_tempMalloc1D()] failed to free on HIP with error %d\n", hipResult);
-                    }
-                }
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
             }
-            hipResult = hipMalloc(tempPtr, count);
+            hipResult = hipMalloc(tempPtr, allocSize);
             if (hipResult != hipSuccess) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_malloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    hipResult = hipFree(*tempPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_tempMalloc1D()] failed to free on HIP with error %d\n", hipResult);
-                    }
+                while( (hipResult != hipSuccess) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	hipResult = hipMalloc(tempPtr, allocSize);
                 }
-                memPool->clear();
-                hipResult = hipMalloc(tempPtr, count);
             }
             if(hipResult == hipSuccess) {
                 //New temporary device memory is allocated.
                 (*tempMallocSize)[(const void *)*tempPtr] = count;
+                memPool->addChunk(*tempPtr, allocSize, count);
 #ifdef _OPENARC_PROFILE_
                 tconf->IDMallocCnt++;
-                tconf->IDMallocSize += count;
-                tconf->CIDMemorySize += count;
+                tconf->IDMallocSize += allocSize;
+                tconf->CIDMemorySize += allocSize;
                 if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
                     tconf->MIDMemorySize = tconf->CIDMemorySize;
                 }
@@ -1555,16 +1368,15 @@ void HipDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device_
         hipError_t hipResult = hipSuccess;
         memPool_t *memPool = memPoolMap[tconf->threadID];
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        size_t allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_tempMalloc1D_async(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= count;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
         } else {
             if( current_mempool_size > tconf->max_mempool_size ) {
@@ -1573,49 +1385,27 @@ void HipDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device_
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    hipResult = hipFree(*tempPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_tempMalloc1D_async()] failed to free on HIP with error %d\n", hipResult);
-                    }
-                }
-                memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
             }
-            hipResult = hipMalloc(tempPtr, count);
+            hipResult = hipMalloc(tempPtr, allocSize);
             if (hipResult != hipSuccess) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tHipDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    *tempPtr = it->second;
-                    hipResult = hipFree(*tempPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_ 
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-                    if(hipResult != hipSuccess) {
-                        fprintf(stderr, "[ERROR in HipDriver::HI_tempMalloc1D_async()] failed to free on HIP with error %d\n", hipResult);
-                    }
+                while( (hipResult != hipSuccess) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	hipResult = hipMalloc(tempPtr, allocSize);
                 }
-                memPool->clear();
-                hipResult = hipMalloc(tempPtr, count);
             }
             if(hipResult == hipSuccess) {
                 //New temporary device memory is allocated.
                 (*tempMallocSize)[(const void *)*tempPtr] = count;
+                memPool->addChunk(*tempPtr, allocSize, count);
 #ifdef _OPENARC_PROFILE_
                 tconf->IDMallocCnt++;
-                tconf->IDMallocSize += count;
-                tconf->CIDMemorySize += count;
+                tconf->IDMallocSize += allocSize;
+                tconf->CIDMemorySize += allocSize;
                 if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
                     tconf->MIDMemorySize = tconf->CIDMemorySize;
                 }
@@ -1698,8 +1488,7 @@ void HipDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threadID)
                 }
             } else {
                 size_t size = tempMallocSize->at((const void *)tempPtr);
-                memPool->insert(std::pair<size_t, void *>(size, tempPtr));
-                current_mempool_size += size;
+                current_mempool_size += memPool->release(tempPtr, size);
                 tempMallocSize->erase((const void *)tempPtr);
             }
         }
@@ -1905,20 +1694,21 @@ HI_error_t HipDriver::HI_memcpy_async(void *dst, const void *src, size_t count,
     return HI_success;
 }
 
-HI_error_t HipDriver::HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID) {
+HI_error_t HipDriver::HI_register_kernel_numargs(int kernel_id, int num_args, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::HI_register_kernel_numargs()\n");
     }
 #endif
     HostConf_t *tconf = getHostConf(threadID);
-	kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+	kernelParams_t *kernelParams = kernelHandle->kernelParams;
 	if( kernelParams->num_args == 0 ) {
 		if( num_args > 0 ) {
 			kernelParams->num_args = num_args;
     		kernelParams->kernelParams = (void**)malloc(sizeof(void*) * num_args);
 		} else {
-        	fprintf(stderr, "[ERROR in HipDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernel_name.c_str(), num_args);
+        	fprintf(stderr, "[ERROR in HipDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernelHandle->kernelName, num_args);
 			exit(1);
 		}
 	}
@@ -1930,18 +1720,19 @@ HI_error_t HipDriver::HI_register_kernel_numargs(std::string kernel_name, int nu
     return HI_success;
 }
 
-HI_error_t HipDriver::HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
+HI_error_t HipDriver::HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::HI_register_kernel_arg()\n");
     }
 #endif
     HostConf_t *tconf = getHostConf(threadID);
-	kernelParams_t * kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+	kernelParams_t * kernelParams = kernelHandle->kernelParams;
 	if( kernelParams->num_args > arg_index ) {
 		*(kernelParams->kernelParams + arg_index) = arg_value;
 	} else {
-		fprintf(stderr, "[ERROR in HipDriver::HI_register_kernel_arg()] Kernel %s is registered to have %d arguments, but the current argument index %d is out of the bound.\n",kernel_name.c_str(), kernelParams->num_args, arg_index);
+		fprintf(stderr, "[ERROR in HipDriver::HI_register_kernel_arg()] Kernel %s is registered to have %d arguments, but the current argument index %d is out of the bound.\n",kernelHandle->kernelName, kernelParams->num_args, arg_index);
 		exit(1);
 	}
 #ifdef _OPENARC_PROFILE_
@@ -1952,8 +1743,10 @@ HI_error_t HipDriver::HI_register_kernel_arg(std::string kernel_name, int arg_in
     return HI_success;
 }
 
-HI_error_t HipDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
-    const char* c_kernel_name = kernel_name.c_str();
+HI_error_t HipDriver::HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
+    HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+    const char* c_kernel_name = kernelHandle->kernelName;
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter HipDriver::HI_kernel_call(%s, %d)\n",c_kernel_name, async);
@@ -1967,7 +1760,6 @@ HI_error_t HipDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3]
         fprintf(stderr, "[ERROR in HipDriver::HI_kernel_call()] Kernel [%s] Launch FAIL due to too large threadBlock configuration (%lu, %lu, %lu); exit!\n",c_kernel_name, blockSize[2], blockSize[1], blockSize[0]);
         exit(1);
     }
-    HostConf_t *tconf = getHostConf(threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1978,12 +1770,12 @@ HI_error_t HipDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3]
     hipStream_t stream = getQueue(async, tconf->threadID);
     hipEvent_t event = getEvent(async, tconf->threadID);
     if(async != DEFAULT_QUEUE+tconf->asyncID_offset) {
-    	err = hipModuleLaunchKernel(tconf->kernelsMap.at(this).at(kernel_name), gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, stream, (tconf->kernelArgsMap.at(this).at(kernel_name))->kernelParams, NULL);
+    	err = hipModuleLaunchKernel(kernelHandle->kernel, gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, stream, kernelHandle->kernelParams->kernelParams, NULL);
 
         hipEventRecord(event, stream);
 
     } else {
-    	err = hipModuleLaunchKernel(tconf->kernelsMap.at(this).at(kernel_name), gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, 0, (tconf->kernelArgsMap.at(this).at(kernel_name))->kernelParams, NULL);
+    	err = hipModuleLaunchKernel(kernelHandle->kernel, gridSize[0], gridSize[1], gridSize[2], blockSize[0], blockSize[1], blockSize[2], 0, 0, kernelHandle->kernelParams->kernelParams, NULL);
     }
     if (err != hipSuccess) {
         fprintf(stderr, "[ERROR in HipDriver::HI_kernel_call(%s)] Kernel Launch FAIL with error %d\n",c_kernel_name, err);
@@ -1994,16 +1786,16 @@ HI_error_t HipDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3]
     }
 
 #ifdef _OPENARC_PROFILE_
-    if(tconf->KernelCNTMap.count(kernel_name) == 0) {
-        tconf->KernelCNTMap[kernel_name] = 0;
+    if(tconf->KernelCNTMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelCNTMap[kernelHandle->kernelName] = 0;
     }
-    tconf->KernelCNTMap[kernel_name] += 1;
-    if(tconf->KernelTimingMap.count(kernel_name) == 0) {
-        tconf->KernelTimingMap[kernel_name] = 0.0;
+    tconf->KernelCNTMap[kernelHandle->kernelName] += 1;
+    if(tconf->KernelTimingMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelTimingMap[kernelHandle->kernelName] = 0.0;
     }
     err = hipStreamSynchronize(stream);
     err = hipStreamSynchronize(0);
-    tconf->KernelTimingMap[kernel_name] += HI_get_localtime() - ltime;
+    tconf->KernelTimingMap[kernelHandle->kernelName] += HI_get_localtime() - ltime;
 #endif
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
@@ -2059,6 +1851,8 @@ void HipDriver::HI_set_async(int asyncId, int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     int thread_id = tconf->threadID;
+    hipStream_t asyncStream;
+    hipEvent_t markerEvent;
 #ifdef _THREAD_SAFETY
         pthread_mutex_lock(&mutex_set_async);
 #else
@@ -2078,6 +1872,17 @@ void HipDriver::HI_set_async(int asyncId, int threadID) {
             hipStreamCreateWithFlags(&str, hipStreamNonBlocking);
 #endif
             queueMap[asyncId] = str;
+            asyncStream = str;
+        } else {
+            asyncStream = it->second;
+        }
+
+        std::map<int, hipEvent_t>::iterator mit = threadMarkerEventMap.find(thread_id);
+        if(mit == threadMarkerEventMap.end()) {
+            hipEventCreateWithFlags(&markerEvent, hipEventDisableTiming);
+            threadMarkerEventMap[thread_id] = markerEvent;
+        } else {
+            markerEvent = mit->second;
         }
 
         std::map<int, std::map<int, hipEvent_t> >::iterator threadIt;
@@ -2109,16 +1914,25 @@ void HipDriver::HI_set_async(int asyncId, int threadID) {
         //We need explicit synchronization here for the default queue 
         //since HI_synchronize() does not explicitly synchronize if 
         //unified memory is not used.
+        //Instead of blocking the host until the default stream (and the NULL 
+        //stream) drain, the async stream waits for a marker event recorded 
+        //on them; no wait is added if the marker has already completed.
         hipStream_t stream = getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID);
-        hipError_t err = hipStreamSynchronize(stream);
-        if (err != hipSuccess) {
-            fprintf(stderr, "[ERROR in HipDriver::HI_set_async()] DEFAULT_QUEUE Context Synchronization FAIL with error %d \n", err);
-            exit(1);
-        }
-        if( stream != 0 ) {
-            err = hipStreamSynchronize(0);
+        hipStream_t depStreams[2] = {stream, 0};
+        int numDepStreams = (stream != 0) ? 2 : 1;
+        for( int i=0; i<numDepStreams; i++ ) {
+            if( depStreams[i] == asyncStream ) {
+                continue;
+            }
+            hipError_t err = hipEventRecord(markerEvent, depStreams[i]);
+            if( err == hipSuccess ) {
+                err = hipEventQuery(markerEvent);
+                if( err == hipErrorNotReady ) {
+                    err = hipStreamWaitEvent(asyncStream, markerEvent, 0);
+                }
+            }
             if (err != hipSuccess) {
-                fprintf(stderr, "[ERROR in HipDriver::HI_set_async()] Default Context Synchronization FAIL with error %d \n", err);
+                fprintf(stderr, "[ERROR in HipDriver::HI_set_async()] failed to order async stream %d after the default stream with error %d \n", asyncId-2, err);
                 exit(1);
             }
         }
@@ -304,13 +304,14 @@ HI_error_t IrisDriver::init(int threadID) {
   }
 */
 
-  masterAddressTableMap[thread_id] = new addresstable_t();
+  masterAddressTableMap[thread_id] = new presenttable_t();
   masterHandleTable[thread_id] = new memhandlemap_t();
   postponedFreeTableMap[thread_id] = new asyncfreetable_t();
   postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
   postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-  memPoolMap[thread_id] = new memPool_t();
-  tempMemPoolMap[thread_id] = new memPool_t();
+  postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+  memPoolMap[thread_id] = new memPool_t((openarcrt_iris_dmem == 1) ? 0 : HI_mempool_frag_limit, 0, openarcrt_iris_dmem != 1);
+  tempMemPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
   tempMallocSizeMap[thread_id] = new sizemap_t();
   threadAsyncMap[thread_id] = NO_QUEUE;
   //threadTaskMap[thread_id] = NULL;
@@ -375,14 +376,15 @@ HI_error_t IrisDriver::HI_register_kernels(std::set<std::string>kernelNames, int
   return HI_success;
 }
 
-HI_error_t IrisDriver::HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID) {
+HI_error_t IrisDriver::HI_register_kernel_numargs(int kernel_id, int num_args, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter IrisDriver::HI_register_kernel_numargs(thread ID = %d)\n", threadID);
     }
 #endif
   HostConf_t *tconf = getHostConf(threadID);
-  kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+  kernelParams_t *kernelParams = kernelHandle->kernelParams;
   if( kernelParams->num_args == 0 ) {
     if( num_args > 0 ) {
       kernelParams->num_args = num_args;
@@ -391,7 +393,7 @@ HI_error_t IrisDriver::HI_register_kernel_numargs(std::string kernel_name, int n
       kernelParams->kernelParamsInfo = (int*)malloc(sizeof(int) * num_args);
       kernelParams->kernelParamMems = (iris_mem*)malloc(sizeof(iris_mem) * num_args);
     } else {
-      fprintf(stderr, "[ERROR in IrisDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernel_name.c_str(), num_args);
+      fprintf(stderr, "[ERROR in IrisDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernelHandle->kernelName, num_args);
       exit(1);
     }
   }
@@ -403,7 +405,7 @@ HI_error_t IrisDriver::HI_register_kernel_numargs(std::string kernel_name, int n
   return HI_success;
 }
 
-HI_error_t IrisDriver::HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
+HI_error_t IrisDriver::HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter IrisDriver::HI_register_kernel_arg(thread ID = %d)\n", threadID);
@@ -413,7 +415,8 @@ HI_error_t IrisDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
 	}
 #endif
   HostConf_t *tconf = getHostConf(threadID);
-  kernelParams_t * kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+  kernelParams_t * kernelParams = kernelHandle->kernelParams;
   int err;
   if( arg_type == 0 ) {
     *(kernelParams->kernelParams + arg_index) = arg_value;
@@ -421,7 +424,7 @@ HI_error_t IrisDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
     *(kernelParams->kernelParamsInfo + arg_index) = (int)arg_size;
      iris_mem iMem;
     *(kernelParams->kernelParamMems + arg_index) = iMem;
-    //err = iris_kernel_setarg((iris_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, arg_size, arg_value);
+    //err = iris_kernel_setarg((iris_kernel)(kernelHandle->kernel), arg_index, arg_size, arg_value);
   } else {
     HI_device_mem_handle_t tHandle;
     if( HI_get_device_mem_handle(*((void **)arg_value), &tHandle, tconf->threadID) == HI_success ) {
@@ -439,10 +442,10 @@ HI_error_t IrisDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
       	*(kernelParams->kernelParamsInfo + arg_index) = 0;
       }
       *(kernelParams->kernelParamMems + arg_index) = tHandle.memHandle;
-      //err = iris_kernel_setmem_off((iris_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, *((iris_mem*) &(tHandle.memHandle)), tHandle.offset, iris_rw);
+      //err = iris_kernel_setmem_off((iris_kernel)(kernelHandle->kernel), arg_index, *((iris_mem*) &(tHandle.memHandle)), tHandle.offset, iris_rw);
       //if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
     } else {
-		fprintf(stderr, "[ERROR in IrisDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (IRIS Device)\n", arg_index, kernel_name.c_str());
+		fprintf(stderr, "[ERROR in IrisDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (IRIS Device)\n", arg_index, kernelHandle->kernelName);
 #ifdef _OPENARC_PROFILE_
 		HI_print_device_address_mapping_entries(tconf->threadID);
 #endif
@@ -457,14 +460,15 @@ HI_error_t IrisDriver::HI_register_kernel_arg(std::string kernel_name, int arg_i
   return HI_success;
 }
 
-HI_error_t IrisDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
-    const char* c_kernel_name = kernel_name.c_str();
+HI_error_t IrisDriver::HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
+    HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+    const char* c_kernel_name = kernelHandle->kernelName;
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\tenter IrisDriver::HI_kernel_call(%s, async ID = %d, thread ID = %d)\n",c_kernel_name, async, threadID);
     }
 #endif
-  HostConf_t *tconf = getHostConf(threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -482,15 +486,15 @@ HI_error_t IrisDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3
     iris_task_create(&task);
   }
   size_t gws[3] = { gridSize[0] * blockSize[0], gridSize[1] * blockSize[1], gridSize[2] * blockSize[2] };
-  kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+  kernelParams_t *kernelParams = kernelHandle->kernelParams;
   int num_args = kernelParams->num_args;
   for(int i=0; i<num_args; i++) {
     if( kernelParams->kernelParams[i] == NULL ) {
         kernelParams->kernelParams[i] = &(kernelParams->kernelParamMems[i]);
     }
   }
-  //iris_task_kernel(task, kernel_name.c_str(), 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsInfo);
-  iris_task_kernel_v2(task, kernel_name.c_str(), 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsOffset, kernelParams->kernelParamsInfo);
+  //iris_task_kernel(task, kernelHandle->kernelName, 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsInfo);
+  iris_task_kernel_v2(task, kernelHandle->kernelName, 3, NULL, gws, blockSize, kernelParams->num_args, kernelParams->kernelParams, kernelParams->kernelParamsOffset, kernelParams->kernelParamsInfo);
 
   threadtaskmapiris_t *asyncTaskMap = threadAsyncTaskMap[threadID];
   int nTasks = 0;
@@ -584,14 +588,14 @@ HI_error_t IrisDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3
   	threadAsyncMap[threadID] = async;
   }
 #ifdef _OPENARC_PROFILE_
-    if(tconf->KernelCNTMap.count(kernel_name) == 0) {
-        tconf->KernelCNTMap[kernel_name] = 0;
+    if(tconf->KernelCNTMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelCNTMap[kernelHandle->kernelName] = 0;
     }        
-    tconf->KernelCNTMap[kernel_name] += 1;
-    if(tconf->KernelTimingMap.count(kernel_name) == 0) {
-        tconf->KernelTimingMap[kernel_name] = 0.0;
+    tconf->KernelCNTMap[kernelHandle->kernelName] += 1;
+    if(tconf->KernelTimingMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelTimingMap[kernelHandle->kernelName] = 0.0;
     }        
-    tconf->KernelTimingMap[kernel_name] += HI_get_localtime() - ltime;
+    tconf->KernelTimingMap[kernelHandle->kernelName] += HI_get_localtime() - ltime;
 #endif   
 
   if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
@@ -668,6 +672,42 @@ HI_error_t IrisDriver::destroy(int threadID) {
   return HI_success;
 }
 
+//Return the least recently freed chunks in the memory pool to the device, 
+//until at least size bytes are released or no entirely free chunk is left,
+//and return the number of bytes released.
+size_t IrisDriver::evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter IrisDriver::evict_mempool_chunks(%lu)\n", size);
+	}
+#endif
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	void *tDevPtr;
+	size_t chunkSize;
+	while( (releasedSize < size) && memPool->popFreeChunk(&tDevPtr, &chunkSize) ) {
+		HI_device_mem_handle_t tHandle;
+		if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
+			int err = iris_mem_release((iris_mem) tHandle.memHandle);
+			if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
+			HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
+		}
+		free(tDevPtr);
+		current_mempool_size -= chunkSize;
+		releasedSize += chunkSize;
+#ifdef _OPENARC_PROFILE_
+		tconf->IDFreeCnt++;
+		tconf->CIDMemorySize -= chunkSize;
+#endif
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit IrisDriver::evict_mempool_chunks(%lu)\n", releasedSize);
+	}
+#endif
+	return releasedSize;
+}
+
 HI_error_t IrisDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags, int threadID) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 2 ) {
@@ -691,13 +731,13 @@ HI_error_t IrisDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t co
 		exit(1);
 	}    
   } else {
+    size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
     memPool_t *memPool = memPoolMap[tconf->threadID];
-    std::multimap<size_t, void *>::iterator it = memPool->find(count);
-	if( it != memPool->end()) {
-      *devPtr = it->second;
-      memPool->erase(it);
-      current_mempool_size -= count;
+    size_t blockSize = 0;
+    allocSize = memPool->getAllocSize(count);
+	if( memPool->allocate(count, devPtr, &blockSize) ) {
+      current_mempool_size -= blockSize;
       if( openarcrt_iris_dmem == 1 ) {
         HI_device_mem_handle_t tHandle;
         HI_get_device_mem_handle(*devPtr, &tHandle, tconf->threadID);
@@ -711,70 +751,42 @@ HI_error_t IrisDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t co
 	{
 #if VICTIM_CACHE_MODE > 0
 		if( current_mempool_size > tconf->max_mempool_size ) {
-    		HI_device_mem_handle_t tHandle;
-			void * tDevPtr;
-			for( it = memPool->begin(); it != memPool->end(); ++it ) {
-				tDevPtr = it->second;
-    			if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      				if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      				HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      				free(tDevPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-    			}
-			}	
-			memPool->clear();
+			evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 		}
 #endif	
 		
 		if( openarcrt_iris_dmem == 1 ) {
 			//fprintf(stdout, "[IRIS DMEM CREATE]\n");
-			err = iris_data_mem_create((iris_mem*) &memHandle, uc_hostPtr, count);
+			err = iris_data_mem_create((iris_mem*) &memHandle, uc_hostPtr, allocSize);
 		} else {
 			//fprintf(stdout, "[IRIS MEM CREATE]\n");
-      		err = iris_mem_create(count, (iris_mem*) &memHandle);
+      		err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
 		}
 
 #if VICTIM_CACHE_MODE > 0
       	if (err != IRIS_SUCCESS) {
-    		HI_device_mem_handle_t tHandle;
-			void * tDevPtr;
-			for( it = memPool->begin(); it != memPool->end(); ++it ) {
-				tDevPtr = it->second;
-    			if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      				if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      				HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      				free(tDevPtr);
-                    current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    tconf->IDFreeCnt++;
-                    tconf->CIDMemorySize -= it->first;
-#endif
-    			}
-			}	
-			memPool->clear();
-			if( openarcrt_iris_dmem == 1 ) {
-				//fprintf(stdout, "[IRIS DMEM CREATE]\n");
-				err = iris_data_mem_create((iris_mem*) &memHandle, uc_hostPtr, count);
-			} else {
-				//fprintf(stdout, "[IRIS MEM CREATE]\n");
-      			err = iris_mem_create(count, (iris_mem*) &memHandle);
+			while( (err != IRIS_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+				if( openarcrt_iris_dmem == 1 ) {
+					//fprintf(stdout, "[IRIS DMEM CREATE]\n");
+					err = iris_data_mem_create((iris_mem*) &memHandle, uc_hostPtr, allocSize);
+				} else {
+					//fprintf(stdout, "[IRIS MEM CREATE]\n");
+      				err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
+				}
 			}
       		if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 		}
 #endif
-      	*devPtr = malloc(count);
+      	*devPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+		memPool->addChunk(*devPtr, allocSize, count);
+#endif
       	HI_set_device_address(hostPtr, *devPtr, count, asyncID, tconf->threadID);
-      	HI_set_device_mem_handle(*devPtr, memHandle, count, tconf->threadID);
+      	HI_set_device_mem_handle(*devPtr, memHandle, allocSize, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 		tconf->IDMallocCnt++;
-		tconf->IDMallocSize += count;
-		tconf->CIDMemorySize += count;
+		tconf->IDMallocSize += allocSize;
+		tconf->CIDMemorySize += allocSize;
 		if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 			tconf->MIDMemorySize = tconf->CIDMemorySize;
 		}    
@@ -1092,8 +1104,7 @@ HI_error_t IrisDriver::HI_free( const void *hostPtr, int asyncID, int threadID)
             //We do not free the device memory; instead put it in the memory pool
             //and remove host-pointer-to-device-pointer mapping
             memPool_t *memPool = memPoolMap[tconf->threadID];
-            memPool->insert(std::pair<size_t, void *>(size, devPtr));
-            current_mempool_size += size;
+            current_mempool_size += memPool->release(devPtr, size);
             HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
       		if( openarcrt_iris_dmem == 1 ) {
 				iris_unregister_pin_memory(const_cast<void*>(hostPtr));
@@ -1473,8 +1484,7 @@ void IrisDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threadID)
 #if VICTIM_CACHE_MODE > 0
 			if( tempMallocSize->count((const void *)tempPtr) > 0 ) {
 				size_t size = tempMallocSize->at((const void *)tempPtr);
-				memPool->insert(std::pair<size_t, void *>(size, tempPtr));
-            	current_mempool_size += size;
+				current_mempool_size += memPool->release(tempPtr, size);
 				tempMallocSize->erase((const void *)tempPtr);
 			} else 
 #endif
@@ -1548,6 +1558,7 @@ void IrisDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
     devType == acc_device_altera || devType == acc_device_altera_emulator ||
     devType == acc_device_current) {
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
+        size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
         memPool_t *memPool = NULL;
 		if( openarcrt_iris_dmem == 1 ) {
@@ -1555,16 +1566,15 @@ void IrisDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
 		} else {
         	memPool = memPoolMap[tconf->threadID];
 		}
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= count;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
       		//HI_set_device_address(hostPtr, *tempPtr, count, asyncID, tconf->threadID);
         } else 
@@ -1579,26 +1589,10 @@ void IrisDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      					if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
-                }
-				memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
 #endif
-			err = iris_mem_create(count, (iris_mem*) &memHandle);
+			err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
 #if VICTIM_CACHE_MODE > 0
 			if (err != IRIS_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
@@ -1606,35 +1600,23 @@ void IrisDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t dev
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      					if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
+                while( (err != IRIS_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
                 }
-				memPool->clear();
-      			err = iris_mem_create(count, (iris_mem*) &memHandle);
       			if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 			}
 #endif
-			*tempPtr = malloc(count);
-			HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+			*tempPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+			memPool->addChunk(*tempPtr, allocSize, count);
+#endif
+			HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 			//New temporary device memory is allocated.
             (*tempMallocSize)[(const void *)*tempPtr] = count;
 #ifdef _OPENARC_PROFILE_
         	tconf->IDMallocCnt++;
-        	tconf->IDMallocSize += count;
-        	tconf->CIDMemorySize += count;
+        	tconf->IDMallocSize += allocSize;
+        	tconf->CIDMemorySize += allocSize;
         	if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
             	tconf->MIDMemorySize = tconf->CIDMemorySize;
         	}   
@@ -1689,6 +1671,7 @@ void IrisDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
     devType == acc_device_altera || devType == acc_device_altera_emulator ||
     devType == acc_device_current) {
         sizemap_t *tempMallocSize = tempMallocSizeMap[tconf->threadID];
+        size_t allocSize = count;
 #if VICTIM_CACHE_MODE > 0
         memPool_t *memPool = NULL;
 		if( openarcrt_iris_dmem == 1 ) {
@@ -1696,16 +1679,15 @@ void IrisDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
 		} else {
         	memPool = memPoolMap[tconf->threadID];
 		}
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if (it != memPool->end()) {
+        size_t blockSize = 0;
+        allocSize = memPool->getAllocSize(count);
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D_async(%lu) reuses memories in the memPool\n", count);
             }
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
-            current_mempool_size -= it->first;
+            current_mempool_size -= blockSize;
             (*tempMallocSize)[(const void *)*tempPtr] = count;
       		//HI_set_device_address(hostPtr, *tempPtr, count, asyncID, tconf->threadID);
         } else 
@@ -1720,26 +1702,10 @@ void IrisDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      					if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
-                }
-				memPool->clear();
+                evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
 			}
 #endif
-			err = iris_mem_create(count, (iris_mem*) &memHandle);
+			err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
 #if VICTIM_CACHE_MODE > 0
 			if (err != IRIS_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
@@ -1747,35 +1713,23 @@ void IrisDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_device
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tIrisDriver::HI_tempMalloc1D_async(%lu) releases memories in the memPool\n", count);
                 }
 #endif
-    			HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-    				if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-      					err = iris_mem_release((iris_mem) tHandle.memHandle);
-      					if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
-      					HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-      					free(tDevPtr);
-                        current_mempool_size -= it->first;
-#ifdef _OPENARC_PROFILE_
-                    	tconf->IDFreeCnt++;
-                    	tconf->CIDMemorySize -= it->first;
-#endif
-    				}
+                while( (err != IRIS_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	err = iris_mem_create(allocSize, (iris_mem*) &memHandle);
                 }
-				memPool->clear();
-      			err = iris_mem_create(count, (iris_mem*) &memHandle);
       			if (err != IRIS_SUCCESS) fprintf(stderr, "[%s:%d][%s] error[%d]\n", __FILE__, __LINE__, __func__, err);
 			}
 #endif
-			*tempPtr = malloc(count);
-			HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+			*tempPtr = malloc(allocSize);
+#if VICTIM_CACHE_MODE > 0
+			memPool->addChunk(*tempPtr, allocSize, count);
+#endif
+			HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 			//New temporary device memory is allocated.
             (*tempMallocSize)[(const void *)*tempPtr] = count;
 #ifdef _OPENARC_PROFILE_
         	tconf->IDMallocCnt++;
-        	tconf->IDMallocSize += count;
-			tconf->CIDMemorySize += count;
+        	tconf->IDMallocSize += allocSize;
+			tconf->CIDMemorySize += allocSize;
 			if( tconf->MIDMemorySize < tconf->CIDMemorySize ) {
 				tconf->MIDMemorySize = tconf->CIDMemorySize;
 			}
@@ -2077,6 +2031,7 @@ HI_error_t IrisDriver::createKernelArgMap(int threadID) {
 
   tconf->kernelArgsMap[this] = kernelArgs;
   tconf->kernelsMap[this]=kernelMap;
+  tconf->resetKernelHandles(this);
   }
 #ifdef _THREAD_SAFETY
   pthread_mutex_unlock(&mutex_clContext);
@@ -2084,13 +2039,14 @@ HI_error_t IrisDriver::createKernelArgMap(int threadID) {
 
 	int thread_id = tconf->threadID;
   if (masterHandleTable.count(thread_id) == 0) {
-    masterAddressTableMap[thread_id] = new addresstable_t();
+    masterAddressTableMap[thread_id] = new presenttable_t();
     masterHandleTable[thread_id] = new memhandlemap_t();
     postponedFreeTableMap[thread_id] = new asyncfreetable_t();
     postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
     postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-    memPoolMap[thread_id] = new memPool_t();
-    tempMemPoolMap[thread_id] = new memPool_t();
+    postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+    memPoolMap[thread_id] = new memPool_t((openarcrt_iris_dmem == 1) ? 0 : HI_mempool_frag_limit, 0, openarcrt_iris_dmem != 1);
+    tempMemPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
     tempMallocSizeMap[thread_id] = new sizemap_t();
   	threadAsyncMap[threadID] = NO_QUEUE;
   	//threadTaskMap[thread_id] = NULL;
@@ -0,0 +1,61 @@
+#ifndef __KERNEL_SOURCE_HEADER__
+#define __KERNEL_SOURCE_HEADER__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+//Load the whole kernel source file into a NULL-terminated buffer allocated
+//by malloc(), and set *size to the number of bytes read (excluding the
+//terminating NULL). There is no limit on the source size; the buffer is
+//sized from the file size, and grown only if the file keeps growing while
+//being read. Return NULL if the file cannot be opened or read.
+static inline char * HI_load_kernel_source(const char *filename, size_t *size) {
+	FILE *fp = fopen(filename, "rb");
+	if( fp == NULL ) {
+		return NULL;
+	}
+	struct stat st;
+	size_t capacity = 0;
+	if( (fstat(fileno(fp), &st) == 0) && (st.st_size > 0) ) {
+		capacity = (size_t)st.st_size;
+	}
+	if( capacity == 0 ) {
+		capacity = 4096;
+	}
+	char *source = (char *)malloc(capacity+1);
+	size_t sourceSize = 0;
+	while( source != NULL ) {
+		sourceSize += fread(source+sourceSize, 1, capacity-sourceSize, fp);
+		if( sourceSize < capacity ) {
+			break;
+		}
+		//The buffer is full; check whether more data remain.
+		int c = fgetc(fp);
+		if( c == EOF ) {
+			break;
+		}
+		capacity *= 2;
+		char *tSource = (char *)realloc(source, capacity+1);
+		if( tSource == NULL ) {
+			free(source);
+		}
+		source = tSource;
+		if( source != NULL ) {
+			source[sourceSize++] = (char)c;
+		}
+	}
+	if( (source != NULL) && ferror(fp) ) {
+		free(source);
+		source = NULL;
+	}
+	fclose(fp);
+	if( source == NULL ) {
+		return NULL;
+	}
+	source[sourceSize] = '\0';
+	*size = sourceSize;
+	return source;
+}
+
+#endif
@@ -6,11 +6,65 @@
 
 static const char *openarcrt_verbosity_env = "OPENARCRT_VERBOSITY";
 
+#ifdef _THREAD_SAFETY
+//Thread registry for the pthread-based build, which assigns each host 
+//thread a compact thread ID (the smallest unused one) at its first runtime
+//call; the ID is released when the thread exits, and it can be reused by a 
+//later thread, just as OpenMP thread numbers are reused across parallel 
+//regions. Before the ID is released, the runtime state of the exiting 
+//thread is retired by HI_retire_hostthread(), so that a later thread with 
+//the same ID does not inherit its data mappings or pending async work.
+//The registry is used before HI_hostinit(), and thus it uses statically 
+//initialized mutex.
+static pthread_mutex_t mutex_thread_registry = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t thread_registry_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_registry_key;
+static std::set<int> freeThreadIDs;
+static int numThreadIDs = 0;
+static __thread int registeredThreadID = NO_THREAD_ID;
+
+//Called at thread exit with the thread ID + 1 stored in the TLS key.
+static void release_thread_id(void *value) {
+    int thread_id = (int)((size_t)value - 1);
+    HI_retire_hostthread(thread_id);
+    pthread_mutex_lock(&mutex_thread_registry);
+    freeThreadIDs.insert(thread_id);
+    pthread_mutex_unlock(&mutex_thread_registry);
+}
+
+static void create_thread_registry_key() {
+    pthread_key_create(&thread_registry_key, release_thread_id);
+}
+
+static int register_thread_id() {
+    int thread_id;
+    pthread_once(&thread_registry_once, create_thread_registry_key);
+    pthread_mutex_lock(&mutex_thread_registry);
+    if( freeThreadIDs.empty() ) {
+        thread_id = numThreadIDs++;
+    } else {
+        thread_id = *(freeThreadIDs.begin());
+        freeThreadIDs.erase(freeThreadIDs.begin());
+    }
+    pthread_mutex_unlock(&mutex_thread_registry);
+    pthread_setspecific(thread_registry_key, (void *)((size_t)thread_id + 1));
+    registeredThreadID = thread_id;
+    return thread_id;
+}
+#endif
+
 int get_thread_id() {
 #ifdef _OPENMP
     int thread_id = omp_get_thread_num();
+#else
+#ifdef _THREAD_SAFETY
+    int thread_id = registeredThreadID;
+    if( thread_id == NO_THREAD_ID ) {
+        thread_id = register_thread_id();
+    }
 #else
     int thread_id = 0;
+#endif
 #endif
     return thread_id;
 }
@@ -8,16 +8,16 @@
 #include "resilience.cpp"
 
 #ifdef _THREAD_SAFETY
-pthread_mutex_t mutex_HI_init;
-pthread_mutex_t mutex_HI_hostinit;
-pthread_mutex_t mutex_HI_kernelnames;
-pthread_mutex_t mutex_pin_host_memory;
-pthread_mutex_t mutex_victim_cache;
-pthread_mutex_t mutex_tempMalloc;
-pthread_mutex_t mutex_set_async;
-pthread_mutex_t mutex_set_device_num;
-pthread_mutex_t mutex_clContext;
-pthread_mutex_t mutex_presentTable;
+pthread_mutex_t mutex_HI_init = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_HI_hostinit = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_HI_kernelnames = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_pin_host_memory = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_tempMalloc = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_set_async = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_set_device_num = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_clContext = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_memHandleTable = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t HI_hostinit_once_control = PTHREAD_ONCE_INIT;
 #endif
 
 static const char *omp_num_threads_env = "OMP_NUM_THREADS";
@@ -30,6 +30,7 @@ static const char *openarcrt_max_mempool_size_env = "OPENARCRT_MAXMEMPOOLSIZE";
 static const char *openarcrt_unifiedmemory_env = "OPENARCRT_UNIFIEDMEM";
 static const char *openarcrt_prepinhostmemory_env = "OPENARCRT_PREPINHOSTMEM";
 static const char *openarcrt_memoryalignment_env = "OPENARCRT_MEMORYALIGNMENT";
+static const char *openarcrt_mempool_frag_limit_env = "OPENARCRT_MEMPOOLFRAGLIMIT";
 static const char *NVIDIA = "NVIDIA";
 static const char *RADEON = "RADEON";
 static const char *XEONPHI = "XEONPHI";
@@ -41,11 +42,14 @@ static const char *INTELGPU = "INTELGPU";
 devmap_t HostConf::devMap;
 //HI_kernelnames contain all the kernels used by any host thread, which does not distinguish target device types.
 std::set<std::string> HostConf::HI_kernelnames;
+std::map<std::string, int> HostConf::HI_kernelIDMap;
+std::vector<const char *> HostConf::HI_kernelIDNames;
 
 int HI_hostinit_done = 0;
 int HI_openarcrt_verbosity = 0;
 int HI_openarcrt_memoryalignment = 1;
 long HI_max_mempool_size = 0;
+int HI_mempool_frag_limit = MEMPOOL_DEFAULT_FRAG_LIMIT;
 int HI_use_unifiedmemory = 0;
 int HI_prepin_host_memory = 1;
 int HI_num_hostthreads = 1;
@@ -67,6 +71,47 @@ std::map<int, HostConf_t *> hostConfMap;
 ////////////////////////
 // Runtime init/reset //
 ////////////////////////
+//Process-wide part of HI_hostinit(), which is executed only once.
+//The global mutexes are statically initialized, so they are never 
+//re-initialized here while other host threads may hold them.
+static void HI_hostinit_once() {
+    char * envVar;
+    envVar = getenv(openarcrt_max_mempool_size_env);
+	if( envVar != NULL ) {
+		HI_max_mempool_size = strtol(envVar, NULL, 10);
+	} else {
+		HI_max_mempool_size = 0;
+	}
+    envVar = getenv(openarcrt_mempool_frag_limit_env);
+	if( envVar != NULL ) {
+		HI_mempool_frag_limit = atoi(envVar);
+		if( HI_mempool_frag_limit < 0 ) {
+			HI_mempool_frag_limit = 0;
+		}
+	}
+    envVar = getenv(openarcrt_unifiedmemory_env);
+	if( envVar != NULL ) {
+		HI_use_unifiedmemory = atoi(envVar);
+	} else {
+		HI_use_unifiedmemory = 0;
+	}
+    envVar = getenv(openarcrt_prepinhostmemory_env);
+	if( envVar != NULL ) {
+		HI_prepin_host_memory = atoi(envVar);
+	} else {
+		//Default behavior is changed to no-prepinning.
+		HI_prepin_host_memory = 0;
+	}
+	//[DEBUG on Feb. 5, 2021] explicitly reset the devMap not to have any garbage data.
+	HostConf::devMap.clear();
+    __atomic_store_n(&HI_hostinit_done, 1, __ATOMIC_RELEASE);
+	if( HI_prepin_host_memory == 1 ) {
+#ifdef _OPENARC_PROFILE_
+		fprintf(stderr, "[OPENARCRT-INFO] Host memory will be prepinned for fast memory transfers; to disable this, set environment variable %s to 0 (excessive prepinning may slow or crash the program.)\n", openarcrt_prepinhostmemory_env);
+#endif
+	}
+}
+
 //[FIXME] if default device type is different from the one passed to acc_init(),
 //the default device type should be updated to the passed value.
 //==> tconf->acc_device_type_var is updated in acc_init().
@@ -90,46 +135,18 @@ void HI_hostinit(int threadID) {
 		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_hostinit(thread ID = %d)\n", threadID);
 	}
 #endif
-    if( HI_hostinit_done == 0 ) {
 #ifdef _THREAD_SAFETY
-		pthread_mutex_init(&mutex_HI_init, NULL);
-		pthread_mutex_init(&mutex_HI_hostinit, NULL);
-		pthread_mutex_init(&mutex_HI_kernelnames, NULL);
-		pthread_mutex_init(&mutex_pin_host_memory, NULL);
-		pthread_mutex_init(&mutex_victim_cache, NULL);
-		pthread_mutex_init(&mutex_tempMalloc, NULL);
-		pthread_mutex_init(&mutex_set_async, NULL);
-		pthread_mutex_init(&mutex_set_device_num, NULL);
-		pthread_mutex_init(&mutex_clContext, NULL);
-#endif
-    	envVar = getenv(openarcrt_max_mempool_size_env);
-		if( envVar != NULL ) {
-			HI_max_mempool_size = strtol(envVar, NULL, 10);
-		} else {
-			HI_max_mempool_size = 0;
-		}
-    	envVar = getenv(openarcrt_unifiedmemory_env);
-		if( envVar != NULL ) {
-			HI_use_unifiedmemory = atoi(envVar);
-		} else {
-			HI_use_unifiedmemory = 0;
-		}
-    	envVar = getenv(openarcrt_prepinhostmemory_env);
-		if( envVar != NULL ) {
-			HI_prepin_host_memory = atoi(envVar);
-		} else {
-			//Default behavior is changed to no-prepinning.
-			HI_prepin_host_memory = 0;
-		}
-		//[DEBUG on Feb. 5, 2021] explicitly reset the devMap not to have any garbage data.
-		HostConf::devMap.clear();
-    	HI_hostinit_done = 1;
-		if( HI_prepin_host_memory == 1 ) {
-#ifdef _OPENARC_PROFILE_
-			fprintf(stderr, "[OPENARCRT-INFO] Host memory will be prepinned for fast memory transfers; to disable this, set environment variable %s to 0 (excessive prepinning may slow or crash the program.)\n", openarcrt_prepinhostmemory_env);
+	pthread_once(&HI_hostinit_once_control, HI_hostinit_once);
+#else
+#ifdef _OPENMP
+	#pragma omp critical (HI_hostinit_once_critical)
 #endif
+	{
+		if( HI_hostinit_done == 0 ) {
+			HI_hostinit_once();
 		}
 	}
+#endif
     if( hostConfMap.count(threadID) == 0 ) {
 		HostConf_t * tconf = new HostConf_t;
 		tconf->threadID=threadID;
@@ -166,6 +183,106 @@ void HI_hostinit(int threadID) {
 #endif
 }
 
+//Retire the per-thread state of an exiting host thread, so that a later 
+//host thread reusing the same thread ID does not inherit its data mappings 
+//or pending async work. The device resources bound to the thread ID (queues,
+//kernels, and the device memory pool) are kept and reused.
+//This function is called by the pthread-based thread registry.
+void HI_retire_hostthread(int threadID) {
+    HostConf_t * tconf = NULL;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_HI_hostinit);
+#else
+#ifdef _OPENMP
+	#pragma omp critical (HI_hostinit_critical)
+#endif
+#endif
+	{
+		std::map<int, HostConf_t *>::iterator it = hostConfMap.find(threadID);
+		if( it != hostConfMap.end() ) {
+			tconf = it->second;
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_HI_hostinit);
+#endif
+	if( tconf == NULL ) {
+		return;
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_retire_hostthread(thread ID = %d)\n", threadID);
+	}
+#endif
+	Accelerator_t *device = tconf->device;
+	if( (device != NULL) && (device->init_done == 1) ) {
+		//Pending async operations also release their postponed frees.
+		device->HI_wait_all(threadID);
+#ifndef _USE_SHARED_PRESENT_TABLE
+		//Device memory still mapped by the thread goes back to the memory pool.
+		addresstablemap_t::iterator it = device->masterAddressTableMap.find(threadID);
+		if( it != device->masterAddressTableMap.end() ) {
+			std::vector<presenttable_key_t> keys;
+			(it->second)->getKeys(keys);
+			for( size_t i = 0; i < keys.size(); i++ ) {
+				device->HI_free(keys[i].ptr, keys[i].asyncID, threadID);
+			}
+			(it->second)->clear();
+		}
+#endif
+	}
+	tconf->isOnAccDevice = 0;
+	tconf->hostmemstatusmaptable->clear();
+	tconf->devicememstatusmaptable->clear();
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_retire_hostthread(thread ID = %d)\n", threadID);
+	}
+#endif
+}
+
+//Host configuration last looked up by the calling host thread, which lets
+//the get*HostConf() functions skip the hostConfMap search on every runtime 
+//call. Host configurations are never deleted once created (HI_reset() and 
+//acc_shutdown() reset them in place), so the cached pointer stays valid.
+static __thread int cachedHostConfThreadID = NO_THREAD_ID;
+static __thread HostConf_t * cachedHostConf = NULL;
+
+//Find the host configuration for threadID, creating it if not existing.
+//The hostConfMap search is synchronized with the insertion in HI_hostinit().
+static HostConf_t * lookupHostConf(int threadID) {
+    HostConf_t * tconf = NULL;
+    if( (threadID == cachedHostConfThreadID) && (cachedHostConf != NULL) ) {
+        return cachedHostConf;
+    }
+    for( int i = 0; (i < 2) && (tconf == NULL); i++ ) {
+        if( i == 1 ) {
+            HI_hostinit(threadID);
+        }
+#ifdef _THREAD_SAFETY
+        pthread_mutex_lock(&mutex_HI_hostinit);
+#else
+#ifdef _OPENMP
+        #pragma omp critical (HI_hostinit_critical)
+#endif
+#endif
+        {
+            std::map<int, HostConf_t *>::iterator it = hostConfMap.find(threadID);
+            if( it != hostConfMap.end() ) {
+                tconf = it->second;
+            }
+        }
+#ifdef _THREAD_SAFETY
+        pthread_mutex_unlock(&mutex_HI_hostinit);
+#endif
+    }
+    if( tconf != NULL ) {
+        cachedHostConfThreadID = threadID;
+        cachedHostConf = tconf;
+    }
+    return tconf;
+}
+
 //Get the initial host configuration, or create it if nox existing.
 //This function is called only in acc_init() function.
 HostConf_t * getInitHostConf(int threadID) {
@@ -178,17 +295,10 @@ HostConf_t * getInitHostConf(int threadID) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tHost thread %d enters getInitHostConf()\n", threadID);
 	}
 #endif
-    if( hostConfMap.count(threadID) > 0 ) {
-        tconf = hostConfMap.at(threadID);
-    }
-
+    tconf = lookupHostConf(threadID);
     if( tconf == NULL ) {
-        HI_hostinit(threadID);
-        tconf = hostConfMap.at(threadID);
-        if( tconf == NULL ) {
-            fprintf(stderr, "[ERROR in getInitHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
-            exit(1);
-        }
+        fprintf(stderr, "[ERROR in getInitHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
+        exit(1);
     }
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -210,17 +320,10 @@ HostConf_t * getHostConf(int threadID) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tHost thread %d enters getHostConf()\n", threadID);
 	}
 #endif
-    if( hostConfMap.count(threadID) > 0 ) {
-        tconf = hostConfMap.at(threadID);
-    }
-
+    tconf = lookupHostConf(threadID);
     if( tconf == NULL ) {
-        HI_hostinit(threadID);
-        tconf = hostConfMap.at(threadID);
-        if( tconf == NULL ) {
-            fprintf(stderr, "[ERROR in getHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
-            exit(1);
-        }
+        fprintf(stderr, "[ERROR in getHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
+        exit(1);
     }
 	if( tconf->HI_init_done == 0 ) {
 		tconf->HI_init_done = 1; //This should execute first.
@@ -246,17 +349,10 @@ HostConf_t * setNGetHostConf(int devNum, int threadID) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tHost thread %d enters setNGetHostConf(devNum = %d)\n", threadID, devNum);
 	}
 #endif
-    if( hostConfMap.count(threadID) > 0 ) {
-        tconf = hostConfMap.at(threadID);
-    }
-
+    tconf = lookupHostConf(threadID);
     if( tconf == NULL ) {
-        HI_hostinit(threadID);
-        tconf = hostConfMap.at(threadID);
-        if( tconf == NULL ) {
-            fprintf(stderr, "[ERROR in setNGetHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
-            exit(1);
-        }
+        fprintf(stderr, "[ERROR in setNGetHostConf] No host configuration exists for the current host thread (thread ID: %d);\n", threadID);
+        exit(1);
     }
 	if( tconf->HI_init_done == 0 ) {
 		tconf->HI_init_done = 1; //This should execute first.
@@ -417,7 +513,6 @@ void HostConf::setTranslationType()
 }
 
 void HostConf::createHostTables() {
-    prtcntmaptable = new countermap_t;
     hostmemstatusmaptable = new memstatusmap_t;
     devicememstatusmaptable = new memstatusmap_t;
 }
@@ -465,6 +560,11 @@ void HostConf::HI_init(int devNum) {
 	IPresentTableCnt = 0;
 	WaitCnt = 0;
 	RegKernelArgCnt = 0;
+	KernelArgSetCnt = 0;
+	KernelArgSkipCnt = 0;
+	AsyncQueueCnt = 0;
+	LogicalAsyncQueueCnt = 0;
+	AsyncQueueContentionCnt = 0;
 	BTaskCnt = 0;
     H2DMemTrSize = 0;
     H2HMemTrSize = 0;
@@ -679,23 +779,73 @@ void HostConf::HI_reset() {
     delete asyncfreemaptable;
     */
     //createHostTables();
-    //delete prtcntmaptable;
     //delete hostmemstatusmaptable;
     //delete devicememstatusmaptable;
 
 	//device->masterAddressTable.clear();
 	for( addresstablemap_t::iterator it = device->masterAddressTableMap.begin(); it != device->masterAddressTableMap.end(); it++) {
-		addresstable_t * tmap = it->second;
-		for( addresstable_t::iterator it2 = tmap->begin(); it2 != tmap->end(); it2++) {
-		(it2->second)->clear();
-	}
-		tmap->clear();
+		(it->second)->clear();
 	} 
+#ifdef _USE_SHARED_PRESENT_TABLE
+	device->sharedPresentTable.clear();
+#endif
 	for( memhandletable_t::iterator it = device->masterHandleTable.begin(); it != device->masterHandleTable.end(); it++) {
 		(it->second)->clear();
 	} 
+#ifdef _OPENARC_PROFILE_
+	long memPoolHitCnt = 0;
+	long memPoolMissCnt = 0;
+	size_t memPoolPeakBytes = 0;
+	size_t memPoolInternalFragBytes = 0;
+	size_t memPoolExternalFragBytes = 0;
+	long memPoolEvictCnt = 0;
+	size_t memPoolEvictBytes = 0;
+	if( device->memPoolMap.count(threadID) > 0 ) {
+		memPool_t *memPool = device->memPoolMap[threadID];
+		memPoolHitCnt = memPool->hitCnt;
+		memPoolMissCnt = memPool->missCnt;
+		memPoolPeakBytes = memPool->peakReservedBytes;
+		memPoolInternalFragBytes = memPool->getInternalFragBytes();
+		memPoolExternalFragBytes = memPool->getExternalFragBytes();
+		memPoolEvictCnt = memPool->evictCnt;
+		memPoolEvictBytes = memPool->evictBytes;
+	}
+	size_t postponedFreePeakBytes = 0;
+	if( device->postponedFreeInfoMap.count(threadID) > 0 ) {
+		postponedfreeinfo_t *freeInfo = device->postponedFreeInfoMap[threadID];
+		postponedFreePeakBytes = freeInfo->peakSize;
+		freeInfo->peakSize = 0;
+	}
+#endif
+#if VICTIM_CACHE_MODE == 2
+#ifdef _OPENARC_PROFILE_
+	victimcacheshard_t *victimCache = device->HI_get_victim_cache_shard(threadID);
+	long victimCacheHitCnt = victimCache->hitCnt;
+	long victimCacheSizeHitCnt = victimCache->sizeHitCnt;
+	long victimCacheMissCnt = victimCache->missCnt;
+	long victimCacheEvictCnt = victimCache->evictCnt;
+	size_t victimCacheEvictBytes = victimCache->evictBytes;
+	victimCache->resetStats();
+#endif
+	//Release the device memory cached in the calling thread's shard; the 
+	//shards of other threads are left to their owners.
+	victimcache_entry_t victimEntry;
+	while( device->HI_pop_victim_cache_entry(&victimEntry, threadID) == HI_success ) {
+		device->HI_tempFree(victimEntry.devPtr, acc_device_type_var, threadID);
+#ifdef _OPENARC_PROFILE_
+		CIDMemorySize -= victimEntry.size;
+#endif
+	}
+	//The mappings of the buffers taken from the shard were dropped above.
+	device->HI_get_victim_cache_shard(threadID)->clearAllocSizes();
+#endif
 	for( memPoolmap_t::iterator it = device->memPoolMap.begin(); it != device->memPoolMap.end(); it++) {
 		(it->second)->clear();
+#ifdef _OPENARC_PROFILE_
+		if( it->first == threadID ) {
+			(it->second)->resetStats();
+		}
+#endif
 	} 
 #if defined(OPENARC_ARCH) && OPENARC_ARCH == 6
 	for( memPoolmap_t::iterator it = device->tempMemPoolMap.begin(); it != device->tempMemPoolMap.end(); it++) {
@@ -706,6 +856,15 @@ void HostConf::HI_reset() {
 	for( asyncfreetablemap_t::iterator it = device->postponedFreeTableMap.begin(); it != device->postponedFreeTableMap.end(); it++) {
 		(it->second)->clear();
 	} 
+	//Cleared postponed frees must not be reclaimed later; the pending 
+	//reclaim requests of the calling thread are released first.
+	device->HI_reclaim_completed_frees(threadID);
+	for( postponedfreeinfomap_t::iterator it = device->postponedFreeInfoMap.begin(); it != device->postponedFreeInfoMap.end(); it++) {
+		std::map<int, postponedfreecount_t> &countMap = (it->second)->countMap;
+		for( std::map<int, postponedfreecount_t>::iterator it2 = countMap.begin(); it2 != countMap.end(); it2++) {
+			(it2->second).freeRetired = (it2->second).freeInserted;
+		}
+	} 
 	
 	device->destroy(threadID);
 	//device->init_done = 0;
@@ -747,6 +906,24 @@ void HostConf::HI_reset() {
     printf("Number of Internal Pinned Memory Allocation Calls by OpenARC runtime: %ld\n", IPMallocCnt);
     printf("Number of External Device Memory Free Calls by OpenARC runtime: %ld\n", DFreeCnt);
     printf("Number of Internal Device Memory Free Calls by OpenARC runtime: %ld\n", IDFreeCnt);
+    printf("Number of Device Memory Pool Hits: %ld\n", memPoolHitCnt);
+    printf("Number of Device Memory Pool Misses: %ld\n", memPoolMissCnt);
+	if( memPoolHitCnt + memPoolMissCnt > 0 ) {
+    	printf("Device Memory Pool Hit Rate: %.2lf%%\n", 100.0 * memPoolHitCnt / (memPoolHitCnt + memPoolMissCnt));
+	}
+    printf("Peak Device Memory Reserved by Memory Pool: %lu bytes\n", memPoolPeakBytes);
+    printf("Number of Device Memory Pool Evictions: %ld\n", memPoolEvictCnt);
+    printf("Device Memory Evicted from Memory Pool: %lu bytes\n", memPoolEvictBytes);
+    printf("Peak Device Memory Waiting in Postponed Frees: %lu bytes\n", postponedFreePeakBytes);
+    printf("Internal Fragmentation of Memory Pool at Shutdown: %lu bytes\n", memPoolInternalFragBytes);
+    printf("External Fragmentation of Memory Pool at Shutdown: %lu bytes\n", memPoolExternalFragBytes);
+#if VICTIM_CACHE_MODE == 2
+    printf("Number of Victim Cache Hits for the Same Host Memory: %ld\n", victimCacheHitCnt);
+    printf("Number of Victim Cache Hits for Other Host Memory of Compatible Size: %ld\n", victimCacheSizeHitCnt);
+    printf("Number of Victim Cache Misses: %ld\n", victimCacheMissCnt);
+    printf("Number of Victim Cache Evictions: %ld\n", victimCacheEvictCnt);
+    printf("Device Memory Evicted from Victim Cache: %lu bytes\n", victimCacheEvictBytes);
+#endif
     printf("Number of External Host Memory Free Calls by OpenARC runtime: %ld\n", HFreeCnt);
     printf("Number of Internal Host Memory Free Calls by OpenARC runtime: %ld\n", IHFreeCnt);
     printf("Number of Internal Pinned Memory Free Calls by OpenARC runtime: %ld\n", IPFreeCnt);
@@ -755,9 +932,37 @@ void HostConf::HI_reset() {
 	if( HI_openarcrt_verbosity > 1 ) {
 		IPresentTableCnt = (device->presentTableCntMap.find(thread_id))->second;
     	printf("Number of Internal Present Table Lookups by OpenARC runtime: %ld\n", IPresentTableCnt);
+#ifdef _USE_SHARED_PRESENT_TABLE
+		sharedpresenttable_t *presentTable = &(device->sharedPresentTable);
+#else
+		presenttable_t *presentTable = NULL;
+		if( device->masterAddressTableMap.count(thread_id) > 0 ) {
+			presentTable = device->masterAddressTableMap[thread_id];
+		}
+#endif
+		if( presentTable != NULL ) {
+			long slabHitCnt, slabAllocCnt;
+			presentTable->getSlabCnt(&slabHitCnt, &slabAllocCnt);
+    		printf("Number of Present Table Allocations Served by Slabs: %ld\n", slabHitCnt);
+    		printf("Number of Fresh Slab Allocations for Present Table: %ld\n", slabAllocCnt);
+			presentTable->resetSlabCnt();
+#ifndef _USE_SHARED_PRESENT_TABLE
+    		printf("Number of Present Lookup Cache Hits: %ld\n", presentTable->lookupCache.cacheHitCnt);
+    		printf("Number of Present Lookup Cache Misses: %ld\n", presentTable->lookupCache.cacheMissCnt);
+			presentTable->lookupCache.cacheHitCnt = 0;
+			presentTable->lookupCache.cacheMissCnt = 0;
+#endif
+		}
 	}
     printf("Number of Wait Calls: %ld\n", WaitCnt);
     printf("Number of Kernel Argument Register Calls: %ld\n", RegKernelArgCnt);
+#if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
+    printf("Number of Issued clSetKernelArg Calls: %ld\n", KernelArgSetCnt);
+    printf("Number of Skipped clSetKernelArg Calls: %ld\n", KernelArgSkipCnt);
+    printf("Number of Async Command Queues Created: %ld\n", AsyncQueueCnt);
+    printf("Number of Logical Async Queues Mapped to Async Queue Pool: %ld\n", LogicalAsyncQueueCnt);
+    printf("Number of Async Queue Pool Mappings to Shared Queues: %ld\n", AsyncQueueContentionCnt);
+#endif
 #if defined(OPENARCRT_USE_BRISBANE) && OPENARCRT_USE_BRISBANE == 1
     printf("Number of Brisbane Task Submissions: %ld\n", BTaskCnt);
 #else
@@ -885,17 +1090,58 @@ void HostConf::HI_reset() {
 //////////////////////
 // Kernel Execution //
 //////////////////////
+//Return the name of the kernel whose ID is kernel_id, or NULL if there is none.
+static const char * HI_get_kernel_name(int kernel_id) {
+	const char *kernelName = NULL;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_HI_kernelnames);
+#else
+#ifdef _OPENMP
+	#pragma omp critical (HI_kernelnames_critical)
+#endif
+#endif
+	{
+		if( (kernel_id >= 0) && (kernel_id < (int)HostConf::HI_kernelIDNames.size()) ) {
+			kernelName = HostConf::HI_kernelIDNames[kernel_id];
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_HI_kernelnames);
+#endif
+	return kernelName;
+}
+
+int HI_get_kernel_id(std::string kernel_name, int threadID) {
+    HostConf_t* tconf = getHostConf(threadID);
+	return tconf->getKernelID(kernel_name);
+}
+
+int HI_get_kernel_id(const char *kernel_name, int threadID) {
+    HostConf_t* tconf = getHostConf(threadID);
+	return tconf->getKernelID(kernel_name);
+}
+
 HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID)
+{
+	return HI_register_kernel_numargs(HI_get_kernel_id(kernel_name, threadID), num_args, threadID);
+}
+
+HI_error_t HI_register_kernel_numargs(const char *kernel_name, int num_args, int threadID)
+{
+	return HI_register_kernel_numargs(HI_get_kernel_id(kernel_name, threadID), num_args, threadID);
+}
+
+HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID)
 {
 	HI_error_t return_status;
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_register_kernel_numargs(%s, thread ID = %d)\n", kernel_name.c_str(), threadID);
+		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_register_kernel_numargs(%s, thread ID = %d)\n", HI_get_kernel_name(kernel_id), threadID);
 	}
 	double ltime = HI_get_localtime();
 #endif
     HostConf_t* tconf = getHostConf(threadID);
-    return_status = tconf->device->HI_register_kernel_numargs(kernel_name, num_args, tconf->threadID);
+    return_status = tconf->device->HI_register_kernel_numargs(kernel_id, num_args, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_register_kernel_numargs(thread ID = %d)\n", threadID);
@@ -907,6 +1153,16 @@ HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int
 }
 
 HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
+{
+	return HI_register_kernel_arg(HI_get_kernel_id(kernel_name, threadID), arg_index, arg_size, arg_value, arg_type, arg_trait, unitSize, threadID);
+}
+
+HI_error_t HI_register_kernel_arg(const char *kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
+{
+	return HI_register_kernel_arg(HI_get_kernel_id(kernel_name, threadID), arg_index, arg_size, arg_value, arg_type, arg_trait, unitSize, threadID);
+}
+
+HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
 {
 	HI_error_t return_status;
 #ifdef _OPENARC_PROFILE_
@@ -916,7 +1172,7 @@ HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t
 	double ltime = HI_get_localtime();
 #endif
     HostConf_t* tconf = getHostConf(threadID);
-    return_status = tconf->device->HI_register_kernel_arg(kernel_name, arg_index, arg_size, arg_value, arg_type, arg_trait, unitSize, tconf->threadID);
+    return_status = tconf->device->HI_register_kernel_arg(kernel_id, arg_index, arg_size, arg_value, arg_type, arg_trait, unitSize, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_register_kernel_arg(arg_index = %d, arg_value = %lx, thread ID = %d)\n", arg_index, *(unsigned long *)arg_value, threadID);
@@ -928,9 +1184,17 @@ HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t
 }
 
 HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
+	return HI_kernel_call(HI_get_kernel_id(kernel_name, threadID), gridSize, blockSize, async, num_waits, waits, threadID);
+}
+
+HI_error_t HI_kernel_call(const char *kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
+	return HI_kernel_call(HI_get_kernel_id(kernel_name, threadID), gridSize, blockSize, async, num_waits, waits, threadID);
+}
+
+HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID) {
 	HI_error_t return_status;
-	const char *kernelName = kernel_name.c_str();
 #ifdef _OPENARC_PROFILE_
+	const char *kernelName = HI_get_kernel_name(kernel_id);
 	if( HI_openarcrt_verbosity > 0 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_kernel_call(async = %d): %s, thread ID = %d\n", async, kernelName, threadID);
 		fprintf(stderr, "                \t\tGang configuration: %lu, %lu, %lu\n", gridSize[2], gridSize[1], gridSize[0]);
@@ -940,7 +1204,7 @@ HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t bl
 	//if( (gridSize[0] == 0) && (gridSize[1] == 0) && (gridSize[2] == 0) ) {
 	if( gridSize[0] == 0 ) {
     	//fprintf(stderr, "[WARNING in HI_kernel_call()] the kernel, %s, is called with 0 gangs; skip executing this kernel.\n", kernel_name);
-    	std::cerr << "[WARNING in HI_kernel_call()] the kernel, " << kernel_name << " is called with 0 gangs; skip executing this kernel." << std::endl;
+    	std::cerr << "[WARNING in HI_kernel_call()] the kernel, " << HI_get_kernel_name(kernel_id) << " is called with 0 gangs; skip executing this kernel." << std::endl;
         return HI_success;
 	}
     HostConf_t* tconf = getHostConf(threadID);
@@ -955,7 +1219,10 @@ HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t bl
         fprintf(stderr, "[ERROR in HI_kernel_call()] Not supported in the current device type %d; exit!\n", tconf->acc_device_type_var);
 		exit(1);
 	}
-    return_status = tconf->device->HI_kernel_call(kernel_name, gridSize, blockSize, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+    return_status = tconf->device->HI_kernel_call(kernel_id, gridSize, blockSize, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+	if( waitslist != NULL ) {
+		free(waitslist);
+	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 0 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_kernel_call(async = %d): %s, thread ID = %d\n", async, kernelName, threadID);
@@ -1573,6 +1840,9 @@ HI_error_t HI_memcpy_async(void *dst, const void *src, size_t count,
 			exit(1);
 		}
     	return_status = tconf->device->HI_memcpy_async(dst, src, count, kind, trType, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+		if( waitslist != NULL ) {
+			free(waitslist);
+		}
 	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
@@ -1614,6 +1884,9 @@ HI_error_t HI_memcpy_asyncS(void *dst, const void *src, size_t count,
 			exit(1);
 		}
     	return_status = tconf->device->HI_memcpy_asyncS(dst, src, count, kind, trType, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+		if( waitslist != NULL ) {
+			free(waitslist);
+		}
 	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
@@ -1741,6 +2014,9 @@ HI_error_t HI_memcpy2D_async(void *dst, size_t dpitch, const void *src,
 			exit(1);
 		}
     	return_status = tconf->device->HI_memcpy2D_async(dst, dpitch, src, spitch, widthInBytes, height, kind, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+		if( waitslist != NULL ) {
+			free(waitslist);
+		}
 	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
@@ -1751,11 +2027,91 @@ HI_error_t HI_memcpy2D_async(void *dst, size_t dpitch, const void *src,
 	return return_status;
 }
 
-//extern HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch,
-//	size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind);
-//extern HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src,
-//	size_t spitch, size_t widthInBytes, size_t height, size_t depth,
-//	HI_MemcpyKind_t kind, int async);
+HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch,
+                             size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID) {
+	HI_error_t return_status = HI_success;
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_memcpy3D(size = %ld, thread ID = %d)\n", widthInBytes*height*depth, threadID);
+		fprintf(stderr, "                \tdst = %lx\tsrc = %lx\n", (unsigned long)dst, (unsigned long)src);
+		fprintf(stderr, "                \tMemcpy Type: %s\n", HI_getMemcpyTypeString(kind));
+	}
+#endif
+	if( dst == NULL ) {
+    	fprintf(stderr, "[ERROR in HI_memcpy3D()] NULL dst pointer; exit!\n");
+        exit(1);
+	} else if( src == NULL ) {
+    	fprintf(stderr, "[ERROR in HI_memcpy3D()] NULL src pointer; exit!\n");
+        exit(1);
+	}
+	if( widthInBytes*height*depth > 0 ) {
+    	HostConf_t * tconf = getHostConf(threadID);
+    	if( tconf->isOnAccDevice == 0 ) {
+        	fprintf(stderr, "[ERROR in HI_memcpy3D()] Not supported operation for the current device type %d; exit!\n", tconf->acc_device_type_var);
+        	exit(1);
+    	}    
+		if(tconf->device == NULL) {
+        	fprintf(stderr, "[ERROR in HI_memcpy3D()] Not supported in the current device type %d; exit!\n", tconf->acc_device_type_var);
+			exit(1);
+		}
+    	return_status = tconf->device->HI_memcpy3D(dst, dpitch, src, spitch, widthInBytes, height, depth, kind, tconf->threadID);
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_memcpy3D(size = %ld, thread ID = %d)\n", widthInBytes*height*depth, threadID);
+		fprintf(stderr, "                \tMemcpy Type: %s\n", HI_getMemcpyTypeString(kind));
+	}
+#endif
+	return return_status;
+}
+
+HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src,
+                                   size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int async, int num_waits, int *waits, int threadID) {
+	HI_error_t return_status = HI_success;
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_memcpy3D_async(size = %ld, async = %d, thread ID = %d)\n", widthInBytes*height*depth, async, threadID);
+		fprintf(stderr, "                \tdst = %lx\tsrc = %lx\n", (unsigned long)dst, (unsigned long)src);
+		fprintf(stderr, "                \tMemcpy Type: %s\n", HI_getMemcpyTypeString(kind));
+	}
+#endif
+	if( dst == NULL ) {
+    	fprintf(stderr, "[ERROR in HI_memcpy3D_async()] NULL dst pointer; exit!\n");
+        exit(1);
+	} else if( src == NULL ) {
+    	fprintf(stderr, "[ERROR in HI_memcpy3D_async()] NULL src pointer; exit!\n");
+        exit(1);
+	}
+	if( widthInBytes*height*depth > 0 ) {
+    	HostConf_t * tconf = getHostConf(threadID);
+    	if( tconf->isOnAccDevice == 0 ) {
+        	fprintf(stderr, "[ERROR in HI_memcpy3D_async()] Not supported operation for the current device type %d; exit!\n", tconf->acc_device_type_var);
+        	exit(1);
+    	}    
+		int *waitslist = NULL;
+		if( num_waits > 0 ) {
+			waitslist = (int *)malloc(num_waits*sizeof(int));
+			for( int i=0; i<num_waits; i++ ) {
+				waitslist[i] = waits[i]+tconf->asyncID_offset;
+			}
+		}
+		if(tconf->device == NULL) {
+        	fprintf(stderr, "[ERROR in HI_memcpy3D_async()] Not supported in the current device type %d; exit!\n", tconf->acc_device_type_var);
+			exit(1);
+		}
+    	return_status = tconf->device->HI_memcpy3D_async(dst, dpitch, src, spitch, widthInBytes, height, depth, kind, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+		if( waitslist != NULL ) {
+			free(waitslist);
+		}
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 1 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\texit HI_memcpy3D_async(size = %ld, async = %d, thread ID = %d)\n", widthInBytes*height*depth, async, threadID);
+		fprintf(stderr, "                \tMemcpy Type: %s\n", HI_getMemcpyTypeString(kind));
+	}
+#endif
+	return return_status;
+}
 
 ////////////////////////////
 //Internal mapping tables //
@@ -1951,38 +2307,16 @@ int HI_getninc_prtcounter(const void * hostPtr, void **devPtr, int asyncID, int
     HostConf_t * tconf = getHostConf(threadID);
 
     int result;
-    acc_device_t devType = tconf->acc_device_type_var;
-    int devNum = acc_get_device_num(devType, tconf->threadID);
-    countermap_t * prtcounter = tconf->prtcntmaptable;
-	void * hostPtrBase = (void *)hostPtr;
-	void *devPtrBase;
-	size_t offset;
 	if(tconf->device == NULL) {
         fprintf(stderr, "[ERROR in HI_getninc_prtcounter()] Not supported in the current device type %d; exit!\n", tconf->acc_device_type_var);
 		exit(1);
 	}
-    if( tconf->device->HI_get_device_address(hostPtr, &devPtrBase, &offset, asyncID+tconf->asyncID_offset, tconf->threadID) == HI_success ) {
-		if( offset > 0 ) {
-			hostPtrBase = (void *)((size_t)hostPtrBase - offset);
-			*devPtr = (void *) ((size_t)devPtrBase + offset);
-		} else {
-			*devPtr = devPtrBase;
-		}
-        if( prtcounter->count(hostPtrBase) > 0 ) {
-            result = prtcounter->at(hostPtrBase);
-            if( result <= 0 ) result = 1;
-            (*prtcounter)[hostPtrBase] = result + 1;
-        } else {
-            result = 1;
-            (*prtcounter)[hostPtrBase] = 2;
-        }
-    } else {
-        *devPtr = 0;
-		if( prtcounter->count(hostPtrBase) > 0 ) {
-        	(*prtcounter)[hostPtrBase] = 0;
-		}
+	//The present counter is kept in the present-table entry of the mapping,
+	//and thus it is reset whenever the mapping is removed.
+	result = tconf->device->HI_update_present_counter(hostPtr, devPtr, true, asyncID+tconf->asyncID_offset, tconf->threadID);
+	if( result < 0 ) {
         result = 0;
-    }
+	}
 #ifdef _OPENARC_PROFILE_
 	tconf->PresentTableCnt++;
 	tconf->totalPresentTableTime += (HI_get_localtime() - ltime);
@@ -2003,38 +2337,12 @@ int HI_decnget_prtcounter(const void * hostPtr, void **devPtr, int asyncID, int
     HostConf_t * tconf = getHostConf(threadID);
 
     int result;
-    acc_device_t devType = tconf->acc_device_type_var;
-    int devNum = acc_get_device_num(devType, tconf->threadID);
-    countermap_t * prtcounter = tconf->prtcntmaptable;
-	void * hostPtrBase = (void *)hostPtr;
-	void *devPtrBase;
-	size_t offset;
 	if(tconf->device == NULL) {
         fprintf(stderr, "[ERROR in HI_decnget_prtcounter()] Not supported in the current device type %d; exit!\n", tconf->acc_device_type_var);
 		exit(1);
 	}
-    if( tconf->device->HI_get_device_address(hostPtr, &devPtrBase, &offset, asyncID+tconf->asyncID_offset, tconf->threadID) == HI_success) {
-		if( offset > 0 ) {
-			hostPtrBase = (void *)((size_t)hostPtrBase - offset);
-			*devPtr = (void *) ((size_t)devPtrBase + offset);
-		} else {
-			*devPtr = devPtrBase;
-		}
-        if( prtcounter->count(hostPtrBase) > 0 ) {
-            result = prtcounter->at(hostPtrBase);
-            result = result -1;
-            if( result < 0 ) result = 0;
-        } else {
-            result = 0;
-        }
-        (*prtcounter)[hostPtrBase] = result;
-    } else {
-        *devPtr = 0;
-		if( prtcounter->count(hostPtrBase) > 0 ) {
-        	(*prtcounter)[hostPtrBase] = 0;
-		}
-        result = -1; //error!!
-    }
+	//Returns -1 (error) if hostPtr is not present.
+	result = tconf->device->HI_update_present_counter(hostPtr, devPtr, false, asyncID+tconf->asyncID_offset, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 	tconf->PresentTableCnt++;
 	tconf->totalPresentTableTime += (HI_get_localtime() - ltime);
@@ -2073,6 +2381,7 @@ void HostConf::initKernelNames(int kernels, std::string kernelNames[]) {
 #ifdef _THREAD_SAFETY
 		pthread_mutex_unlock(&mutex_HI_kernelnames);
 #endif
+		getKernelID(kernelNames[i]);
     }
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2107,6 +2416,7 @@ void HostConf::addKernelNames(int kernels, std::string kernelNames[]) {
 #ifdef _THREAD_SAFETY
 		pthread_mutex_unlock(&mutex_HI_kernelnames);
 #endif
+			getKernelID(tName);
 #ifdef _OPENARC_PROFILE_
 			KernelCNTMap[tName] = 0;
 			KernelTimingMap[tName] = 0.0;
@@ -2115,6 +2425,103 @@ void HostConf::addKernelNames(int kernels, std::string kernelNames[]) {
     }
 }
 
+//Return the integer ID of the kernel, kernelName; a new ID is assigned if 
+//no host thread has used the kernel before.
+int HostConf::getKernelID(const std::string &kernelName) {
+	std::map<std::string, int>::iterator it = kernelIDs.find(kernelName);
+	if( it != kernelIDs.end() ) {
+		return it->second;
+	}
+	int kernelID;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_HI_kernelnames);
+#else
+#ifdef _OPENMP
+	#pragma omp critical (HI_kernelnames_critical)
+#endif
+#endif
+	{
+		std::map<std::string, int>::iterator git = HostConf::HI_kernelIDMap.find(kernelName);
+		if( git == HostConf::HI_kernelIDMap.end() ) {
+			git = HostConf::HI_kernelIDMap.insert(std::pair<std::string, int>(kernelName, (int)HostConf::HI_kernelIDNames.size())).first;
+			HostConf::HI_kernelIDNames.push_back(git->first.c_str());
+		}
+		kernelID = git->second;
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_HI_kernelnames);
+#endif
+	kernelIDs[kernelName] = kernelID;
+	return kernelID;
+}
+
+//Return the integer ID of the kernel, kernelName, from the cache keyed by 
+//the name pointer; on a miss, the ID is looked up by name and cached.
+int HostConf::getKernelID(const char *kernelName) {
+	std::unordered_map<const char *, std::pair<std::string, int> >::iterator it = kernelNameIDs.find(kernelName);
+	if( (it != kernelNameIDs.end()) && (it->second.first.compare(kernelName) == 0) ) {
+		return it->second.second;
+	}
+	std::string name(kernelName);
+	int kernelID = getKernelID(name);
+	kernelNameIDs[kernelName] = std::make_pair(name, kernelID);
+	return kernelID;
+}
+
+//Slow path of getKernelHandle(); fill the launch handle of the kernel, 
+//kernelID, on the device, dev, from the kernelsMap and kernelArgsMap.
+kernelhandle_t * HostConf::resolveKernelHandle(Accelerator *dev, int kernelID) {
+	const char *kernelName = NULL;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_HI_kernelnames);
+#else
+#ifdef _OPENMP
+	#pragma omp critical (HI_kernelnames_critical)
+#endif
+#endif
+	{
+		if( (kernelID >= 0) && (kernelID < (int)HostConf::HI_kernelIDNames.size()) ) {
+			kernelName = HostConf::HI_kernelIDNames[kernelID];
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_HI_kernelnames);
+#endif
+	if( kernelName == NULL ) {
+		fprintf(stderr, "[ERROR in HostConf::resolveKernelHandle()] Invalid kernel ID %d; exit!\n", kernelID);
+		exit(1);
+	}
+	std::vector<kernelhandle_t> &handles = kernelHandlesMap[dev];
+	if( kernelID >= (int)handles.size() ) {
+		handles.resize(kernelID+1, kernelhandle_t());
+	}
+	kernelhandle_t *kernelHandle = &(handles[kernelID]);
+	if( kernelHandle->kernelParams == NULL ) {
+		std::string tName(kernelName);
+		if( (kernelArgsMap.count(dev) == 0) || (kernelArgsMap.at(dev).count(tName) == 0) 
+			|| (kernelsMap.count(dev) == 0) || (kernelsMap.at(dev).count(tName) == 0) ) {
+			fprintf(stderr, "[ERROR in HostConf::resolveKernelHandle()] Kernel %s is not registered for the current device; exit!\n", kernelName);
+			exit(1);
+		}
+		kernelHandle->kernel = kernelsMap.at(dev).at(tName);
+		kernelHandle->kernelParams = kernelArgsMap.at(dev).at(tName);
+		kernelHandle->kernelName = kernelName;
+	}
+	kernelHandlesDevice = dev;
+	kernelHandles = &handles;
+	return kernelHandle;
+}
+
+//Drop the launch handles of the device, dev; called whenever the drivers 
+//rebuild the kernelsMap and kernelArgsMap of the device.
+void HostConf::resetKernelHandles(Accelerator *dev) {
+	kernelHandlesMap.erase(dev);
+	if( kernelHandlesDevice == dev ) {
+		kernelHandlesDevice = NULL;
+		kernelHandles = NULL;
+	}
+}
+
 
 //Compiler will insert this before the first read access of the variable.
 void HI_check_read(const void * hostPtr, acc_device_t dtype, const char * varName, const char *refName, int loopIndex, int threadID) {
@@ -2308,9 +2715,7 @@ void HI_reset_status(const void * hostPtr, acc_device_t dtype, HI_memstatus_t st
         //HI_memstatus_t devicestatus = (*devicememstatusmap)[hostPtr];
         if( status == HI_stale ) {
             //Set the status to stale if GPU variable is freed.
-            addresstable_t::iterator it = tconf->device->masterAddressTableMap[tconf->threadID]->find(asyncID+tconf->asyncID_offset);
-            std::map<const void *,void*>::iterator it2 =	(it->second)->find(hostPtr);
-            if(it2 == (it->second)->end() ) {
+            if( !tconf->device->HI_has_device_address(hostPtr, asyncID+tconf->asyncID_offset, tconf->threadID) ) {
                 (*devicememstatusmap)[hostPtr] = status;
             }
             /*
@@ -2487,6 +2892,9 @@ HI_error_t HI_memcpy_const_async(void *hostPtr, std::string constName, HI_Memcpy
 			exit(1);
 		}
     	return_status = tconf->device->HI_memcpy_const_async(hostPtr, constName, kind, count, async+tconf->asyncID_offset, num_waits, waitslist, tconf->threadID);
+		if( waitslist != NULL ) {
+			free(waitslist);
+		}
 	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 1 ) {
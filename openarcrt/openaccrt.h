@@ -4,6 +4,8 @@
 
 #include <cstring>
 #include <map>
+#include <unordered_map>
+#include <new>
 #include <vector>
 #include <set>
 #include <iostream>
@@ -58,8 +60,9 @@
 #endif
 
 //Enable this to use shared present table per device.
-//[FIXME] no thread-safety mechanism was implemented for the shared present table;
-//this will work only if all device memory allocation/deallocation activities are serialized.
+//The shared present table is sharded by address range; lookups are lock-free
+//(validated by per-shard sequence counters), and updates lock only the 
+//shards that the mapped range overlaps.
 //For now, the main purpose of using this is to share device data across host threads.
 //#define _USE_SHARED_PRESENT_TABLE 1
 
@@ -82,114 +85,1935 @@
 //  host pointer; saving both memory pinning cost and device memory allocation cost 
 //  but less applicable.
 //  - Too much prepinning can cause slowdown or crash of the program.
-//  - If OPENARCRT_PREPINHOSTMEM is set to 0, reuse only device memory.
+//  - If OPENARCRT_PREPINHOSTMEM is set to 0, reuse only device memory, 
+//  which can then be reused for other host pointers of compatible size.
+//  - The victim cache of each host thread is bounded by max_mempool_size.
 //
 //For OpenCL devices, VICTIM_CACHE_MODE = 1 is always applied.
 #if !defined(VICTIM_CACHE_MODE)
 #define VICTIM_CACHE_MODE 1
 #endif
 
-//PRESENT_TABLE_SEARCH_MODE = 0
-//	- Assume that the elements in the container follow a strict order at all times
-//	- Use a linear search if the table does not have a key entry matching the input key.
-//	- base pointer search time: O(logn)
-//	- intermediate pointer search time: O(n)
-//PRESENT_TABLE_SEARCH_MODE = 1
-//	- Assume that the elements in the container follow a strict order at all times
-//	- Exploit the strict ordering if the table does not have a key entry matching the input key.
-//	- base pointer search time: O(logn)
-//	- intermediate pointer search time: O(logn)
-#define PRESENT_TABLE_SEARCH_MODE 1
+#ifdef _THREAD_SAFETY
+extern pthread_mutex_t mutex_HI_init;
+extern pthread_mutex_t mutex_HI_hostinit;
+extern pthread_mutex_t mutex_HI_kernelnames;
+extern pthread_mutex_t mutex_pin_host_memory;
+extern pthread_mutex_t mutex_tempMalloc;
+extern pthread_mutex_t mutex_set_async;
+extern pthread_mutex_t mutex_set_device_num;
+extern pthread_mutex_t mutex_clContext;
+extern pthread_mutex_t mutex_memHandleTable;
+#endif
+
+//[DEBUG on June 18, 2021] Fake type used for CUDA/HIP texture object.
+typedef unsigned long long HI_texObject_t;
+
+typedef enum {
+    HI_success = 0,
+    HI_error = 1
+} HI_error_t;
+
+typedef enum {
+    HI_MemcpyHostToHost = 0,
+    HI_MemcpyHostToDevice = 1,
+    HI_MemcpyDeviceToHost = 2,
+    HI_MemcpyDeviceToDevice = 3
+} HI_MemcpyKind_t;
+
+typedef enum {
+    HI_MEM_READ_WRITE = 1,
+    HI_MEM_READ_ONLY = 2,
+    HI_MEM_WRITE_ONLY = 4,
+} HI_MallocKind_t;
+
+typedef enum {
+    HI_notstale = 0,
+    HI_stale = 1,
+    HI_maystale = 2
+} HI_memstatus_t;
+
+typedef enum {
+    HI_int = 0,
+    HI_float = 1,
+} HI_datatype_t;
+
+typedef struct _HI_device_mem_handle_t {
+    MEM_HANDLE_TYPE memHandle;
+    size_t offset;
+} HI_device_mem_handle_t;
+
+typedef struct _memhandletable_entity_t {
+    MEM_HANDLE_TYPE memHandle;
+    size_t size;
+    const void *devPtr;
+    _memhandletable_entity_t(MEM_HANDLE_TYPE _memHandle, size_t _size, const void *_devPtr=NULL) : memHandle(_memHandle), size(_size), devPtr(_devPtr) {}
+} memhandletable_entity_t;
+
+typedef struct _addresstable_entity_t {
+    void* basePtr;
+    size_t size;
+    const void* hostPtr;
+    //Present counter of the compiler-generated present checks 
+    //(HI_getninc_prtcounter()/HI_decnget_prtcounter()).
+    int presentCnt;
+    _addresstable_entity_t(void* _basePtr, size_t _size, const void* _hostPtr=NULL) : basePtr(_basePtr), size(_size), hostPtr(_hostPtr), presentCnt(0) {}
+
+    //Increment or decrement the present counter, and return the counter value
+    //that the present check returns: the value before the increment, or the 
+    //value after the decrement.
+    //The counter is updated atomically, since a mapping in the shared present
+    //table can be reached through different shards.
+    int updatePresentCnt(bool increment) {
+        int oldCnt = __atomic_load_n(&presentCnt, __ATOMIC_RELAXED);
+        int result, newCnt;
+        do {
+            if( increment ) {
+                result = (oldCnt > 0) ? oldCnt : 1;
+                newCnt = result + 1;
+            } else {
+                result = (oldCnt > 0) ? oldCnt - 1 : 0;
+                newCnt = result;
+            }
+        } while( !__atomic_compare_exchange_n(&presentCnt, &oldCnt, newCnt, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+        return result;
+    }
+} addresstable_entity_t;
+
+//Device-pointer-to-memory-handle table, which resolves both base and 
+//interior device pointers with a constant number of hash lookups.
+//A base pointer is found in an exact-match hash table.
+//For interior pointers, each entry of size S is indexed at level L, the 
+//smallest level (MEMHANDLE_INDEX_MIN_LEVEL plus a multiple of 
+//MEMHANDLE_INDEX_LEVEL_STEP) with 2^L >= S, under the (at most two) 
+//2^L-aligned blocks that the entry overlaps; a lookup probes, for each level 
+//in use, the block containing the pointer. Since the registered ranges do 
+//not overlap and entries at level L are larger than 2^(L-LEVEL_STEP) bytes,
+//a block holds at most 2^LEVEL_STEP+1 entries of its level.
+//The ordered map is kept only for iterating the entries in address order.
+#define MEMHANDLE_INDEX_MIN_LEVEL 12
+#define MEMHANDLE_INDEX_LEVEL_STEP 3
+#define MEMHANDLE_INDEX_NUM_LEVELS 64
+
+typedef std::vector<memhandletable_entity_t *> memhandleindexbucket_t;
+
+typedef class DeviceMemHandleMap
+{
+public:
+	typedef std::map<const void *, memhandletable_entity_t *>::iterator iterator;
+
+	std::map<const void *, memhandletable_entity_t *> handleMap;
+	std::unordered_map<const void *, memhandletable_entity_t *> exactIndex;
+	std::unordered_map<unsigned long, memhandleindexbucket_t> blockIndex;
+	//Number of entries indexed at each level, and the bit mask of the 
+	//levels with at least one entry.
+	long levelCnt[MEMHANDLE_INDEX_NUM_LEVELS];
+	unsigned long levelMask;
+
+	DeviceMemHandleMap() : levelMask(0) {
+		memset(levelCnt, 0, sizeof(levelCnt));
+	}
+	~DeviceMemHandleMap() {
+		clear();
+	}
+
+	iterator begin() { return handleMap.begin(); }
+	iterator end() { return handleMap.end(); }
+	size_t size() const { return handleMap.size(); }
+	bool empty() const { return handleMap.empty(); }
+
+	static int getLevel(size_t size) {
+		int level = MEMHANDLE_INDEX_MIN_LEVEL;
+		if( size > ((size_t)1 << MEMHANDLE_INDEX_MIN_LEVEL) ) {
+			level = (int)(sizeof(unsigned long)*8) - __builtin_clzl((unsigned long)(size - 1));
+			level = MEMHANDLE_INDEX_MIN_LEVEL + ((level - MEMHANDLE_INDEX_MIN_LEVEL + MEMHANDLE_INDEX_LEVEL_STEP - 1)/MEMHANDLE_INDEX_LEVEL_STEP)*MEMHANDLE_INDEX_LEVEL_STEP;
+			//Rounding up to a level step may pass the last level, which 
+			//would overflow the level shifts and levelCnt[].
+			if( level > MEMHANDLE_INDEX_NUM_LEVELS - 1 ) {
+				level = MEMHANDLE_INDEX_NUM_LEVELS - 1;
+			}
+		}
+		return level;
+	}
+
+	static unsigned long getBlockKey(unsigned long addr, int level) {
+		return ((addr >> level) << 6) | (unsigned long)level;
+	}
+
+	//Return the entry containing devPtr (NULL if none), and set *offset to 
+	//the offset of devPtr from the base address of the entry.
+	memhandletable_entity_t * find(const void *devPtr, size_t *offset) {
+		std::unordered_map<const void *, memhandletable_entity_t *>::iterator eit = exactIndex.find(devPtr);
+		if( eit != exactIndex.end() ) {
+			*offset = 0;
+			return eit->second;
+		}
+		unsigned long addr = (unsigned long)devPtr;
+		unsigned long mask = levelMask;
+		while( mask != 0 ) {
+			int level = __builtin_ctzl(mask);
+			mask &= mask - 1;
+			std::unordered_map<unsigned long, memhandleindexbucket_t>::iterator bit = blockIndex.find(getBlockKey(addr, level));
+			if( bit == blockIndex.end() ) {
+				continue;
+			}
+			memhandleindexbucket_t &bucket = bit->second;
+			for( size_t i = 0; i < bucket.size(); i++ ) {
+				unsigned long base = (unsigned long)bucket[i]->devPtr;
+				if( (addr >= base) && (addr < base + bucket[i]->size) ) {
+					*offset = addr - base;
+					return bucket[i];
+				}
+			}
+		}
+		*offset = 0;
+		return NULL;
+	}
+
+	//Add a new entry; an existing entry with the same base address is 
+	//replaced and deleted.
+	void insert(const void *devPtr, memhandletable_entity_t *aet) {
+		erase(devPtr);
+		aet->devPtr = devPtr;
+		handleMap[devPtr] = aet;
+		exactIndex[devPtr] = aet;
+		int level = getLevel(aet->size);
+		unsigned long first = (unsigned long)devPtr;
+		unsigned long last = first + ((aet->size > 0) ? aet->size - 1 : 0);
+		blockIndex[getBlockKey(first, level)].push_back(aet);
+		if( (last >> level) != (first >> level) ) {
+			blockIndex[getBlockKey(last, level)].push_back(aet);
+		}
+		levelCnt[level]++;
+		levelMask |= (1UL << level);
+	}
+
+	//Remove and delete the entry whose base address is devPtr; return false
+	//if there is no such entry.
+	bool erase(const void *devPtr) {
+		std::map<const void *, memhandletable_entity_t *>::iterator it = handleMap.find(devPtr);
+		if( it == handleMap.end() ) {
+			return false;
+		}
+		memhandletable_entity_t *aet = it->second;
+		int level = getLevel(aet->size);
+		unsigned long first = (unsigned long)devPtr;
+		unsigned long last = first + ((aet->size > 0) ? aet->size - 1 : 0);
+		removeFromBlock(getBlockKey(first, level), aet);
+		if( (last >> level) != (first >> level) ) {
+			removeFromBlock(getBlockKey(last, level), aet);
+		}
+		if( --levelCnt[level] == 0 ) {
+			levelMask &= ~(1UL << level);
+		}
+		exactIndex.erase(devPtr);
+		handleMap.erase(it);
+		delete aet;
+		return true;
+	}
+
+	void removeFromBlock(unsigned long key, memhandletable_entity_t *aet) {
+		std::unordered_map<unsigned long, memhandleindexbucket_t>::iterator bit = blockIndex.find(key);
+		if( bit == blockIndex.end() ) {
+			return;
+		}
+		memhandleindexbucket_t &bucket = bit->second;
+		for( size_t i = 0; i < bucket.size(); i++ ) {
+			if( bucket[i] == aet ) {
+				bucket[i] = bucket.back();
+				bucket.pop_back();
+				break;
+			}
+		}
+		if( bucket.empty() ) {
+			blockIndex.erase(bit);
+		}
+	}
+
+	void clear() {
+		for( iterator it = handleMap.begin(); it != handleMap.end(); ++it ) {
+			delete it->second;
+		}
+		handleMap.clear();
+		exactIndex.clear();
+		blockIndex.clear();
+		memset(levelCnt, 0, sizeof(levelCnt));
+		levelMask = 0;
+	}
+} memhandlemap_t;
+
+typedef std::map<int, memhandlemap_t *> memhandletable_t;
+typedef std::map<const void *, void *> addressmap_t;
+typedef std::map<int, addressmap_t *> addresstable_t;
+typedef std::multimap<int, const void *> asyncfreetable_t;
+typedef std::map<int, asyncfreetable_t *> asyncfreetablemap_t;
+//[DEBUG on April 15, 2021] multipmap value type is changed from void ** to void *
+typedef std::multimap<int, void *> asynctempfreetable_t;
+typedef std::map<int, asynctempfreetable_t *> asynctempfreetablemap_t;
+typedef std::multimap<int, acc_device_t> asynctempfreetable2_t;
+typedef std::map<int, asynctempfreetable2_t *> asynctempfreetablemap2_t;
+//Numbers of entries ever inserted into and retired from the postponed free 
+//tables for an async queue. Entries of the same queue are kept in insertion 
+//order, so reclaiming up to a recorded insertion count frees exactly the 
+//entries inserted before the count was taken.
+typedef struct _postponedfreecount {
+	unsigned long freeInserted;
+	unsigned long freeRetired;
+	unsigned long tempFreeInserted;
+	unsigned long tempFreeRetired;
+} postponedfreecount_t;
+//Postponed free state of a host thread.
+typedef struct _postponedfreeinfo {
+	std::map<int, postponedfreecount_t> countMap;
+#ifdef _OPENARC_PROFILE_
+	//Device memory waiting in the postponed free tables.
+	size_t size;
+	size_t peakSize;
+#endif
+} postponedfreeinfo_t;
+typedef std::map<int, postponedfreeinfo_t *> postponedfreeinfomap_t;
+
+//Number of queue indices of a host thread tracked in the direct-indexed 
+//table of ActiveQueueSet; the other queues are tracked in a hash map.
+#define ACTIVE_QUEUE_DIRECT_INDEX_LIMIT 1024
+
+//Set of the async queues of a host thread that may have pending work, 
+//i.e., commands or postponed frees added since the queue was last waited 
+//on. A queue is identified by its event map key (async ID + 2), and keys 
+//are indexed relative to the thread's async ID offset, so that insert and 
+//erase are O(1) and synchronizing all queues visits only the active ones.
+typedef class ActiveQueueSet
+{
+public:
+	//Keys of the active queues, in no particular order.
+	std::vector<int> queues;
+
+	ActiveQueueSet(int keyOffset = 0) : offset(keyOffset) {}
+
+	void insert(int key) {
+		int *pos = findPos(key, true);
+		if( *pos == 0 ) {
+			queues.push_back(key);
+			*pos = (int)queues.size();
+		}
+	}
+
+	void erase(int key) {
+		int *pos = findPos(key, false);
+		if( (pos == NULL) || (*pos == 0) ) {
+			return;
+		}
+		//Move the last active queue into the freed position.
+		int lastKey = queues.back();
+		queues[*pos - 1] = lastKey;
+		*findPos(lastKey, false) = *pos;
+		queues.pop_back();
+		clearPos(key, pos);
+	}
+
+	void clear() {
+		for( size_t i = 0; i < queues.size(); i++ ) {
+			clearPos(queues[i], findPos(queues[i], false));
+		}
+		queues.clear();
+	}
+
+private:
+	int offset;
+	//Position of each queue in queues plus 1, or 0 if the queue is idle.
+	std::vector<int> directPos;
+	std::unordered_map<int, int> hashedPos;
+
+	int *findPos(int key, bool create) {
+		int index = key - offset;
+		if( (index >= 0) && (index < ACTIVE_QUEUE_DIRECT_INDEX_LIMIT) ) {
+			if( index >= (int)directPos.size() ) {
+				if( !create ) {
+					return NULL;
+				}
+				directPos.resize(index + 1, 0);
+			}
+			return &directPos[index];
+		} else if( create ) {
+			return &hashedPos[key];
+		} else {
+			std::unordered_map<int, int>::iterator it = hashedPos.find(key);
+			return (it == hashedPos.end()) ? NULL : &(it->second);
+		}
+	}
+
+	void clearPos(int key, int *pos) {
+		int index = key - offset;
+		if( (index >= 0) && (index < ACTIVE_QUEUE_DIRECT_INDEX_LIMIT) ) {
+			*pos = 0;
+		} else {
+			hashedPos.erase(key);
+		}
+	}
+} activequeueset_t;
+typedef std::set<const void *> pointerset_t;
+typedef std::map<const void *, size_t> sizemap_t;
+typedef std::map<int, sizemap_t *> memPoolSizemap_t;
+typedef std::map<void *, int> countermap_t;
+typedef std::map<int, addressmap_t *> asyncphostmap_t;
+typedef std::map<int, sizemap_t *> asynchostsizemap_t;
+typedef std::map<const void *, HI_memstatus_t> memstatusmap_t;
+#ifdef _OPENARC_PROFILE_
+typedef std::map<int, long> presenttablecnt_t;
+#endif
+
+//Interval index of address ranges sorted by (async ID, start address), 
+//so that a lookup for an interior pointer needs only a binary search for 
+//the entry with the largest start address not greater than the pointer 
+//on the given async queue.
+//The sorted entries are stored in fixed-size chunks (a two-level B-tree);
+//a lookup searches the compact array of chunk keys and then one chunk,
+//and an insertion/deletion moves at most one chunk worth of entries.
+//Lookups do not allocate any memory.
+#define PRESENT_TABLE_CHUNK_SIZE 256
+#define PRESENT_TABLE_DIRECTORY_INIT_SIZE 16
+
+typedef struct _presenttable_key_t {
+	int asyncID;
+	const void *ptr;
+} presenttable_key_t;
+
+typedef struct _presenttable_entry_t {
+	int asyncID;
+	const void *ptr;
+	size_t size;
+	addresstable_entity_t *aet;
+} presenttable_entry_t;
+
+typedef struct _presenttable_chunk_t {
+	int count;
+	presenttable_entry_t entries[PRESENT_TABLE_CHUNK_SIZE];
+} presenttable_chunk_t;
+
+//Chunk pointers and the key of the first entry of each chunk (both sorted),
+//stored in a single block so that a reader can take a snapshot of the whole
+//directory with one pointer load.
+typedef struct _presenttable_directory_t {
+	long capacity;
+	long count;
+	presenttable_key_t *keys;
+	presenttable_chunk_t **chunks;
+} presenttable_directory_t;
+
+//Slab allocator for the fixed-size objects of a present table
+//(addresstable_entity_t and index chunks), which is not thread-safe; each 
+//per-thread table (or each shard of the shared table) owns its own slabs.
+//Objects are carved from slabs of NUM_OBJS objects, and freed objects are
+//kept in a free list for reuse; the slabs are returned to the system only 
+//by release(), which is called at HI_reset/shutdown.
+#define PRESENT_TABLE_ENTITY_SLAB_SIZE 1024
+#define PRESENT_TABLE_CHUNK_SLAB_SIZE 16
+
+template <typename T, int NUM_OBJS>
+class PresentTableSlab
+{
+public:
+	std::vector<T *> slabs;
+	void *freeList;
+	int numUsedInSlab;
+#ifdef _OPENARC_PROFILE_
+	//Number of allocations served by the slabs without calling malloc.
+	long slabHitCnt;
+	//Number of fresh slabs allocated by malloc.
+	long slabAllocCnt;
+#endif
+
+	PresentTableSlab() : freeList(NULL), numUsedInSlab(NUM_OBJS) {
+#ifdef _OPENARC_PROFILE_
+		slabHitCnt = 0;
+		slabAllocCnt = 0;
+#endif
+	}
+	~PresentTableSlab() {
+		release();
+	}
+
+	void * allocate() {
+		void *obj;
+		if( freeList != NULL ) {
+			obj = freeList;
+			freeList = *((void **)obj);
+#ifdef _OPENARC_PROFILE_
+			slabHitCnt++;
+#endif
+		} else {
+			if( numUsedInSlab == NUM_OBJS ) {
+				T *slab = (T *)malloc(sizeof(T)*NUM_OBJS);
+				if( slab == NULL ) {
+					fprintf(stderr, "[ERROR in PresentTableSlab::allocate()] Out of host memory; exit!\n");
+					exit(1);
+				}
+				slabs.push_back(slab);
+				numUsedInSlab = 0;
+#ifdef _OPENARC_PROFILE_
+				slabAllocCnt++;
+			} else {
+				slabHitCnt++;
+#endif
+			}
+			obj = (void *)(slabs.back() + numUsedInSlab);
+			numUsedInSlab++;
+		}
+		return obj;
+	}
+
+	void deallocate(T *obj) {
+		*((void **)obj) = freeList;
+		freeList = (void *)obj;
+	}
+
+	void release() {
+		for( size_t i = 0; i < slabs.size(); i++ ) {
+			free(slabs[i]);
+		}
+		slabs.clear();
+		freeList = NULL;
+		numUsedInSlab = NUM_OBJS;
+	}
+};
+
+typedef PresentTableSlab<addresstable_entity_t, PRESENT_TABLE_ENTITY_SLAB_SIZE> presenttableentityslab_t;
+typedef PresentTableSlab<presenttable_chunk_t, PRESENT_TABLE_CHUNK_SLAB_SIZE> presenttablechunkslab_t;
+
+typedef class PresentTableIndex
+{
+public:
+	presenttable_directory_t *directory;
+	//Directories replaced by larger ones; if deferFree is set (shared present
+	//table), they are kept until clear(), since concurrent optimistic readers 
+	//may still be accessing them.
+	std::vector<presenttable_directory_t *> retiredDirectories;
+	bool deferFree;
+	size_t numEntries;
+	presenttablechunkslab_t *chunkSlab;
+
+	PresentTableIndex(presenttablechunkslab_t *_chunkSlab, bool _deferFree=false) : deferFree(_deferFree), numEntries(0), chunkSlab(_chunkSlab) {
+		directory = newDirectory(PRESENT_TABLE_DIRECTORY_INIT_SIZE);
+	}
+	~PresentTableIndex() {
+		clear();
+		free(directory);
+	}
+
+	static presenttable_directory_t * newDirectory(long capacity) {
+		presenttable_directory_t *dir = (presenttable_directory_t *)calloc(1, sizeof(presenttable_directory_t) + capacity*(sizeof(presenttable_key_t) + sizeof(presenttable_chunk_t *)));
+		if( dir == NULL ) {
+			fprintf(stderr, "[ERROR in PresentTableIndex::newDirectory()] Out of host memory; exit!\n");
+			exit(1);
+		}
+		dir->capacity = capacity;
+		dir->count = 0;
+		dir->keys = (presenttable_key_t *)(dir + 1);
+		dir->chunks = (presenttable_chunk_t **)(dir->keys + capacity);
+		return dir;
+	}
+
+	static inline bool keyLess(int asyncID1, const void *ptr1, int asyncID2, const void *ptr2) {
+		return (asyncID1 < asyncID2) || ((asyncID1 == asyncID2) && ((size_t)ptr1 < (size_t)ptr2));
+	}
+
+	size_t size() const {
+		return numEntries;
+	}
+
+	long numChunks() const {
+		return directory->count;
+	}
+
+	presenttable_chunk_t * getChunk(long c) const {
+		return directory->chunks[c];
+	}
+
+	//Return the index of the last chunk whose first key is not greater than 
+	//the input key, or -1 if there is no such chunk.
+	//The search is bounded by the directory capacity, since the count may be
+	//read while a writer of a shared table is updating it.
+	static long findChunk(const presenttable_directory_t *dir, const void *ptr, int asyncID) {
+		long lo = 0;
+		long hi = dir->count;
+		if( hi > dir->capacity ) {
+			hi = dir->capacity;
+		}
+		while( lo < hi ) {
+			long mid = (lo + hi) >> 1;
+			if( keyLess(asyncID, ptr, dir->keys[mid].asyncID, dir->keys[mid].ptr) ) {
+				hi = mid;
+			} else {
+				lo = mid + 1;
+			}
+		}
+		return lo - 1;
+	}
+
+	//Return the index of the last entry in the chunk whose key is not greater 
+	//than the input key, or -1 if there is no such entry.
+	static int findEntry(const presenttable_chunk_t *chunk, const void *ptr, int asyncID) {
+		int lo = 0;
+		int hi = chunk->count;
+		if( (hi < 0) || (hi > PRESENT_TABLE_CHUNK_SIZE) ) {
+			hi = 0;
+		}
+		while( lo < hi ) {
+			int mid = (lo + hi) >> 1;
+			if( keyLess(asyncID, ptr, chunk->entries[mid].asyncID, chunk->entries[mid].ptr) ) {
+				hi = mid;
+			} else {
+				lo = mid + 1;
+			}
+		}
+		return lo - 1;
+	}
+
+	//Return the entry with the largest key not greater than the input key.
+	presenttable_entry_t * findFloor(const void *ptr, int asyncID) const {
+		const presenttable_directory_t *dir = __atomic_load_n(&directory, __ATOMIC_ACQUIRE);
+		long c = findChunk(dir, ptr, asyncID);
+		if( c < 0 ) {
+			return NULL;
+		}
+		presenttable_chunk_t *chunk = dir->chunks[c];
+		if( chunk == NULL ) {
+			return NULL;
+		}
+		int e = findEntry(chunk, ptr, asyncID);
+		if( e < 0 ) {
+			return NULL;
+		}
+		return &(chunk->entries[e]);
+	}
+
+	//Find the entry whose range contains ptr on the asyncID queue.
+	//If found, offset is set to the distance from the start of the range.
+	presenttable_entry_t * find(const void *ptr, int asyncID, size_t *offset) const {
+		presenttable_entry_t *entry = findFloor(ptr, asyncID);
+		if( (entry == NULL) || (entry->asyncID != asyncID) ) {
+			return NULL;
+		}
+		if( (entry->ptr == ptr) || ((size_t)ptr < (size_t)entry->ptr + entry->size) ) {
+			if( offset ) *offset = (size_t)ptr - (size_t)entry->ptr;
+			return entry;
+		}
+		return NULL;
+	}
+
+	//Find the entry whose range starts exactly at ptr on the asyncID queue.
+	presenttable_entry_t * findExact(const void *ptr, int asyncID) const {
+		presenttable_entry_t *entry = findFloor(ptr, asyncID);
+		if( (entry != NULL) && (entry->asyncID == asyncID) && (entry->ptr == ptr) ) {
+			return entry;
+		}
+		return NULL;
+	}
+
+	presenttable_chunk_t * newChunk() {
+		//Chunks are zero-filled so that optimistic readers never see 
+		//uninitialized entity pointers.
+		presenttable_chunk_t *chunk = (presenttable_chunk_t *)chunkSlab->allocate();
+		memset(chunk, 0, sizeof(presenttable_chunk_t));
+		return chunk;
+	}
+
+	//Insert a chunk at position c of the directory, growing it if full.
+	void insertChunk(long c, presenttable_chunk_t *chunk, int asyncID, const void *ptr) {
+		presenttable_directory_t *dir = directory;
+		if( dir->count == dir->capacity ) {
+			presenttable_directory_t *newDir = newDirectory(dir->capacity*2);
+			memcpy(newDir->keys, dir->keys, sizeof(presenttable_key_t)*dir->count);
+			memcpy(newDir->chunks, dir->chunks, sizeof(presenttable_chunk_t *)*dir->count);
+			newDir->count = dir->count;
+			__atomic_store_n(&directory, newDir, __ATOMIC_RELEASE);
+			if( deferFree ) {
+				retiredDirectories.push_back(dir);
+			} else {
+				free(dir);
+			}
+			dir = newDir;
+		}
+		memmove(dir->keys + c + 1, dir->keys + c, sizeof(presenttable_key_t)*(dir->count - c));
+		memmove(dir->chunks + c + 1, dir->chunks + c, sizeof(presenttable_chunk_t *)*(dir->count - c));
+		dir->keys[c].asyncID = asyncID;
+		dir->keys[c].ptr = ptr;
+		dir->chunks[c] = chunk;
+		dir->count++;
+	}
+
+	//Insert a new range; if an entry with the same key exists, its 
+	//addresstable_entity_t is replaced, and the old one is returned.
+	addresstable_entity_t * insert(const void *ptr, size_t size, int asyncID, addresstable_entity_t *aet) {
+		presenttable_directory_t *dir = directory;
+		presenttable_chunk_t *chunk;
+		long c = findChunk(dir, ptr, asyncID);
+		int e;
+		if( dir->count == 0 ) {
+			chunk = newChunk();
+			insertChunk(0, chunk, asyncID, ptr);
+			dir = directory;
+			c = 0;
+			e = -1;
+		} else {
+			if( c < 0 ) {
+				c = 0;
+			}
+			chunk = dir->chunks[c];
+			e = findEntry(chunk, ptr, asyncID);
+			if( (e >= 0) && (chunk->entries[e].asyncID == asyncID) && (chunk->entries[e].ptr == ptr) ) {
+				addresstable_entity_t *oldAet = chunk->entries[e].aet;
+				chunk->entries[e].size = size;
+				chunk->entries[e].aet = aet;
+				return oldAet;
+			}
+		}
+		if( chunk->count == PRESENT_TABLE_CHUNK_SIZE ) {
+			//Split the full chunk into two halves.
+			presenttable_chunk_t *nChunk = newChunk();
+			int half = PRESENT_TABLE_CHUNK_SIZE/2;
+			nChunk->count = PRESENT_TABLE_CHUNK_SIZE - half;
+			memcpy(nChunk->entries, chunk->entries + half, sizeof(presenttable_entry_t)*nChunk->count);
+			chunk->count = half;
+			insertChunk(c + 1, nChunk, nChunk->entries[0].asyncID, nChunk->entries[0].ptr);
+			dir = directory;
+			if( e >= half ) {
+				c++;
+				chunk = nChunk;
+				e -= half;
+			}
+		}
+		//Insert the new entry after the e-th entry.
+		e++;
+		memmove(chunk->entries + e + 1, chunk->entries + e, sizeof(presenttable_entry_t)*(chunk->count - e));
+		presenttable_entry_t *entry = &(chunk->entries[e]);
+		entry->asyncID = asyncID;
+		entry->ptr = ptr;
+		entry->size = size;
+		entry->aet = aet;
+		chunk->count++;
+		if( e == 0 ) {
+			dir->keys[c].asyncID = asyncID;
+			dir->keys[c].ptr = ptr;
+		}
+		numEntries++;
+		return NULL;
+	}
+
+	//Remove the entry whose range starts exactly at ptr on the asyncID queue,
+	//and return its addresstable_entity_t (NULL if not found).
+	addresstable_entity_t * erase(const void *ptr, int asyncID) {
+		presenttable_directory_t *dir = directory;
+		long c = findChunk(dir, ptr, asyncID);
+		if( c < 0 ) {
+			return NULL;
+		}
+		presenttable_chunk_t *chunk = dir->chunks[c];
+		int e = findEntry(chunk, ptr, asyncID);
+		if( (e < 0) || (chunk->entries[e].asyncID != asyncID) || (chunk->entries[e].ptr != ptr) ) {
+			return NULL;
+		}
+		addresstable_entity_t *aet = chunk->entries[e].aet;
+		chunk->count--;
+		memmove(chunk->entries + e, chunk->entries + e + 1, sizeof(presenttable_entry_t)*(chunk->count - e));
+		if( chunk->count == 0 ) {
+			dir->count--;
+			memmove(dir->keys + c, dir->keys + c + 1, sizeof(presenttable_key_t)*(dir->count - c));
+			memmove(dir->chunks + c, dir->chunks + c + 1, sizeof(presenttable_chunk_t *)*(dir->count - c));
+			chunkSlab->deallocate(chunk);
+		} else if( e == 0 ) {
+			dir->keys[c].asyncID = chunk->entries[0].asyncID;
+			dir->keys[c].ptr = chunk->entries[0].ptr;
+		}
+		numEntries--;
+		return aet;
+	}
+
+	//Delete all entries; the addresstable_entity_t objects are not deleted.
+	void clear() {
+		presenttable_directory_t *dir = directory;
+		for( long c = 0; c < dir->count; c++ ) {
+			chunkSlab->deallocate(dir->chunks[c]);
+		}
+		dir->count = 0;
+		for( size_t i = 0; i < retiredDirectories.size(); i++ ) {
+			free(retiredDirectories[i]);
+		}
+		retiredDirectories.clear();
+		numEntries = 0;
+	}
+} presenttableindex_t;
+
+//Small most-recently-used cache of present-table lookups, which is 
+//consulted by HI_get_device_address before the present table, since 
+//kernel wrappers look up the same few host pointers at every launch.
+//An entry records the queried async ID, the async ID of the queue where 
+//the mapping was found (the queried one or the default queue), and a copy
+//of the mapping; the owning present table invalidates the affected entries 
+//whenever a mapping is inserted or removed.
+//A mapping found on the queried queue serves any pointer in its range (the 
+//runtime never maps a range overlapping one present on the same queue), but 
+//one found on the default queue serves only the queried pointer, since 
+//other pointers in the range may be mapped on the queried queue.
+#define PRESENT_LOOKUP_CACHE_SIZE 8
+
+typedef struct _presentlookupcache_entry_t {
+	int asyncID;
+	int foundAsyncID;
+	const void *queriedPtr;
+	const void *hostPtr;
+	void *basePtr;
+	size_t size;
+} presentlookupcache_entry_t;
+
+typedef class PresentLookupCache
+{
+public:
+	//entries[0] is the most recently used one.
+	presentlookupcache_entry_t entries[PRESENT_LOOKUP_CACHE_SIZE];
+	int numEntries;
+#ifdef _OPENARC_PROFILE_
+	long cacheHitCnt;
+	long cacheMissCnt;
+#endif
+
+	PresentLookupCache() : numEntries(0) {
+#ifdef _OPENARC_PROFILE_
+		cacheHitCnt = 0;
+		cacheMissCnt = 0;
+#endif
+	}
+
+	//Find the cached mapping whose host range contains hostPtr for a lookup 
+	//on the asyncID queue.
+	bool lookup(const void *hostPtr, int asyncID, addresstable_entity_t *result, size_t *offset) {
+		for( int i = 0; i < numEntries; i++ ) {
+			presentlookupcache_entry_t *entry = &entries[i];
+			if( (entry->asyncID == asyncID) && ((entry->foundAsyncID == asyncID) ? 
+				(((size_t)hostPtr >= (size_t)entry->hostPtr) && ((hostPtr == entry->hostPtr) || ((size_t)hostPtr < (size_t)entry->hostPtr + entry->size))) :
+				(hostPtr == entry->queriedPtr)) ) {
+				if( result ) {
+					result->basePtr = entry->basePtr;
+					result->size = entry->size;
+					result->hostPtr = entry->hostPtr;
+				}
+				if( offset ) *offset = (size_t)hostPtr - (size_t)entry->hostPtr;
+				if( i > 0 ) {
+					presentlookupcache_entry_t tEntry = *entry;
+					memmove(entries + 1, entries, sizeof(presentlookupcache_entry_t)*i);
+					entries[0] = tEntry;
+				}
+#ifdef _OPENARC_PROFILE_
+				cacheHitCnt++;
+#endif
+				return true;
+			}
+		}
+#ifdef _OPENARC_PROFILE_
+		cacheMissCnt++;
+#endif
+		return false;
+	}
+
+	//Add the result of a lookup for queriedPtr on the asyncID queue, which 
+	//was found on the foundAsyncID queue; the least recently used entry is 
+	//evicted if full.
+	void add(const void *queriedPtr, int asyncID, int foundAsyncID, const addresstable_entity_t &aet) {
+		int n = (numEntries < PRESENT_LOOKUP_CACHE_SIZE) ? numEntries : PRESENT_LOOKUP_CACHE_SIZE - 1;
+		memmove(entries + 1, entries, sizeof(presentlookupcache_entry_t)*n);
+		entries[0].asyncID = asyncID;
+		entries[0].foundAsyncID = foundAsyncID;
+		entries[0].queriedPtr = queriedPtr;
+		entries[0].hostPtr = aet.hostPtr;
+		entries[0].basePtr = aet.basePtr;
+		entries[0].size = aet.size;
+		numEntries = n + 1;
+	}
+
+	//Remove the entries that a mapping of [hostPtr, hostPtr+size) on the 
+	//asyncID queue may affect: those found on that queue, or queried on that 
+	//queue but found on the default queue, whose ranges overlap it.
+	void invalidate(const void *hostPtr, size_t size, int asyncID) {
+		size_t start = (size_t)hostPtr;
+		size_t end = start + ((size == 0) ? 1 : size);
+		int n = 0;
+		for( int i = 0; i < numEntries; i++ ) {
+			presentlookupcache_entry_t *entry = &entries[i];
+			size_t eStart = (size_t)entry->hostPtr;
+			size_t eEnd = eStart + ((entry->size == 0) ? 1 : entry->size);
+			if( ((entry->foundAsyncID == asyncID) || (entry->asyncID == asyncID)) && (eStart < end) && (start < eEnd) ) {
+				continue;
+			}
+			if( n != i ) {
+				entries[n] = *entry;
+			}
+			n++;
+		}
+		numEntries = n;
+	}
+
+	void clear() {
+		numEntries = 0;
+	}
+} presentlookupcache_t;
+
+//Per-thread present table, which maps a host address range to its device
+//address range.
+//hostIndex is keyed by host pointers and owns the addresstable_entity_t 
+//objects; deviceIndex is a reverse index keyed by device base pointers, 
+//sharing the same entities, which is kept consistent by insert()/erase().
+//Entities and index chunks are allocated from per-table slabs, whose memory
+//is returned only by clear() (at HI_reset/shutdown).
+//Lookups return a copy of the matching entity.
+typedef class PresentTable
+{
+public:
+	presenttableentityslab_t entitySlab;
+	presenttablechunkslab_t chunkSlab;
+	presenttableindex_t hostIndex;
+	presenttableindex_t deviceIndex;
+	presentlookupcache_t lookupCache;
+
+	PresentTable() : hostIndex(&chunkSlab), deviceIndex(&chunkSlab) {}
+	~PresentTable() {
+		clear();
+	}
+
+	size_t size() const {
+		return hostIndex.size();
+	}
+
+	//Find the mapping whose host range contains hostPtr on the asyncID queue.
+	bool find(const void *hostPtr, int asyncID, addresstable_entity_t *result, size_t *offset) const {
+		presenttable_entry_t *entry = hostIndex.find(hostPtr, asyncID, offset);
+		if( entry == NULL ) {
+			return false;
+		}
+		if( result ) *result = *(entry->aet);
+		return true;
+	}
+
+	//Check whether hostPtr is mapped as a base address on the asyncID queue.
+	bool findExact(const void *hostPtr, int asyncID) const {
+		return (hostIndex.findExact(hostPtr, asyncID) != NULL);
+	}
+
+	//Find the mapping whose host range contains hostPtr on the asyncID queue,
+	//and update its present counter in place; cnt is set to the value 
+	//returned by addresstable_entity_t::updatePresentCnt().
+	bool updatePresentCnt(const void *hostPtr, int asyncID, bool increment, int *cnt, addresstable_entity_t *result, size_t *offset) {
+		presenttable_entry_t *entry = hostIndex.find(hostPtr, asyncID, offset);
+		if( entry == NULL ) {
+			return false;
+		}
+		*cnt = entry->aet->updatePresentCnt(increment);
+		if( result ) *result = *(entry->aet);
+		return true;
+	}
+
+	//Find the mapping whose device range contains devPtr on the asyncID queue.
+	bool findDevice(const void *devPtr, int asyncID, addresstable_entity_t *result, size_t *offset) const {
+		presenttable_entry_t *entry = deviceIndex.find(devPtr, asyncID, offset);
+		if( entry == NULL ) {
+			return false;
+		}
+		if( result ) *result = *(entry->aet);
+		return true;
+	}
+
+	//Insert a new mapping; if hostPtr was already mapped on the asyncID 
+	//queue, the old mapping is replaced.
+	void insert(const void *hostPtr, void *devPtr, size_t size, int asyncID) {
+		addresstable_entity_t *aet = new (entitySlab.allocate()) addresstable_entity_t(devPtr, size, hostPtr);
+		addresstable_entity_t *oldAet = hostIndex.insert(hostPtr, size, asyncID, aet);
+		lookupCache.invalidate(hostPtr, size, asyncID);
+		if( oldAet != NULL ) {
+			lookupCache.invalidate(hostPtr, oldAet->size, asyncID);
+			eraseDevice(oldAet, asyncID);
+			entitySlab.deallocate(oldAet);
+		}
+		deviceIndex.insert(devPtr, size, asyncID, aet);
+	}
+
+	//Remove the mapping of hostPtr on the asyncID queue; return false if 
+	//there is no such mapping.
+	bool erase(const void *hostPtr, int asyncID) {
+		addresstable_entity_t *aet = hostIndex.erase(hostPtr, asyncID);
+		if( aet == NULL ) {
+			return false;
+		}
+		lookupCache.invalidate(hostPtr, aet->size, asyncID);
+		eraseDevice(aet, asyncID);
+		entitySlab.deallocate(aet);
+		return true;
+	}
+
+	//Remove the reverse entry only if it still refers to the given entity,
+	//since the same device address may have been re-registered by another 
+	//host pointer.
+	void eraseDevice(addresstable_entity_t *aet, int asyncID) {
+		presenttable_entry_t *entry = deviceIndex.findExact(aet->basePtr, asyncID);
+		if( (entry != NULL) && (entry->aet == aet) ) {
+			deviceIndex.erase(aet->basePtr, asyncID);
+		}
+	}
+
+	//Copy the (host pointer, async ID) keys of all mappings into keys.
+	void getKeys(std::vector<presenttable_key_t> &keys) const {
+		for( long c = 0; c < hostIndex.numChunks(); c++ ) {
+			presenttable_chunk_t *chunk = hostIndex.getChunk(c);
+			for( int e = 0; e < chunk->count; e++ ) {
+				presenttable_key_t key;
+				key.asyncID = chunk->entries[e].asyncID;
+				key.ptr = chunk->entries[e].ptr;
+				keys.push_back(key);
+			}
+		}
+	}
+
+	//Copy all mappings into entries (for diagnostics).
+	void getEntries(std::vector<addresstable_entity_t> &entries) const {
+		for( long c = 0; c < hostIndex.numChunks(); c++ ) {
+			presenttable_chunk_t *chunk = hostIndex.getChunk(c);
+			for( int e = 0; e < chunk->count; e++ ) {
+				entries.push_back(*(chunk->entries[e].aet));
+			}
+		}
+	}
+
+#ifdef _OPENARC_PROFILE_
+	void getSlabCnt(long *slabHitCnt, long *slabAllocCnt) const {
+		*slabHitCnt = entitySlab.slabHitCnt + chunkSlab.slabHitCnt;
+		*slabAllocCnt = entitySlab.slabAllocCnt + chunkSlab.slabAllocCnt;
+	}
+
+	void resetSlabCnt() {
+		entitySlab.slabHitCnt = 0;
+		entitySlab.slabAllocCnt = 0;
+		chunkSlab.slabHitCnt = 0;
+		chunkSlab.slabAllocCnt = 0;
+	}
+#endif
+
+	//Delete all entries and return the slab memory to the system.
+	void clear() {
+		hostIndex.clear();
+		deviceIndex.clear();
+		lookupCache.clear();
+		entitySlab.release();
+		chunkSlab.release();
+	}
+} presenttable_t;
+
+//Lock of the shared present table shards and the victim cache shards.
+typedef class PresentTableLock
+{
+public:
+#ifdef _THREAD_SAFETY
+	pthread_mutex_t mutex;
+#else
+#ifdef _OPENMP
+	omp_lock_t mutex;
+#endif
+#endif
+
+	PresentTableLock() {
+#ifdef _THREAD_SAFETY
+		pthread_mutex_init(&mutex, NULL);
+#else
+#ifdef _OPENMP
+		omp_init_lock(&mutex);
+#endif
+#endif
+	}
+	~PresentTableLock() {
+#ifdef _THREAD_SAFETY
+		pthread_mutex_destroy(&mutex);
+#else
+#ifdef _OPENMP
+		omp_destroy_lock(&mutex);
+#endif
+#endif
+	}
+
+	void lock() {
+#ifdef _THREAD_SAFETY
+		pthread_mutex_lock(&mutex);
+#else
+#ifdef _OPENMP
+		omp_set_lock(&mutex);
+#endif
+#endif
+	}
+
+	void unlock() {
+#ifdef _THREAD_SAFETY
+		pthread_mutex_unlock(&mutex);
+#else
+#ifdef _OPENMP
+		omp_unset_lock(&mutex);
+#endif
+#endif
+	}
+} presenttablelock_t;
+
+#ifdef _USE_SHARED_PRESENT_TABLE
+//Shared present table per device, used by all host threads.
+//The host index and the device index are each split into shards by address 
+//range: the address space is divided into regions of 
+//2^SHARED_PRESENT_TABLE_REGION_SHIFT bytes, each of which is hashed to a shard,
+//and a mapping is inserted into every shard whose regions overlap its range, 
+//so that a lookup needs to search only the shard of the queried pointer.
+//Readers are optimistic: a lookup runs without any lock and validates its 
+//result against the shard's sequence counter, which writers make odd while 
+//they modify the shard (seqlock). Writers take per-shard locks in ascending
+//shard order. Memory that a concurrent reader may touch (entities, chunks, 
+//and replaced directories) is only recycled within the table and returned 
+//to the system by clear(), which must be called only when no other thread 
+//accesses the table (HI_reset).
+//SHARED_PRESENT_TABLE_NUM_SHARDS should not be larger than 64.
+#define SHARED_PRESENT_TABLE_NUM_SHARDS 64
+#define SHARED_PRESENT_TABLE_REGION_SHIFT 20
+#define SHARED_PRESENT_TABLE_MAX_OPTIMISTIC_READS 64
+
+typedef class SharedPresentTableShard
+{
+public:
+	//Sequence counter; odd while a writer is modifying this shard.
+	unsigned long seq;
+	presenttablelock_t writeLock;
+	presenttablechunkslab_t chunkSlab;
+	presenttableindex_t index;
+
+	SharedPresentTableShard() : seq(0), index(&chunkSlab, true) {}
+
+	void lock() {
+		writeLock.lock();
+	}
+
+	void unlock() {
+		writeLock.unlock();
+	}
+
+	//Called with the write lock held, before and after modifying the shard.
+	void writeBegin() {
+		__atomic_store_n(&seq, seq + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	void writeEnd() {
+		__atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+	}
+
+	//Return the sequence number to validate an optimistic read against, 
+	//or an odd number if a writer is active.
+	unsigned long readBegin() const {
+		return __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+	}
+
+	bool readValidate(unsigned long startSeq) const {
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		return (startSeq & 1) == 0 && __atomic_load_n(&seq, __ATOMIC_RELAXED) == startSeq;
+	}
+} sharedpresenttableshard_t;
+
+typedef class SharedPresentTable
+{
+public:
+	sharedpresenttableshard_t hostShards[SHARED_PRESENT_TABLE_NUM_SHARDS];
+	sharedpresenttableshard_t deviceShards[SHARED_PRESENT_TABLE_NUM_SHARDS];
+	//Entities are shared by multiple shards, and thus allocated from a 
+	//separate slab with its own lock.
+	presenttablelock_t entityLock;
+	presenttableentityslab_t entitySlab;
+	size_t numEntries;
+
+	SharedPresentTable() : numEntries(0) {}
+	~SharedPresentTable() {
+		clear();
+	}
+
+	size_t size() const {
+		return __atomic_load_n(&numEntries, __ATOMIC_RELAXED);
+	}
+
+	static int shardOf(const void *ptr) {
+		unsigned long long region = (unsigned long long)((size_t)ptr >> SHARED_PRESENT_TABLE_REGION_SHIFT);
+		return (int)(((region * 11400714819323198485ULL) >> 32) % SHARED_PRESENT_TABLE_NUM_SHARDS);
+	}
+
+	//Return the set of shards whose regions overlap [ptr, ptr+size) as a bit mask.
+	static unsigned long long shardMask(const void *ptr, size_t size) {
+		size_t first = (size_t)ptr >> SHARED_PRESENT_TABLE_REGION_SHIFT;
+		size_t last = (size == 0) ? first : ((size_t)ptr + size - 1) >> SHARED_PRESENT_TABLE_REGION_SHIFT;
+		if( last - first + 1 >= SHARED_PRESENT_TABLE_NUM_SHARDS ) {
+			return ~0ULL >> (64 - SHARED_PRESENT_TABLE_NUM_SHARDS);
+		}
+		unsigned long long mask = 0;
+		for( size_t region = first; region <= last; region++ ) {
+			mask |= 1ULL << shardOf((const void *)(region << SHARED_PRESENT_TABLE_REGION_SHIFT));
+		}
+		return mask;
+	}
+
+	static void lockShards(sharedpresenttableshard_t *shards, unsigned long long mask) {
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			if( mask & (1ULL << i) ) {
+				shards[i].lock();
+				shards[i].writeBegin();
+			}
+		}
+	}
+
+	static void unlockShards(sharedpresenttableshard_t *shards, unsigned long long mask) {
+		for( int i = SHARED_PRESENT_TABLE_NUM_SHARDS - 1; i >= 0; i-- ) {
+			if( mask & (1ULL << i) ) {
+				shards[i].writeEnd();
+				shards[i].unlock();
+			}
+		}
+	}
+
+	//Look up ptr in the shard of ptr; the matching entity is copied into result.
+	//exact = true requires ptr to be the start address of the range.
+	static bool lookup(sharedpresenttableshard_t *shards, const void *ptr, int asyncID, bool exact, addresstable_entity_t *result, size_t *offset) {
+		sharedpresenttableshard_t *shard = &shards[shardOf(ptr)];
+		addresstable_entity_t tAet(NULL, 0);
+		size_t tOffset = 0;
+		bool found = false;
+		int numTries = 0;
+		while( true ) {
+			bool locked = (numTries++ >= SHARED_PRESENT_TABLE_MAX_OPTIMISTIC_READS);
+			unsigned long startSeq = 0;
+			if( locked ) {
+				//Too many conflicts with writers; fall back to a locked read.
+				shard->lock();
+			} else {
+				startSeq = shard->readBegin();
+				if( startSeq & 1 ) {
+					continue;
+				}
+			}
+			presenttable_entry_t *entry = exact ? shard->index.findExact(ptr, asyncID) : shard->index.find(ptr, asyncID, &tOffset);
+			found = false;
+			if( entry != NULL ) {
+				addresstable_entity_t *aet = entry->aet;
+				if( aet != NULL ) {
+					tAet = *aet;
+					found = true;
+				}
+			}
+			if( locked ) {
+				shard->unlock();
+				break;
+			} else if( shard->readValidate(startSeq) ) {
+				break;
+			}
+		}
+		if( found ) {
+			if( result ) *result = tAet;
+			if( offset ) *offset = exact ? 0 : tOffset;
+		}
+		return found;
+	}
+
+	bool find(const void *hostPtr, int asyncID, addresstable_entity_t *result, size_t *offset) {
+		return lookup(hostShards, hostPtr, asyncID, false, result, offset);
+	}
+
+	bool findExact(const void *hostPtr, int asyncID) {
+		return lookup(hostShards, hostPtr, asyncID, true, NULL, NULL);
+	}
+
+	//Find the mapping whose host range contains hostPtr on the asyncID queue,
+	//and update its present counter in place; the shard lock keeps the 
+	//mapping from being removed meanwhile.
+	bool updatePresentCnt(const void *hostPtr, int asyncID, bool increment, int *cnt, addresstable_entity_t *result, size_t *offset) {
+		sharedpresenttableshard_t *shard = &hostShards[shardOf(hostPtr)];
+		bool found = false;
+		shard->lock();
+		presenttable_entry_t *entry = shard->index.find(hostPtr, asyncID, offset);
+		if( entry != NULL ) {
+			*cnt = entry->aet->updatePresentCnt(increment);
+			if( result ) *result = *(entry->aet);
+			found = true;
+		}
+		shard->unlock();
+		return found;
+	}
+
+	bool findDevice(const void *devPtr, int asyncID, addresstable_entity_t *result, size_t *offset) {
+		return lookup(deviceShards, devPtr, asyncID, false, result, offset);
+	}
+
+	//Insert a new mapping; if hostPtr was already mapped on the asyncID 
+	//queue, the old mapping is replaced.
+	void insert(const void *hostPtr, void *devPtr, size_t size, int asyncID) {
+		entityLock.lock();
+		addresstable_entity_t *aet = new (entitySlab.allocate()) addresstable_entity_t(devPtr, size, hostPtr);
+		entityLock.unlock();
+		unsigned long long hostMask = shardMask(hostPtr, size);
+		unsigned long long deviceMask = shardMask(devPtr, size);
+		sharedpresenttableshard_t *homeShard = &hostShards[shardOf(hostPtr)];
+		while( true ) {
+			lockShards(hostShards, hostMask);
+			lockShards(deviceShards, deviceMask);
+			//A mapping is added to/removed from all of its shards at once, and 
+			//thus it exists if and only if it is in the shard of hostPtr.
+			if( homeShard->index.findExact(hostPtr, asyncID) == NULL ) {
+				break;
+			}
+			unlockShards(deviceShards, deviceMask);
+			unlockShards(hostShards, hostMask);
+			erase(hostPtr, asyncID);
+		}
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			if( hostMask & (1ULL << i) ) {
+				hostShards[i].index.insert(hostPtr, size, asyncID, aet);
+			}
+			if( deviceMask & (1ULL << i) ) {
+				deviceShards[i].index.insert(devPtr, size, asyncID, aet);
+			}
+		}
+		__atomic_fetch_add(&numEntries, 1, __ATOMIC_RELAXED);
+		unlockShards(deviceShards, deviceMask);
+		unlockShards(hostShards, hostMask);
+	}
+
+	//Remove the mapping of hostPtr on the asyncID queue; return false if 
+	//there is no such mapping.
+	bool erase(const void *hostPtr, int asyncID) {
+		sharedpresenttableshard_t *homeShard = &hostShards[shardOf(hostPtr)];
+		addresstable_entity_t *aet;
+		unsigned long long hostMask, deviceMask;
+		while( true ) {
+			//Find the range of the mapping to decide which shards to lock, 
+			//and check that it is unchanged once the locks are held.
+			addresstable_entity_t tAet(NULL, 0);
+			if( !lookup(hostShards, hostPtr, asyncID, true, &tAet, NULL) ) {
+				return false;
+			}
+			hostMask = shardMask(hostPtr, tAet.size);
+			deviceMask = shardMask(tAet.basePtr, tAet.size);
+			lockShards(hostShards, hostMask);
+			lockShards(deviceShards, deviceMask);
+			presenttable_entry_t *entry = homeShard->index.findExact(hostPtr, asyncID);
+			if( entry == NULL ) {
+				unlockShards(deviceShards, deviceMask);
+				unlockShards(hostShards, hostMask);
+				return false;
+			}
+			aet = entry->aet;
+			if( (aet->size == tAet.size) && (aet->basePtr == tAet.basePtr) ) {
+				break;
+			}
+			unlockShards(deviceShards, deviceMask);
+			unlockShards(hostShards, hostMask);
+		}
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			if( hostMask & (1ULL << i) ) {
+				hostShards[i].index.erase(hostPtr, asyncID);
+			}
+			if( deviceMask & (1ULL << i) ) {
+				presenttable_entry_t *entry = deviceShards[i].index.findExact(aet->basePtr, asyncID);
+				if( (entry != NULL) && (entry->aet == aet) ) {
+					deviceShards[i].index.erase(aet->basePtr, asyncID);
+				}
+			}
+		}
+		__atomic_fetch_sub(&numEntries, 1, __ATOMIC_RELAXED);
+		unlockShards(deviceShards, deviceMask);
+		unlockShards(hostShards, hostMask);
+		entityLock.lock();
+		entitySlab.deallocate(aet);
+		entityLock.unlock();
+		return true;
+	}
 
-#ifdef _THREAD_SAFETY
-extern pthread_mutex_t mutex_HI_init;
-extern pthread_mutex_t mutex_HI_hostinit;
-extern pthread_mutex_t mutex_HI_kernelnames;
-extern pthread_mutex_t mutex_pin_host_memory;
-extern pthread_mutex_t mutex_victim_cache;
-extern pthread_mutex_t mutex_tempMalloc;
-extern pthread_mutex_t mutex_set_async;
-extern pthread_mutex_t mutex_set_device_num;
-extern pthread_mutex_t mutex_clContext;
-extern pthread_mutex_t mutex_presentTable;
+	//Copy all mappings into entries (for diagnostics); a mapping is 
+	//reported by the shard of its host base address only.
+	void getEntries(std::vector<addresstable_entity_t> &entries) {
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			sharedpresenttableshard_t *shard = &hostShards[i];
+			shard->lock();
+			for( long c = 0; c < shard->index.numChunks(); c++ ) {
+				presenttable_chunk_t *chunk = shard->index.getChunk(c);
+				for( int e = 0; e < chunk->count; e++ ) {
+					if( shardOf(chunk->entries[e].ptr) == i ) {
+						entries.push_back(*(chunk->entries[e].aet));
+					}
+				}
+			}
+			shard->unlock();
+		}
+	}
+
+#ifdef _OPENARC_PROFILE_
+	void getSlabCnt(long *slabHitCnt, long *slabAllocCnt) const {
+		*slabHitCnt = entitySlab.slabHitCnt;
+		*slabAllocCnt = entitySlab.slabAllocCnt;
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			*slabHitCnt += hostShards[i].chunkSlab.slabHitCnt + deviceShards[i].chunkSlab.slabHitCnt;
+			*slabAllocCnt += hostShards[i].chunkSlab.slabAllocCnt + deviceShards[i].chunkSlab.slabAllocCnt;
+		}
+	}
+
+	void resetSlabCnt() {
+		entitySlab.slabHitCnt = 0;
+		entitySlab.slabAllocCnt = 0;
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			hostShards[i].chunkSlab.slabHitCnt = 0;
+			hostShards[i].chunkSlab.slabAllocCnt = 0;
+			deviceShards[i].chunkSlab.slabHitCnt = 0;
+			deviceShards[i].chunkSlab.slabAllocCnt = 0;
+		}
+	}
 #endif
 
-//[DEBUG on June 18, 2021] Fake type used for CUDA/HIP texture object.
-typedef unsigned long long HI_texObject_t;
+	//Delete all entries and return the slab memory to the system.
+	//This must not be called while other threads access the table.
+	void clear() {
+		for( int i = 0; i < SHARED_PRESENT_TABLE_NUM_SHARDS; i++ ) {
+			hostShards[i].lock();
+			hostShards[i].index.clear();
+			hostShards[i].chunkSlab.release();
+			hostShards[i].unlock();
+			deviceShards[i].lock();
+			deviceShards[i].index.clear();
+			deviceShards[i].chunkSlab.release();
+			deviceShards[i].unlock();
+		}
+		entityLock.lock();
+		entitySlab.release();
+		entityLock.unlock();
+		__atomic_store_n(&numEntries, 0, __ATOMIC_RELAXED);
+	}
+} sharedpresenttable_t;
+#endif
+typedef std::map<int, presenttable_t *> addresstablemap_t;
+
+//Per-thread device memory pool, which keeps device memory released by 
+//HI_free()/HI_tempFree() for reuse by later allocations.
+//Memory obtained from the device (a chunk) is handed out as blocks:
+//- A request is rounded up to its size class; up to MEMPOOL_SMALL_BLOCK_SIZE,
+//  classes are spaced an eighth of a power of two apart, and above it, by 
+//  MEMPOOL_MIN_BLOCK_SIZE. New chunks are allocated at the rounded size.
+//  Without size classes (sizeClasses = false), requests are not rounded, 
+//  for drivers whose device memory must match the request size exactly.
+//- A request is served by the smallest free block that fits (best fit).
+//  The whole block is used if the unused part is within fragLimit percent 
+//  of the rounded size; otherwise, the block is split if the driver can 
+//  address the interior of a chunk (splitAlignment > 0).
+//- A released block is coalesced with its free neighbors in the same chunk.
+//Only chunks that are entirely free are returned to the device, by the 
+//driver through popFreeChunk(), which evicts the least recently freed chunk 
+//first; drivers evict only as many chunks as needed to stay within the 
+//pool budget or to satisfy a failed device allocation.
+#define MEMPOOL_MIN_BLOCK_SIZE 256
+#define MEMPOOL_SMALL_BLOCK_SIZE (1 << 20)
+#define MEMPOOL_DEFAULT_FRAG_LIMIT 25
+
+typedef struct _mempoolblock_t {
+	char *chunk;
+	size_t size;
+	size_t requested;
+	bool inUse;
+} mempoolblock_t;
+
+typedef struct _mempoolchunk_t {
+	size_t size;
+	//Position in the LRU list of entirely free chunks (0 if not free).
+	unsigned long lruTick;
+} mempoolchunk_t;
+
+typedef class DeviceMemoryPool
+{
+private:
+	//All blocks, ordered by address.
+	std::map<char *, mempoolblock_t> blockMap;
+	//Free blocks, ordered by size.
+	std::multimap<size_t, char *> freeBlockMap;
+	//Chunks allocated from the device, ordered by address.
+	std::map<char *, mempoolchunk_t> chunkMap;
+	//Entirely free chunks, from the least recently freed one.
+	std::map<unsigned long, char *> freeChunkLRU;
+	size_t fragLimit;
+	size_t splitAlignment;
+	bool sizeClasses;
+	unsigned long lruClock;
+	size_t freeBytes;
+	size_t reservedBytes;
+	size_t internalFragBytes;
+
+	void eraseFreeBlock(char *ptr, size_t size) {
+		std::pair<std::multimap<size_t, char *>::iterator, std::multimap<size_t, char *>::iterator> range = freeBlockMap.equal_range(size);
+		for( std::multimap<size_t, char *>::iterator it = range.first; it != range.second; ++it ) {
+			if( it->second == ptr ) {
+				freeBlockMap.erase(it);
+				return;
+			}
+		}
+	}
 
-typedef enum {
-    HI_success = 0,
-    HI_error = 1
-} HI_error_t;
+public:
+#ifdef _OPENARC_PROFILE_
+	long hitCnt;
+	long missCnt;
+	size_t peakReservedBytes;
+	long evictCnt;
+	size_t evictBytes;
+#endif
 
-typedef enum {
-    HI_MemcpyHostToHost = 0,
-    HI_MemcpyHostToDevice = 1,
-    HI_MemcpyDeviceToHost = 2,
-    HI_MemcpyDeviceToDevice = 3
-} HI_MemcpyKind_t;
+	DeviceMemoryPool(size_t _fragLimit = MEMPOOL_DEFAULT_FRAG_LIMIT, size_t _splitAlignment = 0, bool _sizeClasses = true) : fragLimit(_fragLimit), 
+		splitAlignment(_splitAlignment), sizeClasses(_sizeClasses), lruClock(0), freeBytes(0), reservedBytes(0), internalFragBytes(0) {
+#ifdef _OPENARC_PROFILE_
+		resetStats();
+#endif
+	}
 
-typedef enum {
-    HI_MEM_READ_WRITE = 1,
-    HI_MEM_READ_ONLY = 2,
-    HI_MEM_WRITE_ONLY = 4,
-} HI_MallocKind_t;
+	//Return the size to allocate from the device for a count-byte request.
+	size_t getAllocSize(size_t count) const {
+		if( !sizeClasses ) {
+			return count;
+		}
+		size_t size = (count < MEMPOOL_MIN_BLOCK_SIZE) ? MEMPOOL_MIN_BLOCK_SIZE : count;
+		size_t step = MEMPOOL_MIN_BLOCK_SIZE;
+		if( size <= MEMPOOL_SMALL_BLOCK_SIZE ) {
+			size_t pow2 = MEMPOOL_MIN_BLOCK_SIZE;
+			while( pow2 < size ) {
+				pow2 <<= 1;
+			}
+			step = (pow2 >> 3 > step) ? pow2 >> 3 : step;
+		}
+		if( splitAlignment > step ) {
+			step = splitAlignment;
+		}
+		return ((size + step - 1) / step) * step;
+	}
 
-typedef enum {
-    HI_notstale = 0,
-    HI_stale = 1,
-    HI_maystale = 2
-} HI_memstatus_t;
+	//Find a free block for a count-byte request; if found, mark it in use, 
+	//and return its address and size (the number of bytes taken from the pool).
+	bool allocate(size_t count, void **devPtr, size_t *blockSize) {
+		size_t size = getAllocSize(count);
+		std::multimap<size_t, char *>::iterator it = freeBlockMap.lower_bound(size);
+		if( it == freeBlockMap.end() ) {
+#ifdef _OPENARC_PROFILE_
+			missCnt++;
+#endif
+			return false;
+		}
+		char *ptr = it->second;
+		size_t bSize = it->first;
+		mempoolblock_t &block = blockMap[ptr];
+		bool wholeChunk = (block.chunk == ptr) && (chunkMap[ptr].size == bSize);
+		if( (bSize - size) * 100 > size * fragLimit ) {
+			if( splitAlignment == 0 ) {
+#ifdef _OPENARC_PROFILE_
+				missCnt++;
+#endif
+				return false;
+			}
+			//Keep the remainder in the pool.
+			mempoolblock_t remainder = {block.chunk, bSize - size, 0, false};
+			blockMap[ptr + size] = remainder;
+			freeBlockMap.insert(std::pair<size_t, char *>(bSize - size, ptr + size));
+			bSize = size;
+			block.size = size;
+		}
+		freeBlockMap.erase(it);
+		if( wholeChunk ) {
+			mempoolchunk_t &chunk = chunkMap[ptr];
+			freeChunkLRU.erase(chunk.lruTick);
+			chunk.lruTick = 0;
+		}
+		block.requested = count;
+		block.inUse = true;
+		freeBytes -= bSize;
+		internalFragBytes += bSize - count;
+#ifdef _OPENARC_PROFILE_
+		hitCnt++;
+#endif
+		*devPtr = (void *)ptr;
+		if( blockSize ) *blockSize = bSize;
+		return true;
+	}
 
-typedef enum {
-    HI_int = 0,
-    HI_float = 1,
-} HI_datatype_t;
+	//Register a chunk of size bytes newly allocated from the device for a 
+	//count-byte request; the whole chunk is in use.
+	void addChunk(void *devPtr, size_t size, size_t count) {
+		char *ptr = (char *)devPtr;
+		mempoolblock_t block = {ptr, size, count, true};
+		blockMap[ptr] = block;
+		mempoolchunk_t chunk = {size, 0};
+		chunkMap[ptr] = chunk;
+		reservedBytes += size;
+		internalFragBytes += size - count;
+#ifdef _OPENARC_PROFILE_
+		if( peakReservedBytes < reservedBytes ) {
+			peakReservedBytes = reservedBytes;
+		}
+#endif
+	}
 
-typedef struct _HI_device_mem_handle_t {
-    MEM_HANDLE_TYPE memHandle;
-    size_t offset;
-} HI_device_mem_handle_t;
+	//Return a block to the pool, and return its size (the number of bytes 
+	//added to the pool). A block unknown to the pool is adopted as a chunk 
+	//of count bytes.
+	size_t release(void *devPtr, size_t count) {
+		char *ptr = (char *)devPtr;
+		std::map<char *, mempoolblock_t>::iterator it = blockMap.find(ptr);
+		if( it == blockMap.end() ) {
+			addChunk(devPtr, count, count);
+			it = blockMap.find(ptr);
+		}
+		if( !it->second.inUse ) {
+			return 0;
+		}
+		size_t size = it->second.size;
+		char *chunk = it->second.chunk;
+		it->second.inUse = false;
+		internalFragBytes -= size - it->second.requested;
+		it->second.requested = 0;
+		freeBytes += size;
+		std::map<char *, mempoolblock_t>::iterator next = it;
+		++next;
+		if( (next != blockMap.end()) && !next->second.inUse && (next->second.chunk == chunk) && (it->first + it->second.size == next->first) ) {
+			eraseFreeBlock(next->first, next->second.size);
+			it->second.size += next->second.size;
+			blockMap.erase(next);
+		}
+		if( it != blockMap.begin() ) {
+			std::map<char *, mempoolblock_t>::iterator prev = it;
+			--prev;
+			if( !prev->second.inUse && (prev->second.chunk == chunk) && (prev->first + prev->second.size == it->first) ) {
+				eraseFreeBlock(prev->first, prev->second.size);
+				prev->second.size += it->second.size;
+				blockMap.erase(it);
+				it = prev;
+			}
+		}
+		freeBlockMap.insert(std::pair<size_t, char *>(it->second.size, it->first));
+		if( it->first == chunk ) {
+			mempoolchunk_t &chunkInfo = chunkMap[chunk];
+			if( chunkInfo.size == it->second.size ) {
+				chunkInfo.lruTick = ++lruClock;
+				freeChunkLRU[chunkInfo.lruTick] = chunk;
+			}
+		}
+		return size;
+	}
 
-typedef struct _memhandletable_entity_t {
-    MEM_HANDLE_TYPE memHandle;
-    size_t size;
-    _memhandletable_entity_t(MEM_HANDLE_TYPE _memHandle, size_t _size) : memHandle(_memHandle), size(_size) {}
-} memhandletable_entity_t;
+	//Remove the least recently freed chunk among entirely free ones from 
+	//the pool so that the caller can return it to the device; return false 
+	//if there is no such chunk.
+	bool popFreeChunk(void **devPtr, size_t *size) {
+		if( freeChunkLRU.empty() ) {
+			return false;
+		}
+		std::map<unsigned long, char *>::iterator lit = freeChunkLRU.begin();
+		char *ptr = lit->second;
+		size_t cSize = chunkMap[ptr].size;
+		freeChunkLRU.erase(lit);
+		eraseFreeBlock(ptr, cSize);
+		blockMap.erase(ptr);
+		chunkMap.erase(ptr);
+		freeBytes -= cSize;
+		reservedBytes -= cSize;
+#ifdef _OPENARC_PROFILE_
+		evictCnt++;
+		evictBytes += cSize;
+#endif
+		*devPtr = (void *)ptr;
+		*size = cSize;
+		return true;
+	}
 
-typedef struct _addresstable_entity_t {
-    void* basePtr;
-    size_t size;
-    _addresstable_entity_t(void* _basePtr, size_t _size) : basePtr(_basePtr), size(_size) {}
-} addresstable_entity_t;
+	//Forget all blocks without returning them to the device.
+	void clear() {
+		blockMap.clear();
+		freeBlockMap.clear();
+		chunkMap.clear();
+		freeChunkLRU.clear();
+		freeBytes = 0;
+		reservedBytes = 0;
+		internalFragBytes = 0;
+	}
 
-typedef std::map<const void *, memhandletable_entity_t *> memhandlemap_t;
-typedef std::map<int, memhandlemap_t *> memhandletable_t;
-typedef std::map<const void *, void *> addressmap_t;
-typedef std::map<int, addressmap_t *> addresstable_t;
-typedef std::multimap<int, const void *> asyncfreetable_t;
-typedef std::map<int, asyncfreetable_t *> asyncfreetablemap_t;
-//[DEBUG on April 15, 2021] multipmap value type is changed from void ** to void *
-typedef std::multimap<int, void *> asynctempfreetable_t;
-typedef std::map<int, asynctempfreetable_t *> asynctempfreetablemap_t;
-typedef std::multimap<int, acc_device_t> asynctempfreetable2_t;
-typedef std::map<int, asynctempfreetable2_t *> asynctempfreetablemap2_t;
-typedef std::set<const void *> pointerset_t;
-typedef std::map<int, addresstable_t *> addresstablemap_t;
-typedef std::multimap<size_t, void *> memPool_t;
-typedef std::map<const void *, size_t> sizemap_t;
+	bool empty() const {
+		return freeBlockMap.empty();
+	}
+
+	//Number of free blocks.
+	size_t size() const {
+		return freeBlockMap.size();
+	}
+
+	void getFreeBlocks(std::vector<void *> &blocks) const {
+		for( std::multimap<size_t, char *>::const_iterator it = freeBlockMap.begin(); it != freeBlockMap.end(); ++it ) {
+			blocks.push_back((void *)it->second);
+		}
+	}
+
+	//Bytes in free blocks.
+	size_t getFreeBytes() const {
+		return freeBytes;
+	}
+
+	//Bytes in chunks allocated from the device.
+	size_t getReservedBytes() const {
+		return reservedBytes;
+	}
+
+	//Bytes in use blocks beyond the requested sizes.
+	size_t getInternalFragBytes() const {
+		return internalFragBytes;
+	}
+
+	//Bytes in free blocks that cannot be returned to the device, since 
+	//other parts of their chunks are in use.
+	size_t getExternalFragBytes() const {
+		size_t bytes = 0;
+		for( std::multimap<size_t, char *>::const_iterator it = freeBlockMap.begin(); it != freeBlockMap.end(); ++it ) {
+			std::map<char *, mempoolchunk_t>::const_iterator cit = chunkMap.find(it->second);
+			if( (cit == chunkMap.end()) || (cit->second.size != it->first) ) {
+				bytes += it->first;
+			}
+		}
+		return bytes;
+	}
+
+#ifdef _OPENARC_PROFILE_
+	void resetStats() {
+		hitCnt = 0;
+		missCnt = 0;
+		peakReservedBytes = reservedBytes;
+		evictCnt = 0;
+		evictBytes = 0;
+	}
+#endif
+} devicememorypool_t;
+typedef devicememorypool_t memPool_t;
 typedef std::map<int, memPool_t *> memPoolmap_t;
-typedef std::map<int, sizemap_t *> memPoolSizemap_t;
-typedef std::map<void *, int> countermap_t;
-typedef std::map<int, addressmap_t *> asyncphostmap_t;
-typedef std::map<int, sizemap_t *> asynchostsizemap_t;
-typedef std::map<const void *, HI_memstatus_t> memstatusmap_t;
+
+//Victim cache for VICTIM_CACHE_MODE = 2, which keeps freed device memory 
+//(and its pinned host memory if prepinned) for reuse when the same host 
+//memory is mapped again on the same async queue.
+//- The cache is split into VICTIM_CACHE_NUM_SHARDS shards by host thread,
+//  each protected by its own lock.
+//- Entries of a shard are kept in LRU order; the driver evicts the least 
+//  recently cached entries (popLRUEntry()) to keep each shard within the 
+//  device memory pool budget (max_mempool_size) or to satisfy a failed 
+//  device allocation.
+//- If the host memory is not prepinned, a miss can also be served by the 
+//  smallest entry of another host pointer that fits the request, if its 
+//  unused part is within fragLimit percent of the request (size-compatible
+//  reuse). Such a buffer is larger than the request; its allocation size
+//  is kept in allocSizeMap while it is mapped, so that the cache and its 
+//  budget are charged with the true size when it is cached again.
+#define VICTIM_CACHE_NUM_SHARDS 16
+
+typedef struct _victimcache_entry_t {
+	const void *hostPtr;
+	void *devPtr;
+	size_t size;
+	int asyncID;
+	unsigned long lruTick;
+} victimcache_entry_t;
+
+typedef class VictimCacheShard
+{
+public:
+	presenttablelock_t shardLock;
+	//Entries keyed by (async ID, host pointer), by size, and by LRU tick.
+	std::multimap<std::pair<int, const void *>, victimcache_entry_t *> hostIndex;
+	std::set<std::pair<size_t, victimcache_entry_t *> > sizeIndex;
+	std::map<unsigned long, victimcache_entry_t *> lruList;
+	unsigned long lruClock;
+	size_t cachedBytes;
+	//Allocation sizes of mapped buffers that are larger than their mapping,
+	//keyed by device pointer.
+	sizemap_t allocSizeMap;
 #ifdef _OPENARC_PROFILE_
-typedef std::map<int, long> presenttablecnt_t;
+	//Number of requests served by an entry of the same host pointer.
+	long hitCnt;
+	//Number of requests served by an entry of another host pointer.
+	long sizeHitCnt;
+	long missCnt;
+	long evictCnt;
+	size_t evictBytes;
+#endif
+
+	VictimCacheShard() : lruClock(0), cachedBytes(0) {
+#ifdef _OPENARC_PROFILE_
+		resetStats();
+#endif
+	}
+	~VictimCacheShard() {
+		clear();
+	}
+
+	//Remove the entry from all indexes, and return it to the caller.
+	//Called with the shard lock held.
+	void unlink(victimcache_entry_t *entry) {
+		std::pair<std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator, std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator> range = hostIndex.equal_range(std::make_pair(entry->asyncID, entry->hostPtr));
+		for( std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator it = range.first; it != range.second; ++it ) {
+			if( it->second == entry ) {
+				hostIndex.erase(it);
+				break;
+			}
+		}
+		sizeIndex.erase(std::make_pair(entry->size, entry));
+		lruList.erase(entry->lruTick);
+		cachedBytes -= entry->size;
+	}
+
+	//Find an entry of hostPtr on asyncID (or on defaultAsyncID) that is 
+	//large enough for size bytes; called with the shard lock held.
+	victimcache_entry_t * findHostEntry(const void *hostPtr, size_t size, int asyncID, int defaultAsyncID) {
+		int asyncIDs[2] = {asyncID, defaultAsyncID};
+		for( int i = 0; i < 2; i++ ) {
+			if( (i == 1) && (defaultAsyncID == asyncID) ) {
+				break;
+			}
+			std::pair<std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator, std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator> range = hostIndex.equal_range(std::make_pair(asyncIDs[i], hostPtr));
+			for( std::multimap<std::pair<int, const void *>, victimcache_entry_t *>::iterator it = range.first; it != range.second; ++it ) {
+				if( it->second->size >= size ) {
+					return it->second;
+				}
+			}
+		}
+		return NULL;
+	}
+
+	//Remove a cached device buffer for the request, and return it and its 
+	//allocation size through devPtr and allocSize; return false if no entry
+	//can serve the request.
+	bool take(const void *hostPtr, size_t size, int asyncID, int defaultAsyncID, bool sizeReuse, int fragLimit, void **devPtr, size_t *allocSize) {
+		bool found = false;
+		shardLock.lock();
+		victimcache_entry_t *entry = findHostEntry(hostPtr, size, asyncID, defaultAsyncID);
+		if( entry != NULL ) {
+#ifdef _OPENARC_PROFILE_
+			hitCnt++;
+#endif
+		} else if( sizeReuse ) {
+			std::set<std::pair<size_t, victimcache_entry_t *> >::iterator it = sizeIndex.lower_bound(std::make_pair(size, (victimcache_entry_t *)NULL));
+			if( (it != sizeIndex.end()) && ((it->first - size) * 100 <= size * (size_t)fragLimit) ) {
+				entry = it->second;
+#ifdef _OPENARC_PROFILE_
+				sizeHitCnt++;
 #endif
+			}
+		}
+		if( entry != NULL ) {
+			unlink(entry);
+			*devPtr = entry->devPtr;
+			*allocSize = entry->size;
+			delete entry;
+			found = true;
+#ifdef _OPENARC_PROFILE_
+		} else {
+			missCnt++;
+#endif
+		}
+		shardLock.unlock();
+		return found;
+	}
+
+	//Cache devPtr, whose allocation size is size bytes.
+	void put(const void *hostPtr, void *devPtr, size_t size, int asyncID) {
+		shardLock.lock();
+		victimcache_entry_t *entry = new victimcache_entry_t;
+		entry->hostPtr = hostPtr;
+		entry->devPtr = devPtr;
+		entry->size = size;
+		entry->asyncID = asyncID;
+		entry->lruTick = lruClock++;
+		hostIndex.insert(std::make_pair(std::make_pair(asyncID, hostPtr), entry));
+		sizeIndex.insert(std::make_pair(size, entry));
+		lruList[entry->lruTick] = entry;
+		cachedBytes += size;
+		shardLock.unlock();
+	}
+
+	//Remove the least recently cached entry and copy it to *entry; return 
+	//false if the shard is empty.
+	bool popLRUEntry(victimcache_entry_t *entry) {
+		bool found = false;
+		shardLock.lock();
+		if( !lruList.empty() ) {
+			victimcache_entry_t *lruEntry = lruList.begin()->second;
+			unlink(lruEntry);
+			*entry = *lruEntry;
+			delete lruEntry;
+			found = true;
+#ifdef _OPENARC_PROFILE_
+			evictCnt++;
+			evictBytes += entry->size;
+#endif
+		}
+		shardLock.unlock();
+		return found;
+	}
+
+	size_t getCachedBytes() {
+		return __atomic_load_n(&cachedBytes, __ATOMIC_RELAXED);
+	}
+
+	void setAllocSize(const void *devPtr, size_t allocSize) {
+		shardLock.lock();
+		allocSizeMap[devPtr] = allocSize;
+		shardLock.unlock();
+	}
+
+	void clearAllocSizes() {
+		shardLock.lock();
+		allocSizeMap.clear();
+		shardLock.unlock();
+	}
+
+	//Remove the allocation size recorded for devPtr and return it; return 
+	//size if none is recorded.
+	size_t removeAllocSize(const void *devPtr, size_t size) {
+		shardLock.lock();
+		if( !allocSizeMap.empty() ) {
+			sizemap_t::iterator it = allocSizeMap.find(devPtr);
+			if( it != allocSizeMap.end() ) {
+				size = it->second;
+				allocSizeMap.erase(it);
+			}
+		}
+		shardLock.unlock();
+		return size;
+	}
+
+	//Drop all entries without releasing their memory.
+	void clear() {
+		shardLock.lock();
+		for( std::map<unsigned long, victimcache_entry_t *>::iterator it = lruList.begin(); it != lruList.end(); ++it ) {
+			delete it->second;
+		}
+		hostIndex.clear();
+		sizeIndex.clear();
+		lruList.clear();
+		allocSizeMap.clear();
+		cachedBytes = 0;
+		shardLock.unlock();
+	}
+
+#ifdef _OPENARC_PROFILE_
+	void resetStats() {
+		hitCnt = 0;
+		sizeHitCnt = 0;
+		missCnt = 0;
+		evictCnt = 0;
+		evictBytes = 0;
+	}
+#endif
+} victimcacheshard_t;
 
 extern int HI_openarcrt_verbosity;
 extern int HI_openarcrt_memoryalignment;
+extern int HI_mempool_frag_limit;
 extern int HI_hostinit_done;
 extern int HI_num_hostthreads;
 
@@ -220,9 +2044,15 @@ public:
 	//Output kernel file name base. (Default value: "openarc_kernel")
 	std::string fileNameBase;
 
-    //Host-device address mapping table, augmented with stream id
+    //Host-device address mapping table (present table) per host thread, 
+    //augmented with stream id
     //addresstable_t masterAddressTable;
 	addresstablemap_t masterAddressTableMap;
+#ifdef _USE_SHARED_PRESENT_TABLE
+	//Present table shared by all host threads, which is used instead of 
+	//masterAddressTableMap.
+	sharedpresenttable_t sharedPresentTable;
+#endif
 
 	//device-address-to-memory-handle mapping table, which is needed
 	//for OpenCL backend and IRIS backend only.
@@ -230,8 +2060,9 @@ public:
 	//which should be translated to actual cl_mem handle.
 	memhandletable_t masterHandleTable;
 
-    //Auxiliary Host-device address mapping table used as a victim cache. 
-    addresstable_t auxAddressTable;
+    //Victim cache of freed device memory (VICTIM_CACHE_MODE = 2), 
+    //sharded by host thread.
+    victimcacheshard_t victimCacheShards[VICTIM_CACHE_NUM_SHARDS];
 
 	//temporarily allocated memory set.
 	pointerset_t tempMallocSet;
@@ -246,6 +2077,7 @@ public:
 	asyncfreetablemap_t postponedFreeTableMap;
 	asynctempfreetablemap_t postponedTempFreeTableMap;
 	asynctempfreetablemap2_t postponedTempFreeTableMap2;
+	postponedfreeinfomap_t postponedFreeInfoMap;
 	//memPool_t memPool;
 	memPoolmap_t memPoolMap;
 #if defined(OPENARC_ARCH) && OPENARC_ARCH == 6
@@ -265,9 +2097,10 @@ public:
 
     // Kernel Execution
     virtual HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID) = 0;
-    virtual HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID) = 0;
-    virtual HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID) = 0;
-    virtual HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID) = 0;
+    //Kernels are identified by the integer IDs returned by HI_get_kernel_id().
+    virtual HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID) = 0;
+    virtual HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID) = 0;
+    virtual HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID) = 0;
     virtual HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID )=0;
     void updateKernelNameSet(std::set<std::string>kernelNames) {
     	for (std::set<std::string>::iterator it = kernelNames.begin() ; it != kernelNames.end(); ++it) {
@@ -325,6 +2158,17 @@ public:
     virtual HI_error_t HI_present_or_memcpy_const(void *hostPtr, std::string constName, HI_MemcpyKind_t kind, size_t count, int threadID=NO_THREAD_ID) {
         return HI_success;
     }
+    //3D copies are currently supported only by the OpenCL driver.
+    virtual HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID) {
+        fprintf(stderr, "[ERROR in Accelerator::HI_memcpy3D()] Not supported in the current device type; exit!\n");
+        exit(1);
+        return HI_error;
+    }
+    virtual HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int async, int num_waits, int *waits, int threadID=NO_THREAD_ID) {
+        fprintf(stderr, "[ERROR in Accelerator::HI_memcpy3D_async()] Not supported in the current device type; exit!\n");
+        exit(1);
+        return HI_error;
+    }
     virtual void HI_set_async(int asyncId, int threadID=NO_THREAD_ID)=0;
     virtual void HI_set_context(int threadID=NO_THREAD_ID){}
     virtual void HI_wait(int arg, int threadID=NO_THREAD_ID) {}
@@ -339,6 +2183,12 @@ public:
     virtual int HI_async_test_ifpresent(int asyncId, int threadID=NO_THREAD_ID)=0;
     virtual int HI_async_test_all(int threadID=NO_THREAD_ID)=0;
     virtual void HI_wait_for_events(int async, int num_waits, int* waits, int threadID=NO_THREAD_ID)=0;
+    //Called after a postponed free is added for the async queue; a backend 
+    //may reclaim the postponed frees added so far as soon as the commands 
+    //enqueued on the queue complete, instead of at the next synchronization.
+    virtual void HI_schedule_postponed_free(int asyncID, int threadID=NO_THREAD_ID) {}
+    //Reclaim the postponed frees that such a backend found to be completed.
+    virtual void HI_reclaim_completed_frees(int threadID=NO_THREAD_ID) {}
 
     virtual void HI_malloc(void **devPtr, size_t size, HI_MallocKind_t flags, int threadID=NO_THREAD_ID) = 0;
     virtual void HI_free(void *devPtr, int threadID=NO_THREAD_ID) = 0;
@@ -346,6 +2196,14 @@ public:
 	virtual void HI_enter_subregion(const char *label, int mode=0, int threadID=NO_THREAD_ID) {}
 	virtual void HI_exit_subregion(const char *label, int mode=0, int threadID=NO_THREAD_ID) {}
 
+#ifdef _OPENARC_PROFILE_
+	void HI_inc_present_table_cnt(int tid) {
+    	if( HI_openarcrt_verbosity > 1 ) {
+			presentTableCntMap[tid]++;
+		}
+	}
+#endif
+
     HI_error_t HI_get_device_address(const void *hostPtr, void **devPtr, int asyncID, int tid) {
 		size_t offset;
 		HI_error_t result = HI_get_device_address(hostPtr, devPtr, &offset, NULL, asyncID, tid);
@@ -363,357 +2221,154 @@ public:
     }
 
     HI_error_t HI_get_device_address(const void *hostPtr, void **devPtrBase, size_t *offset, size_t *size, int asyncID, int tid) {
-		bool returnReady = false;
 		HI_error_t returnValue = HI_error;
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
 #endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\t\tenter Accelerator::HI_get_device_address(hostPtr = %lx, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, tid, org_tid);
 		}
 #endif
-		bool emptyTable1 = false;
-#if PRESENT_TABLE_SEARCH_MODE == 0
-		bool emptyTable2 = false;
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
         int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
-		addresstable_t::iterator it = masterAddressTable->find(asyncID);
-        if(it == masterAddressTable->end() ) {
-            addressmap_t* emptyMap = new addressmap_t();
-            masterAddressTable->insert(std::pair<int, addressmap_t *> (asyncID, emptyMap));
-			it = masterAddressTable->find(asyncID);
-			emptyTable1 = true;
-		}
-		addressmap_t *tAddressMap = it->second;
-#if PRESENT_TABLE_SEARCH_MODE == 0
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->find(hostPtr);
+		addresstable_entity_t aet(NULL, 0);
+		size_t tOffset = 0;
+		bool found = false;
+#ifndef _USE_SHARED_PRESENT_TABLE
+		//Check the recently looked-up mappings first.
+		found = presentTable->lookupCache.lookup(hostPtr, asyncID, &aet, &tOffset);
+		if( !found ) {
+		int foundAsyncID = asyncID;
+#endif
+		//Check the range on the asyncID queue first, and then on the default queue.
+		found = presentTable->find(hostPtr, asyncID, &aet, &tOffset);
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
+		HI_inc_present_table_cnt(org_tid);
 #endif
-        if(it2 != tAddressMap->end() ) {
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            *devPtrBase = aet->basePtr;
-			if( size ) *size = aet->size;
-			if( offset ) *offset = 0;
-            //return  HI_success;
-			returnReady = true;
-			returnValue = HI_success;
-        } else {
-            //check on the default stream
-			if( defaultAsyncID != asyncID ) {
-            	it = masterAddressTable->find(defaultAsyncID);
-        		if(it == masterAddressTable->end() ) {
-            		addressmap_t *emptyMap = new addressmap_t();
-            		masterAddressTable->insert(std::pair<int, addressmap_t*> (defaultAsyncID, emptyMap));
-					//it = masterAddressTable->find(asyncID);
-					emptyTable2 = true;
-				} else {
-					tAddressMap = it->second;
-            		it2 =	tAddressMap->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-    				if( HI_openarcrt_verbosity > 1 ) {
-						ptit->second++;
-    				}    
-#endif
-            		if(it2 != tAddressMap->end() ) {
-            			addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            			*devPtrBase = aet->basePtr;
-						if( size ) *size = aet->size;
-						if( offset ) *offset = 0;
-            			//return  HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-            		}
-				}
-			} else {
-				emptyTable2 = emptyTable1;
-			}
-		}
-
-		if( !returnReady && emptyTable1 && emptyTable2 ) {
-			*devPtrBase = NULL;
-			if( size ) *size = 0;
-			if( offset ) *offset = 0;
-			//return HI_error;
-			returnReady = true;
-			returnValue = HI_error;
-		} 
-
-		if( !returnReady ) {
-			//Check whether hostPtr is within the range of an allocated memory region 
-			//in the addressTable.
-			it = masterAddressTable->find(asyncID);
-			tAddressMap = it->second;
-			for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-            	const void* aet_host = it2->first;
-#ifdef _OPENARC_PROFILE_
-    			if( HI_openarcrt_verbosity > 1 ) {
-					ptit->second++;
-    			}    
-#endif
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                	*devPtrBase = aet->basePtr;
-					if( size ) *size = aet->size;
-                	if (offset) *offset = (size_t) hostPtr - (size_t) aet_host;
-                	//return  HI_success;
-					returnReady = true;
-					returnValue = HI_success;
-					break;
-            	}
-        	}
-		}
-
-		if( !returnReady ) {
-        	//check on the default stream
-			if( defaultAsyncID != asyncID ) {
-        		it = masterAddressTable->find(DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD);
-				tAddressMap = it->second;
-        		for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-            		const void* aet_host = it2->first;
-#ifdef _OPENARC_PROFILE_
-    				if( HI_openarcrt_verbosity > 1 ) {
-						ptit->second++;
-    				}    
-#endif
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            		if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                		*devPtrBase = aet->basePtr;
-						if( size ) *size = aet->size;
-                		if (offset) *offset = (size_t) hostPtr - (size_t) aet_host;
-                		//return  HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-						break;
-            		}
-				}
-			}
-		}
-#else
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
+		if( !found && (asyncID != defaultAsyncID) ) {
+#ifndef _USE_SHARED_PRESENT_TABLE
+			foundAsyncID = defaultAsyncID;
+#endif
+			found = presentTable->find(hostPtr, defaultAsyncID, &aet, &tOffset);
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
+			HI_inc_present_table_cnt(org_tid);
 #endif
-        if(it2 != tAddressMap->end() ) {
-			if( it2->first == hostPtr ) {
-				//found the entry matching the key, hostPtr.
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	*devPtrBase = aet->basePtr;
-				if( size ) *size = aet->size;
-				if( offset ) *offset = 0;
-				//return HI_success;
-				returnReady = true;
-				returnValue = HI_success;
-			} else {
-				//hostPtr may belong to an entry before the current one.
-				if( it2 == tAddressMap->begin() ) {
-					//There is no entry before the current one.
-					//return NULL; //Do not return here; check the default stream.
-				} else {
-					--it2; 
-            		const void* aet_hostPtr = it2->first;
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            		if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-                		*devPtrBase = aet->basePtr;
-						if( size ) *size = aet->size;
-                		if (offset) *offset = (size_t) hostPtr - (size_t) aet_hostPtr;
-                		//return  HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-            		}
-				}
-			}
-		} else if( !tAddressMap->empty() ) {
-			//hostPtr may belong to the last entry.
-        	addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            const void* aet_hostPtr = it3->first;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-                *devPtrBase = aet->basePtr;
-				if( size ) *size = aet->size;
-                if (offset) *offset = (size_t) hostPtr - (size_t) aet_hostPtr;
-                //return  HI_success;
-				returnReady = true;
-				returnValue = HI_success;
-            }
 		}
-
-		if( !returnReady ) {
-			if( asyncID != defaultAsyncID ) {
-        		//check on the default stream
-        		it = masterAddressTable->find(defaultAsyncID);
-        		if(it == masterAddressTable->end() ) {
-            		addressmap_t* emptyMap = new addressmap_t();
-            		masterAddressTable->insert(std::pair<int, addressmap_t *> (defaultAsyncID, emptyMap));
-					it = masterAddressTable->find(defaultAsyncID);
-				}
-				tAddressMap = it->second;
-        		addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
-#ifdef _OPENARC_PROFILE_
-    			if( HI_openarcrt_verbosity > 1 ) {
-					ptit->second++;
-    			}    
-#endif
-        		if(it2 != tAddressMap->end() ) {
-					if( it2->first == hostPtr ) {
-						//found the entry matching the key, hostPtr.
-            			addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            			*devPtrBase = aet->basePtr;
-						if( size ) *size = aet->size;
-						if( offset ) *offset = 0;
-						//return HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-					} else {
-						//hostPtr may belong to an entry before the current one.
-						if( it2 == tAddressMap->begin() ) {
-							//There is no entry before the current one.
-							*devPtrBase = NULL;
-							if( size ) *size = 0;
-							if( offset ) *offset = 0;
-        					//return HI_error;
-							returnReady = true;
-							returnValue = HI_error;
-						} else {
-							--it2; 
-            				const void* aet_hostPtr = it2->first;
-            				addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            				if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-                				*devPtrBase = aet->basePtr;
-								if( size ) *size = aet->size;
-                				if (offset) *offset = (size_t) hostPtr - (size_t) aet_hostPtr;
-                				//return  HI_success;
-								returnReady = true;
-								returnValue = HI_success;
-            				}
-						}
-					}
-				} else if( !tAddressMap->empty() ) {
-					//hostPtr may belong to the last entry.
-        			addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            		const void* aet_hostPtr = it3->first;
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            		if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-                		*devPtrBase = aet->basePtr;
-						if( size ) *size = aet->size;
-                		if (offset) *offset = (size_t) hostPtr - (size_t) aet_hostPtr;
-                		//return  HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-            		}
-				}
-			}
+#ifndef _USE_SHARED_PRESENT_TABLE
+		if( found ) {
+			presentTable->lookupCache.add(hostPtr, asyncID, foundAsyncID, aet);
+		}
 		}
 #endif
-		
-		if( !returnReady ) {
+		if( found ) {
+            *devPtrBase = aet.basePtr;
+			if( size ) *size = aet.size;
+			if( offset ) *offset = tOffset;
+			returnValue = HI_success;
+		} else {
         	//fprintf(stderr, "[ERROR in get_device_address()] No mapping found for the host pointer\n");
 			*devPtrBase = NULL;
 			if( size ) *size = 0;
 			if( offset ) *offset = 0;
-			returnReady = true;
 			returnValue = HI_error;
 		}
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\t\texit Accelerator::HI_get_device_address(hostPtr = %lx, devicePtrBase = %lx, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, (unsigned long)(*devPtrBase), tid, org_tid);
 		}
-#endif
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-		}
-#endif
-#endif
 #endif
         return returnValue;
     }
 
-    HI_error_t HI_set_device_address(const void *hostPtr, void * devPtr, size_t size, int asyncID, int tid) {
+	//Find the device address of hostPtr as HI_get_device_address() does, and 
+	//increment or decrement the present counter of the mapping in the same 
+	//lookup; return the counter value for the present check 
+	//(see addresstable_entity_t::updatePresentCnt()), or -1 if hostPtr is not 
+	//present.
+    int HI_update_present_counter(const void *hostPtr, void **devPtr, bool increment, int asyncID, int tid) {
+		int result = -1;
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
 #else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
-			fprintf(stderr, "[OPENARCRT-INFO]\t\tenter Accelerator::HI_set_device_address(hostPtr = %lx, devPtr = %lx, size = %ld, thread ID = %d, org. thread ID = %d)\n",(long unsigned int)hostPtr, (long unsigned int)devPtr,  size, tid, org_tid);
+			fprintf(stderr, "[OPENARCRT-INFO]\t\tenter Accelerator::HI_update_present_counter(hostPtr = %lx, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, tid, org_tid);
 		}
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
-        addresstable_t::iterator it = masterAddressTable->find(asyncID);
-        //fprintf(stderr, "[in set_device_address()] Setting address\n");
-        if(it == masterAddressTable->end() ) {
-            //fprintf(stderr, "[in set_device_address()] No mapping found for the asyncID\n");
-            addressmap_t *emptyMap = new addressmap_t();
-        	addresstable_entity_t *aet = new addresstable_entity_t(devPtr, size);
-			(*emptyMap)[hostPtr] = (void *) aet;
-			//emptyMap->insert(std::pair<const void*, void*>(hostPtr, (void *) aet));
-            masterAddressTable->insert(std::pair<int, addressmap_t *> (asyncID, emptyMap));
-            //it = masterAddressTable->find(asyncID);
-        } else {
-        	addresstable_entity_t *aet = new addresstable_entity_t(devPtr, size);
-        	(*(it->second))[hostPtr] = (void*) aet;
-        	//(it->second)->insert(std::pair<const void*, void*>(hostPtr, (void*) aet));
+        int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
+		addresstable_entity_t aet(NULL, 0);
+		size_t tOffset = 0;
+		//Check the range on the asyncID queue first, and then on the default queue.
+		bool found = presentTable->updatePresentCnt(hostPtr, asyncID, increment, &result, &aet, &tOffset);
+#ifdef _OPENARC_PROFILE_
+		HI_inc_present_table_cnt(org_tid);
+#endif
+		if( !found && (asyncID != defaultAsyncID) ) {
+			found = presentTable->updatePresentCnt(hostPtr, defaultAsyncID, increment, &result, &aet, &tOffset);
+#ifdef _OPENARC_PROFILE_
+			HI_inc_present_table_cnt(org_tid);
+#endif
+		}
+		if( found ) {
+			*devPtr = (void *)((size_t)aet.basePtr + tOffset);
+		} else {
+			*devPtr = NULL;
+			result = -1;
 		}
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
 		if( HI_openarcrt_verbosity > 3 ) {
-			fprintf(stderr, "[OPENARCRT-INFO]\t\texit Accelerator::HI_set_device_address(hostPtr = %lx, devPtr = %lx, size = %ld, thread ID = %d, org. thread ID = %d)\n",(long unsigned int)hostPtr, (long unsigned int)devPtr,  size, tid, org_tid);
+			fprintf(stderr, "[OPENARCRT-INFO]\t\texit Accelerator::HI_update_present_counter(hostPtr = %lx, counter = %d, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, result, tid, org_tid);
 		}
 #endif
+		return result;
+    }
+
+	//Check whether hostPtr is mapped as a base address on the asyncID queue 
+	//(the default queue is not checked).
+    bool HI_has_device_address(const void *hostPtr, int asyncID, int tid) {
 #ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
+		asyncID = asyncID - tid * MAX_NUM_QUEUES_PER_THREAD;
+		return sharedPresentTable.findExact(hostPtr, asyncID);
 #else
-#ifdef _OPENMP
+		return masterAddressTableMap[tid]->findExact(hostPtr, asyncID);
+#endif
+    }
+
+    HI_error_t HI_set_device_address(const void *hostPtr, void * devPtr, size_t size, int asyncID, int tid) {
+		int org_tid = tid;
+#ifdef _USE_SHARED_PRESENT_TABLE
+		tid = 0;
+		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
+#endif
+#ifdef _OPENARC_PROFILE_
+		if( HI_openarcrt_verbosity > 3 ) {
+			fprintf(stderr, "[OPENARCRT-INFO]\t\tenter Accelerator::HI_set_device_address(hostPtr = %lx, devPtr = %lx, size = %ld, thread ID = %d, org. thread ID = %d)\n",(long unsigned int)hostPtr, (long unsigned int)devPtr,  size, tid, org_tid);
 		}
 #endif
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
+		//If hostPtr was already mapped on the asyncID queue, the old mapping is replaced.
+		presentTable->insert(hostPtr, devPtr, size, asyncID);
+#ifdef _OPENARC_PROFILE_
+		HI_inc_present_table_cnt(org_tid);
+		if( HI_openarcrt_verbosity > 3 ) {
+			fprintf(stderr, "[OPENARCRT-INFO]\t\texit Accelerator::HI_set_device_address(hostPtr = %lx, devPtr = %lx, size = %ld, thread ID = %d, org. thread ID = %d)\n",(long unsigned int)hostPtr, (long unsigned int)devPtr,  size, tid, org_tid);
+		}
 #endif
         return  HI_success;
     }
@@ -724,56 +2379,30 @@ public:
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
 #endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_remove_device_address(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
-        addresstable_t::iterator it = masterAddressTable->find(asyncID);
-        addressmap_t::iterator it2 =	(it->second)->find(hostPtr);
-
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
+#endif
+		bool found = presentTable->erase(hostPtr, asyncID);
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
+		HI_inc_present_table_cnt(org_tid);
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_remove_device_address(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
-        if(it2 != (it->second)->end() ) {
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            delete aet;
-            (it->second)->erase(it2);
-            //return  HI_success;
+        if( found ) {
 			returnValue = HI_success;
         } else {
             fprintf(stderr, "[ERROR in remove_device_address()] No mapping found for the host pointer on async ID %d\n", asyncID);
-            //return HI_error;
 			returnValue = HI_error;
         }
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-		}
-#endif
-#endif
-#endif
 		return returnValue;
     }
 
@@ -781,74 +2410,48 @@ public:
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
 #endif
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
 		memPool_t *memPool = memPoolMap[tid];
 		size_t num_table_entries = 0;
 		size_t total_allocated_device_memory = 0;
-        for (addresstable_t::iterator it = masterAddressTable->begin(); it != masterAddressTable->end(); ++it) {
-			addressmap_t *tAddressMap = it->second;
-        	for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-				total_allocated_device_memory += aet->size;
-				num_table_entries++;
-			}
+		std::vector<addresstable_entity_t> entries;
+		presentTable->getEntries(entries);
+        for (size_t i = 0; i < entries.size(); i++) {
+			total_allocated_device_memory += entries[i].size;
+			num_table_entries++;
 		}
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\tSummary of host-to-device-address mapping table for host thread %d (org. thread ID = %d)\n", tid, org_tid);
         fprintf(stderr, "                \t\t\tNumber of mapping entries = %lu\n", num_table_entries);
         fprintf(stderr, "                \t\t\tTotal allocated device memory = %lu\n", total_allocated_device_memory);
-		num_table_entries = 0;
-		total_allocated_device_memory = 0;
-        for (memPool_t::iterator it = memPool->begin(); it != memPool->end(); ++it) {
-			total_allocated_device_memory += it->first * memPool->count(it->first);
-			num_table_entries++;
-		}
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\tSummary of device-memory pool table for host thread %d (org. thread ID = %d)\n", tid, org_tid);
-        fprintf(stderr, "                \t\t\tNumber of mapping entries = %lu\n", num_table_entries);
-        fprintf(stderr, "                \t\t\tTotal reserved device memory pool = %lu\n", total_allocated_device_memory);
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-		}
-#endif
-#endif
-#endif
+        fprintf(stderr, "                \t\t\tNumber of free blocks = %lu\n", memPool->size());
+        fprintf(stderr, "                \t\t\tTotal free device memory in the pool = %lu\n", memPool->getFreeBytes());
+        fprintf(stderr, "                \t\t\tTotal reserved device memory pool = %lu\n", memPool->getReservedBytes());
     }
 
     void HI_print_device_address_mapping_entries(int tid) {
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
 #endif
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
 		memPool_t *memPool = memPoolMap[tid];
     	memhandlemap_t *myHandleMap = masterHandleTable[tid];
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\tHost-to-device-address mapping table entries for host thread %d (org. thread ID = %d)\n", tid, org_tid);
         fprintf(stderr, "                \t\t\tHostPtr\tDevPtr\n");
-        for (addresstable_t::iterator it = masterAddressTable->begin(); it != masterAddressTable->end(); ++it) {
-			addressmap_t *tAddressMap = it->second;
-        	for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-        		fprintf(stderr, "                \t\t\t%lx\t%lx\n", (unsigned long)it2->first, (unsigned long)aet->basePtr);
-			}
+		std::vector<addresstable_entity_t> entries;
+		presentTable->getEntries(entries);
+        for (size_t i = 0; i < entries.size(); i++) {
+        	fprintf(stderr, "                \t\t\t%lx\t%lx\n", (unsigned long)entries[i].hostPtr, (unsigned long)entries[i].basePtr);
 		}
 #if !defined(OPENARC_ARCH) || OPENARC_ARCH != 6
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\tDevPtr-to-MemHandle mapping table entries for host thread %d (org. thread ID = %d)\n", tid, org_tid);
@@ -860,777 +2463,182 @@ public:
 #endif
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\tDevPtr in the memory pool for host thread %d( org. thread ID = %d)\n", tid, org_tid);
         fprintf(stderr, "                \t\t\tDevPtr\n");
-        for (memPool_t::iterator it = memPool->begin(); it != memPool->end(); ++it) {
-        	fprintf(stderr, "                \t\t\t%lx\n", (unsigned long)it->second);
-		}
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
+		std::vector<void *> freeBlocks;
+		memPool->getFreeBlocks(freeBlocks);
+        for (size_t i = 0; i < freeBlocks.size(); i++) {
+        	fprintf(stderr, "                \t\t\t%lx\n", (unsigned long)freeBlocks[i]);
 		}
-#endif
-#endif
-#endif
     }
 
     HI_error_t HI_get_host_address(const void *devPtr, void** hostPtr, int asyncID, int tid) {
-		bool returnReady = false;
 		HI_error_t returnValue = HI_error;
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
 #endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_get_host_address(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
-        int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
-        addresstable_t::iterator it = masterAddressTable->find(asyncID);
-#ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-    	}    
-#endif
-        if(it != masterAddressTable->end() ) {
-			addressmap_t *tAddressMap = it->second;
-			for( addressmap_t::iterator it3 = tAddressMap->begin(); it3 != tAddressMap->end(); ++it3 ) {
-#ifdef _OPENARC_PROFILE_
-    			if( HI_openarcrt_verbosity > 1 ) {
-					ptit->second++;
-    			}    
-#endif
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-				if( aet->basePtr == devPtr ) {
-					*hostPtr = (void *)it3->first;
-					//return HI_success;
-					returnReady = true;
-					returnValue = HI_success;
-					break;
-				} else if (devPtr >= aet->basePtr && (size_t) devPtr < (size_t) aet->basePtr + aet->size) {
-                	*hostPtr = (void*) ((size_t) it3->first + ((size_t) devPtr - (size_t) aet->basePtr));
-					//return HI_success;
-					returnReady = true;
-					returnValue = HI_success;
-					break;
-            	}
-			}
-		}
-
-		if( !returnReady && (asyncID != defaultAsyncID) ) {
-			//Check default queue.
-        	addresstable_t::iterator it = masterAddressTable->find(defaultAsyncID);
-        	if(it != masterAddressTable->end() ) {
-				addressmap_t *tAddressMap = it->second;
-				for( addressmap_t::iterator it3 = tAddressMap->begin(); it3 != tAddressMap->end(); ++it3 ) {
-#ifdef _OPENARC_PROFILE_
-    				if( HI_openarcrt_verbosity > 1 ) {
-						ptit->second++;
-    				}    
-#endif
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-					if( aet->basePtr == devPtr ) {
-						*hostPtr = (void *)it3->first;
-						//return HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-						break;
-					} else if (devPtr >= aet->basePtr && (size_t) devPtr < (size_t) aet->basePtr + aet->size) {
-                		*hostPtr = (void*) ((size_t) it3->first + ((size_t) devPtr - (size_t) aet->basePtr));
-						//return HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-						break;
-            		}
-				}
-			}
-		}
-
-#ifdef _OPENARC_PROFILE_
-		if( HI_openarcrt_verbosity > 3 ) {
-			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_get_host_address(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
-		}
-#endif
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-		}
-#endif
-#endif
-#endif
-
-		if( !returnReady ) {
-			*hostPtr = NULL;
-			returnReady = true;
-			returnValue = HI_error;
-		}
-
-		return returnValue;
-    }
-
-    const void * HI_get_base_address_of_host_memory(const void *hostPtr, int asyncID, int tid) {
-		bool returnReady = false;
-		const void * returnValue = NULL;
-		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
-		tid = 0;
-		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
 #else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
-#endif
-#ifdef _OPENARC_PROFILE_
-		if( HI_openarcrt_verbosity > 3 ) {
-			fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_get_base_address_of_host_memory(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
-		}
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
-		addresstable_t::iterator it = masterAddressTable->find(asyncID);
         int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
-	
-        if(it == masterAddressTable->end() ) {
-            addressmap_t* emptyMap = new addressmap_t();
-            masterAddressTable->insert(std::pair<int, addressmap_t *> (asyncID, emptyMap));
-			it = masterAddressTable->find(asyncID);
-		}
-		addressmap_t *tAddressMap = it->second;
-#if PRESENT_TABLE_SEARCH_MODE == 0
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-    	}    
-#endif
-        if(it2 != tAddressMap->end() ) {
-            //return  hostPtr;
-			returnReady = true;
-			returnValue = hostPtr;
-        } else {
-            //check on the default stream
-            it = masterAddressTable->find(defaultAsyncID);
-        	if(it == masterAddressTable->end() ) {
-            	addressmap_t* emptyMap = new addressmap_t();
-            	masterAddressTable->insert(std::pair<int, addressmap_t *> (defaultAsyncID, emptyMap));
-				it = masterAddressTable->find(defaultAsyncID);
-			}
-			tAddressMap = it->second;
-            it2 =	tAddressMap->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
-#endif
-            if(it2 != tAddressMap->end() ) {
-            	//return  hostPtr;
-				returnReady = true;
-				returnValue = hostPtr;
-            }
-		}
-
-		if( !returnReady ) {
-		//Check whether hostPtr is within the range of an allocated memory region 
-		//in the addressTable.
-		for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-#ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
-#endif
-            const void* aet_host = it2->first;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                //return  aet_host;
-				returnReady = true;
-				returnValue = aet_host;
-				break;
-            }
-        }
-		}
-
-		if( !returnReady && (asyncID != defaultAsyncID) ) {
-        	//check on the default stream
-        	it = masterAddressTable->find(defaultAsyncID);
-			tAddressMap = it->second;
-        	for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-#ifdef _OPENARC_PROFILE_
-    			if( HI_openarcrt_verbosity > 1 ) {
-					ptit->second++;
-    			}    
-#endif
-            	const void* aet_host = it2->first;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                	//return  aet_host;
-					returnReady = true;
-					returnValue = aet_host;
-					break;
-            	}
-        	}
-		}
-#else
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
+		addresstable_entity_t aet(NULL, 0);
+		size_t tOffset = 0;
+		//Check the range on the asyncID queue first, and then on the default queue.
+		bool found = presentTable->findDevice(devPtr, asyncID, &aet, &tOffset);
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
+		HI_inc_present_table_cnt(org_tid);
 #endif
-        if(it2 != tAddressMap->end() ) {
-			if( it2->first == hostPtr ) {
-				//found the entry matching the key, hostPtr.
-				//return hostPtr;
-				returnReady = true;
-				returnValue = hostPtr;
-			} else {
-				//hostPtr may belong to an entry before the current one.
-				if( it2 == tAddressMap->begin() ) {
-					//There is no entry before the current one.
-					//return NULL; //Do not return here; check the default stream.
-				} else {
-					--it2; 
-            		const void* aet_hostPtr = it2->first;
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            		if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-						//return aet_hostPtr;
-						returnReady = true;
-						returnValue = aet_hostPtr;
-            		}
-				}
-			}
-		} else if( !tAddressMap->empty() ) {
-			//hostPtr may belong to the last entry.
-        	addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            const void* aet_hostPtr = it3->first;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-				//return aet_hostPtr;
-				returnReady = true;
-				returnValue = aet_hostPtr;
-            }
-		}
-
-		if( !returnReady && (asyncID != defaultAsyncID) ) {
-        	//check on the default stream
-        	it = masterAddressTable->find(defaultAsyncID);
-        	if(it == masterAddressTable->end() ) {
-            	addressmap_t* emptyMap = new addressmap_t();
-            	masterAddressTable->insert(std::pair<int, addressmap_t *> (defaultAsyncID, emptyMap));
-				it = masterAddressTable->find(defaultAsyncID);
-			}
-			tAddressMap = it->second;
-        	addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
+		if( !found && (asyncID != defaultAsyncID) ) {
+			found = presentTable->findDevice(devPtr, defaultAsyncID, &aet, &tOffset);
 #ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
-#endif
-        	if(it2 != tAddressMap->end() ) {
-				if( it2->first == hostPtr ) {
-					//found the entry matching the key, hostPtr.
-					//return hostPtr;
-					returnReady = true;
-					returnValue = hostPtr;
-				} else {
-					//hostPtr may belong to an entry before the current one.
-					if( it2 == tAddressMap->begin() ) {
-						//There is no entry before the current one.
-						//return NULL; 
-						returnReady = true;
-						returnValue = NULL;
-					} else {
-						--it2; 
-            			const void* aet_hostPtr = it2->first;
-            			addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            			if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-							//return aet_hostPtr;
-							returnReady = true;
-							returnValue = aet_hostPtr;
-            			}
-					}
-				}
-			} else if( !tAddressMap->empty() ) {
-				//hostPtr may belong to the last entry.
-        		addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            	const void* aet_hostPtr = it3->first;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            	if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-					//return aet_hostPtr;
-					returnReady = true;
-					returnValue = aet_hostPtr;
-            	}
-			}
-		}
+			HI_inc_present_table_cnt(org_tid);
 #endif
-#ifdef _OPENARC_PROFILE_
-		if( HI_openarcrt_verbosity > 3 ) {
-			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_get_base_address_of_host_memory(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
-#endif
-#ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
+		if( found ) {
+            *hostPtr = (void*) ((size_t) aet.hostPtr + tOffset);
+			returnValue = HI_success;
+		} else {
+			*hostPtr = NULL;
+			returnValue = HI_error;
 		}
-#endif
-#endif
-#endif
-		if( !returnReady ) {
-			//No entry is found.
-        	//return NULL;
-			returnReady = true;
-			returnValue = NULL;
+#ifdef _OPENARC_PROFILE_
+		if( HI_openarcrt_verbosity > 3 ) {
+			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_get_host_address(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
-
+#endif
 		return returnValue;
     }
 
+    const void * HI_get_base_address_of_host_memory(const void *hostPtr, int asyncID, int tid) {
+		size_t size;
+		return HI_get_base_address_of_host_memory(hostPtr, &size, asyncID, tid);
+    }
+
     const void * HI_get_base_address_of_host_memory(const void *hostPtr, size_t *size, int asyncID, int tid) {
-		bool returnReady = false;
 		const void * returnValue = NULL;
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
-		{
-#endif
-#endif
 #endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\tenter HI_get_base_address_of_host_memory(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
-    	addresstable_t *masterAddressTable = masterAddressTableMap[tid];
-		addresstable_t::iterator it = masterAddressTable->find(asyncID);
-        int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
-	
-        if(it == masterAddressTable->end() ) {
-            addressmap_t* emptyMap = new addressmap_t();
-            masterAddressTable->insert(std::pair<int, addressmap_t *> (asyncID, emptyMap));
-			it = masterAddressTable->find(asyncID);
-		}
-		addressmap_t *tAddressMap = it->second;
-#if PRESENT_TABLE_SEARCH_MODE == 0
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-    	}    
-#endif
-        if(it2 != tAddressMap->end() ) {
-            //return  hostPtr;
-			returnReady = true;
-			returnValue = hostPtr;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-			*size = aet->size; 
-        } else {
-            //check on the default stream
-            it = masterAddressTable->find(defaultAsyncID);
-        	if(it == masterAddressTable->end() ) {
-            	addressmap_t* emptyMap = new addressmap_t();
-            	masterAddressTable->insert(std::pair<int, addressmap_t *> (defaultAsyncID, emptyMap));
-				it = masterAddressTable->find(defaultAsyncID);
-			}
-			tAddressMap = it->second;
-            it2 =	tAddressMap->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
+#ifdef _USE_SHARED_PRESENT_TABLE
+    	sharedpresenttable_t *presentTable = &sharedPresentTable;
+#else
+    	presenttable_t *presentTable = masterAddressTableMap[tid];
 #endif
-            if(it2 != tAddressMap->end() ) {
-            	//return  hostPtr;
-				returnReady = true;
-				returnValue = hostPtr;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-				*size = aet->size; 
-            }
-		}
-
-		if( !returnReady ) {
-		//Check whether hostPtr is within the range of an allocated memory region 
-		//in the addressTable.
-		for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
+        int defaultAsyncID = DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD;
+		addresstable_entity_t aet(NULL, 0);
+		bool found = presentTable->find(hostPtr, asyncID, &aet, NULL);
 #ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
+		HI_inc_present_table_cnt(org_tid);
 #endif
-            const void* aet_host = it2->first;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                //return  aet_host;
-				returnReady = true;
-				returnValue = aet_host;
-				*size = aet->size; 
-				break;
-            }
-        }
-		}
-
-		if( !returnReady && (asyncID != defaultAsyncID) ) {
+		if( !found && (asyncID != defaultAsyncID) ) {
         	//check on the default stream
-        	it = masterAddressTable->find(defaultAsyncID);
-			tAddressMap = it->second;
-        	for (addressmap_t::iterator it2 = tAddressMap->begin(); it2 != tAddressMap->end(); ++it2) {
-#ifdef _OPENARC_PROFILE_
-    			if( HI_openarcrt_verbosity > 1 ) {
-					ptit->second++;
-    			}    
-#endif
-            	const void* aet_host = it2->first;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	if (hostPtr >= aet_host && (size_t) hostPtr < (size_t) aet_host + aet->size) {
-                	//return  aet_host;
-					returnReady = true;
-					returnValue = aet_host;
-					*size = aet->size; 
-					break;
-            	}
-        	}
-		}
-#else
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
+			found = presentTable->find(hostPtr, defaultAsyncID, &aet, NULL);
 #ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
+			HI_inc_present_table_cnt(org_tid);
 #endif
-        if(it2 != tAddressMap->end() ) {
-			if( it2->first == hostPtr ) {
-				//found the entry matching the key, hostPtr.
-				//return hostPtr;
-				returnReady = true;
-				returnValue = hostPtr;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-				*size = aet->size; 
-			} else {
-				//hostPtr may belong to an entry before the current one.
-				if( it2 == tAddressMap->begin() ) {
-					//There is no entry before the current one.
-					//return NULL; //Do not return here; check the default stream.
-				} else {
-					--it2; 
-            		const void* aet_hostPtr = it2->first;
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            		if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-						//return aet_hostPtr;
-						returnReady = true;
-						returnValue = aet_hostPtr;
-						*size = aet->size; 
-            		}
-				}
-			}
-		} else if( !tAddressMap->empty() ) {
-			//hostPtr may belong to the last entry.
-        	addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            const void* aet_hostPtr = it3->first;
-            addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-				//return aet_hostPtr;
-				returnReady = true;
-				returnValue = aet_hostPtr;
-				*size = aet->size; 
-            }
 		}
-
-		if( !returnReady && (asyncID != defaultAsyncID) ) {
-        	//check on the default stream
-        	it = masterAddressTable->find(defaultAsyncID);
-        	if(it == masterAddressTable->end() ) {
-            	addressmap_t* emptyMap = new addressmap_t();
-            	masterAddressTable->insert(std::pair<int, addressmap_t *> (defaultAsyncID, emptyMap));
-				it = masterAddressTable->find(defaultAsyncID);
-			}
-			tAddressMap = it->second;
-        	addressmap_t::iterator it2 =	tAddressMap->lower_bound(hostPtr);
-#ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
-#endif
-        	if(it2 != tAddressMap->end() ) {
-				if( it2->first == hostPtr ) {
-					//found the entry matching the key, hostPtr.
-					//return hostPtr;
-					returnReady = true;
-					returnValue = hostPtr;
-            		addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-					*size = aet->size; 
-				} else {
-					//hostPtr may belong to an entry before the current one.
-					if( it2 == tAddressMap->begin() ) {
-						//There is no entry before the current one.
-						//return NULL; 
-						returnReady = true;
-						returnValue = NULL;
-						*size = 0;
-					} else {
-						--it2; 
-            			const void* aet_hostPtr = it2->first;
-            			addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            			if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-							//return aet_hostPtr;
-							returnReady = true;
-							returnValue = aet_hostPtr;
-							*size = aet->size; 
-            			}
-					}
-				}
-			} else if( !tAddressMap->empty() ) {
-				//hostPtr may belong to the last entry.
-        		addressmap_t::reverse_iterator it3 = tAddressMap->rbegin();
-            	const void* aet_hostPtr = it3->first;
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it3->second;
-            	if (hostPtr >= aet_hostPtr && (size_t) hostPtr < (size_t) aet_hostPtr + aet->size) {
-					//return aet_hostPtr;
-					returnReady = true;
-					returnValue = aet_hostPtr;
-					*size = aet->size; 
-            	}
-			}
+		if( found ) {
+			returnValue = aet.hostPtr;
+			*size = aet.size;
+		} else {
+			//No entry is found.
+			returnValue = NULL;
+			*size = 0;
 		}
-#endif
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_get_base_address_of_host_memory(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
+		return returnValue;
+    }
+
+    victimcacheshard_t * HI_get_victim_cache_shard(int tid) {
 #ifdef _USE_SHARED_PRESENT_TABLE
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
-#else
-#ifdef _OPENMP
-		}
-#endif
-#endif
+		tid = 0;
 #endif
-		if( !returnReady ) {
-			//No entry is found.
-        	//return NULL;
-			returnReady = true;
-			returnValue = NULL;
-			*size = 0;
+		if( tid < 0 ) {
+			tid = 0;
 		}
+		return &victimCacheShards[tid % VICTIM_CACHE_NUM_SHARDS];
+	}
 
-		return returnValue;
-    }
-
-    HI_error_t HI_get_device_address_from_victim_cache(const void *hostPtr, void **devPtrBase, size_t *offset, size_t *size, int asyncID, int tid) {
+	//Take a device buffer of at least size bytes for hostPtr from the victim
+	//cache; if sizeReuse is true, a buffer cached for another host pointer
+	//can be returned. The allocation size of the buffer is returned through
+	//allocSize.
+    HI_error_t HI_get_device_address_from_victim_cache(const void *hostPtr, size_t size, bool sizeReuse, void **devPtr, size_t *allocSize, int asyncID, int tid) {
 		int org_tid = tid;
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 		asyncID = asyncID - org_tid * MAX_NUM_QUEUES_PER_THREAD;
 #endif
 		HI_error_t ret = HI_error;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\t\tenter Accelerator::HI_get_device_address_from_victim_cache (hostPtr = %lx, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, tid, org_tid);
 		}
 #endif
-		addresstable_t::iterator it = auxAddressTable.find(asyncID);
-		//Check whether hostPtr exists as an entry to addressTable (it->second), 
-		//which will be true if hostPtr is a base address of the pointed memory.
-        addressmap_t::iterator it2 =	(it->second)->find(hostPtr);
-#ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
-#endif
-        if(it2 != (it->second)->end() ) {
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            *devPtrBase = aet->basePtr;
-			if( size ) *size = aet->size;
-			if( offset ) *offset = 0;
-            //*devPtrBase = it2->second;
-            ret = HI_success;
-        } else {
-            //check on the default stream
-            it = auxAddressTable.find(DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD);
-            it2 =	(it->second)->find(hostPtr);
-            if(it2 != (it->second)->end() ) {
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	*devPtrBase = aet->basePtr;
-				if( size ) *size = aet->size;
-				if( offset ) *offset = 0;
-            //	*devPtrBase = it2->second;
-            	ret = HI_success;
-            }
-		}
+		victimcacheshard_t *shard = HI_get_victim_cache_shard(tid);
+		if( shard->take(hostPtr, size, asyncID, DEFAULT_QUEUE+tid*MAX_NUM_QUEUES_PER_THREAD, sizeReuse, HI_mempool_frag_limit, devPtr, allocSize) ) {
+			ret = HI_success;
 		}
 #ifdef _OPENARC_PROFILE_
 		if( HI_openarcrt_verbosity > 3 ) {
 			fprintf(stderr, "[OPENARCRT-INFO]\t\texit Accelerator::HI_get_device_address_from_victim_cache (hostPtr = %lx, thread ID = %d, org. thread ID = %d)\n", (unsigned long)hostPtr, tid, org_tid);
 		}
-#endif
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
 #endif
         return ret;
     }
 
-    HI_error_t HI_set_device_address_in_victim_cache (const void *hostPtr, void * devPtr, size_t size, int asyncID) {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
-        addresstable_t::iterator it = auxAddressTable.find(asyncID);
-        if(it == auxAddressTable.end() ) {
-            addressmap_t *emptyMap = new addressmap_t();
-        	addresstable_entity_t *aet = new addresstable_entity_t(devPtr, size);
-			(*emptyMap)[hostPtr] = (void *) aet;
-            auxAddressTable.insert(std::pair<int, addressmap_t*> (asyncID, emptyMap));
-        } else {
-        	//(it->second).insert(std::pair<const void *,void*>(hostPtr, devPtr));
-        	//(it->second)[hostPtr] = devPtr;
-        	addresstable_entity_t *aet = new addresstable_entity_t(devPtr, size);
-        	(*(it->second))[hostPtr] = (void*) aet;
-		}
-		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
+	//Cache devPtr for hostPtr; size is the allocation size of devPtr.
+    HI_error_t HI_set_device_address_in_victim_cache (const void *hostPtr, void * devPtr, size_t size, int asyncID, int tid) {
+#ifdef _USE_SHARED_PRESENT_TABLE
+		asyncID = asyncID - tid * MAX_NUM_QUEUES_PER_THREAD;
 #endif
+		HI_get_victim_cache_shard(tid)->put(hostPtr, devPtr, size, asyncID);
         return  HI_success;
     }
 
-    HI_error_t HI_remove_device_address_from_victim_cache (const void *hostPtr, int asyncID) {
-		HI_error_t ret;
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
-        addresstable_t::iterator it = auxAddressTable.find(asyncID);
-        addressmap_t::iterator it2 =	(it->second)->find(hostPtr);
-
-        if(it2 != (it->second)->end() ) {
-            addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            delete aet;
-            (it->second)->erase(it2);
-            ret =  HI_success;
-        } else {
-            fprintf(stderr, "[ERROR in remove_device_address_from_victim_cache()] No mapping found for the host pointer on async ID %d\n", asyncID);
-            ret = HI_error;
-        }
+	//Remove the least recently cached entry of the calling thread's shard;
+	//the caller should release its memory.
+    HI_error_t HI_pop_victim_cache_entry(victimcache_entry_t *entry, int tid) {
+		if( HI_get_victim_cache_shard(tid)->popLRUEntry(entry) ) {
+			return HI_success;
+		} else {
+			return HI_error;
 		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-		return ret;
     }
 
-    HI_error_t HI_reset_victim_cache ( int asyncID ) {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		{
-        addresstable_t::iterator it = auxAddressTable.find(asyncID);
-        while(it != auxAddressTable.end()) {
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	delete aet;
-			}
-			(it->second)->clear();
-            it++;
-        }
-		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-		return  HI_success;
-    }
+	size_t HI_get_victim_cache_size(int tid) {
+		return HI_get_victim_cache_shard(tid)->getCachedBytes();
+	}
 
-    HI_error_t HI_reset_victim_cache_all ( ) {
-#ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_victim_cache);
-#else
-#ifdef _OPENMP
-    	#pragma omp critical (victim_cache_critical)
-#endif
-#endif
-		for( addresstable_t::iterator it = auxAddressTable.begin(); it != auxAddressTable.end(); ++it ) {
-			for( addressmap_t::iterator it2 = (it->second)->begin(); it2 != (it->second)->end(); ++it2 ) {
-            	addresstable_entity_t *aet = (addresstable_entity_t*) it2->second;
-            	delete aet;
-			}
-			(it->second)->clear();
-		}
-#ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_victim_cache);
-#endif
-		return  HI_success;
-    }
+	//Record the allocation size of a buffer taken from the victim cache 
+	//that is larger than its mapping.
+	void HI_set_victim_cache_alloc_size(const void *devPtr, size_t allocSize, int tid) {
+		HI_get_victim_cache_shard(tid)->setAllocSize(devPtr, allocSize);
+	}
+
+	//Return the allocation size of devPtr, which is mapped with size bytes,
+	//and remove its record.
+	size_t HI_remove_victim_cache_alloc_size(const void *devPtr, size_t size, int tid) {
+		return HI_get_victim_cache_shard(tid)->removeAllocSize(devPtr, size);
+	}
 
     HI_error_t HI_get_device_mem_handle(const void *devPtr, HI_device_mem_handle_t *memoryHandle, int tid) {
     	return HI_get_device_mem_handle(devPtr, memoryHandle, NULL, tid);
@@ -1643,10 +2651,10 @@ public:
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 #ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
+        pthread_mutex_lock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
+        #pragma omp critical(memHandleTable_critical)
 		{
 #endif
 #endif
@@ -1657,10 +2665,10 @@ public:
 		}
 #endif
     	memhandlemap_t *myHandleMap = masterHandleTable[tid];
-#if PRESENT_TABLE_SEARCH_MODE == 0
-		//Check whether devPtr exists as an entry to myHandleMap, 
-		//which will be true if devPtr is a base address of the pointed memory.
-        memhandlemap_t::iterator it2 =	myHandleMap->find(devPtr);
+		//Find the entry whose address range contains devPtr; devPtr may be 
+		//either the base address or an interior address of the entry.
+		size_t offset = 0;
+		memhandletable_entity_t *aet = myHandleMap->find(devPtr, &offset);
 #ifdef _OPENARC_PROFILE_
 		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
     	if( HI_openarcrt_verbosity > 1 ) {
@@ -1670,113 +2678,16 @@ public:
 			ptit->second++;
     	}    
 #endif
-        if(it2 != myHandleMap->end() ) {
-            memhandletable_entity_t *aet = (memhandletable_entity_t*) it2->second;
-            memoryHandle->memHandle = aet->memHandle;
-            memoryHandle->offset = 0;
+		if( aet != NULL ) {
+			memoryHandle->memHandle = aet->memHandle;
+			memoryHandle->offset = offset;
 			if( size != NULL ) {
 				*size = aet->size;
 			}
-            //return  HI_success;
 			returnReady = true;
 			returnValue = HI_success;
 		}
 
-		if( !returnReady ) {
-		//Check whether devPtr is within the range of an allocated memory region 
-		//in the addressTable.
-		for (memhandlemap_t::iterator it2 = myHandleMap->begin(); it2 != myHandleMap->end(); ++it2) {
-            const void* aet_devPtr = it2->first;
-            memhandletable_entity_t *aet = (memhandletable_entity_t*) it2->second;
-#ifdef _OPENARC_PROFILE_
-    		if( HI_openarcrt_verbosity > 1 ) {
-				ptit->second++;
-    		}    
-#endif
-            if (devPtr >= aet_devPtr && (size_t) devPtr < (size_t) aet_devPtr + aet->size) {
-                memoryHandle->memHandle = aet->memHandle;
-                memoryHandle->offset = (size_t) devPtr - (size_t) aet_devPtr;
-				if( size != NULL ) {
-					*size = aet->size;
-				}
-                //return  HI_success;
-				returnReady = true;
-				returnValue = HI_success;
-				break;
-            }
-        }
-		}
-#else
-		//Check whether devPtr exists as an entry to myHandleMap, 
-		//which will be true if devPtr is a base address of the pointed memory.
-        memhandlemap_t::iterator it2 =	myHandleMap->lower_bound(devPtr);
-#ifdef _OPENARC_PROFILE_
-		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
-    	if( HI_openarcrt_verbosity > 1 ) {
-			if(ptit == presentTableCntMap.end()) {
-				presentTableCntMap.insert(std::pair<int, long> (tid, 0));
-			}
-			ptit->second++;
-    	}    
-#endif
-        if(it2 != myHandleMap->end() ) {
-			if( it2->first == devPtr ) {
-				//found the entry matching the key, devPtr.
-            	memhandletable_entity_t *aet = (memhandletable_entity_t*) it2->second;
-            	memoryHandle->memHandle = aet->memHandle;
-            	memoryHandle->offset = 0;
-				if( size != NULL ) {
-					*size = aet->size;
-				}
-            	//return  HI_success;
-				returnReady = true;
-				returnValue = HI_success;
-			} else {
-				//devPtr may belong to an entry before the current one.
-				if( it2 == myHandleMap->begin() ) {
-					//There is no entry before the current one.
-					memoryHandle->memHandle = {};
-					memoryHandle->offset = 0;
-					if( size != NULL ) {
-						*size = 0;
-					}
-					//return HI_error;
-					returnReady = true;
-					returnValue = HI_error;
-				} else {
-					--it2; 
-            		const void* aet_devPtr = it2->first;
-            		memhandletable_entity_t *aet = (memhandletable_entity_t*) it2->second;
-            		if (devPtr >= aet_devPtr && (size_t) devPtr < (size_t) aet_devPtr + aet->size) {
-                		memoryHandle->memHandle = aet->memHandle;
-                		memoryHandle->offset = (size_t) devPtr - (size_t) aet_devPtr;
-						if( size != NULL ) {
-							*size = aet->size;
-						}
-                		//return  HI_success;
-						returnReady = true;
-						returnValue = HI_success;
-            		}
-				}
-			}
-		} else if( !myHandleMap->empty() ) {
-			//devPtr may belong to the last entry.
-        	memhandlemap_t::reverse_iterator it3 = myHandleMap->rbegin();
-            const void* aet_devPtr = it3->first;
-            memhandletable_entity_t *aet = (memhandletable_entity_t*) it3->second;
-            if (devPtr >= aet_devPtr && (size_t) devPtr < (size_t) aet_devPtr + aet->size) {
-            	memoryHandle->memHandle = aet->memHandle;
-                memoryHandle->offset = (size_t) devPtr - (size_t) aet_devPtr;
-				if( size != NULL ) {
-					*size = aet->size;
-				}
-                //return  HI_success;
-				returnReady = true;
-				returnValue = HI_success;
-            }
-		}
-#endif
-
 		if( !returnReady ) {
         	//fprintf(stderr, "[ERROR in get_device_mem_handle()] No mapping found for the device pointer\n");
 			memoryHandle->memHandle = {};
@@ -1793,7 +2704,7 @@ public:
 #endif
 #ifdef _USE_SHARED_PRESENT_TABLE
 #ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
+        pthread_mutex_unlock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
 		}
@@ -1808,10 +2719,10 @@ public:
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 #ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
+        pthread_mutex_lock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
+        #pragma omp critical(memHandleTable_critical)
 		{
 #endif
 #endif
@@ -1823,8 +2734,8 @@ public:
 #endif
     	memhandlemap_t *myHandleMap = masterHandleTable[tid];
         //fprintf(stderr, "[in set_device_mem_handle()] Setting address\n");
-        memhandletable_entity_t *aet = new memhandletable_entity_t(handle, size);
-        (*myHandleMap)[devPtr] = aet;
+        memhandletable_entity_t *aet = new memhandletable_entity_t(handle, size, devPtr);
+        myHandleMap->insert(devPtr, aet);
 #ifdef _OPENARC_PROFILE_
 		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
     	if( HI_openarcrt_verbosity > 1 ) {
@@ -1841,7 +2752,7 @@ public:
 #endif
 #ifdef _USE_SHARED_PRESENT_TABLE
 #ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
+        pthread_mutex_unlock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
 		}
@@ -1858,10 +2769,10 @@ public:
 #ifdef _USE_SHARED_PRESENT_TABLE
 		tid = 0;
 #ifdef _THREAD_SAFETY
-        pthread_mutex_lock(&mutex_presentTable);
+        pthread_mutex_lock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
-        #pragma omp critical(presentTable_critical)
+        #pragma omp critical(memHandleTable_critical)
 		{
 #endif
 #endif
@@ -1872,7 +2783,7 @@ public:
 		}
 #endif
     	memhandlemap_t *myHandleMap = masterHandleTable[tid];
-        memhandlemap_t::iterator it2 = myHandleMap->find(devPtr);
+        bool found = myHandleMap->erase(devPtr);
 #ifdef _OPENARC_PROFILE_
 		presenttablecnt_t::iterator ptit = presentTableCntMap.find(tid);
     	if( HI_openarcrt_verbosity > 1 ) {
@@ -1887,10 +2798,7 @@ public:
 			fprintf(stderr, "[OPENARCRT-INFO]\texit HI_remove_device_mem_handle(thread ID = %d, org. thread ID = %d)\n", tid, org_tid);
 		}
 #endif
-        if(it2 != myHandleMap->end() ) {
-            memhandletable_entity_t *aet = (memhandletable_entity_t*) it2->second;
-            delete aet;
-            myHandleMap->erase(it2);
+        if( found ) {
             //return  HI_success;
 			returnReady = true;
 			returnValue = HI_success;
@@ -1902,7 +2810,7 @@ public:
         }
 #ifdef _USE_SHARED_PRESENT_TABLE
 #ifdef _THREAD_SAFETY
-        pthread_mutex_unlock(&mutex_presentTable);
+        pthread_mutex_unlock(&mutex_memHandleTable);
 #else
 #ifdef _OPENMP
 		}
@@ -1912,6 +2820,63 @@ public:
 		return returnValue;
     }
 
+    //Free the oldest numFrees postponed frees of the async queue.
+    void reclaim_postponed_free(asyncfreetable_t *postponedFreeTable, int asyncID, unsigned long numFrees, int tid) {
+        std::multimap<int, const void*>::iterator hostPtrIter = postponedFreeTable->lower_bound(asyncID);
+        while( (numFrees > 0) && (hostPtrIter != postponedFreeTable->end()) && (hostPtrIter->first == asyncID) ) {
+            //fprintf(stderr, "[in HI_postponed_free()] Freeing on stream %d, address %x\n", asyncID, hostPtrIter->second);
+#ifdef _OPENARC_PROFILE_
+			postponedfreeinfo_t *freeInfo = postponedFreeInfoMap[tid];
+			size_t size = get_postponed_free_size(hostPtrIter->second, asyncID, tid);
+			freeInfo->size = (freeInfo->size > size) ? (freeInfo->size - size) : 0;
+#endif
+            HI_free(hostPtrIter->second, asyncID, tid);
+            postponedFreeTable->erase(hostPtrIter++);
+            numFrees--;
+        }
+    }
+
+    void reclaim_postponed_tempFree(int asyncID, unsigned long numFrees, int tid) {
+    	asynctempfreetable_t *postponedTempFreeTable = postponedTempFreeTableMap[tid];
+        std::multimap<int, void*>::iterator tempPtrIter = postponedTempFreeTable->lower_bound(asyncID);
+    	asynctempfreetable2_t *postponedTempFreeTable2 = postponedTempFreeTableMap2[tid];
+        std::multimap<int, acc_device_t>::iterator tempPtrIter2 = postponedTempFreeTable2->lower_bound(asyncID);
+        while( (numFrees > 0) && (tempPtrIter != postponedTempFreeTable->end()) && (tempPtrIter->first == asyncID) ) {
+        	if( (tempPtrIter2 == postponedTempFreeTable2->end()) || (tempPtrIter2->first != asyncID) ) {
+        		fprintf(stderr, "[ERROR in HI_postponed_tempFree()] postponedTempFreeTable has more entries for thread ID = %d\n", tid);
+				break;
+			}
+            //fprintf(stderr, "[in HI_postponed_TempFree()] Freeing on stream %d, address %x\n", asyncID, tempPtrIter->second);
+#ifdef _OPENARC_PROFILE_
+			postponedfreeinfo_t *freeInfo = postponedFreeInfoMap[tid];
+			size_t size = get_postponed_tempFree_size(tempPtrIter->second, tempPtrIter2->second, tid);
+			freeInfo->size = (freeInfo->size > size) ? (freeInfo->size - size) : 0;
+#endif
+            HI_tempFree(tempPtrIter->second, tempPtrIter2->second, tid);
+            postponedTempFreeTable->erase(tempPtrIter++);
+            postponedTempFreeTable2->erase(tempPtrIter2++);
+            numFrees--;
+        }
+    }
+
+#ifdef _OPENARC_PROFILE_
+    size_t get_postponed_free_size(const void *hostPtr, int asyncID, int tid) {
+		void *devPtr;
+		size_t size = 0;
+		HI_get_device_address(hostPtr, &devPtr, NULL, &size, asyncID, tid);
+		return size;
+    }
+
+    size_t get_postponed_tempFree_size(void *tempPtr, acc_device_t devType, int tid) {
+		if( (devType == acc_device_host) || (tempMallocSizeMap.count(tid) == 0) ) {
+			return 0;
+		}
+		sizemap_t *tempMallocSize = tempMallocSizeMap[tid];
+		sizemap_t::iterator it = tempMallocSize->find(tempPtr);
+		return (it != tempMallocSize->end()) ? it->second : 0;
+    }
+#endif
+
     HI_error_t HI_free_async( const void *hostPtr, int asyncID, int tid) {
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 3 ) {
@@ -1920,6 +2885,15 @@ public:
 #endif
     	asyncfreetable_t *postponedFreeTable = postponedFreeTableMap[tid];
         postponedFreeTable->insert(std::pair<int, const void *>(asyncID, hostPtr));
+		postponedfreeinfo_t *freeInfo = postponedFreeInfoMap[tid];
+		freeInfo->countMap[asyncID].freeInserted++;
+#ifdef _OPENARC_PROFILE_
+		freeInfo->size += get_postponed_free_size(hostPtr, asyncID, tid);
+		if( freeInfo->peakSize < freeInfo->size ) {
+			freeInfo->peakSize = freeInfo->size;
+		}
+#endif
+		HI_schedule_postponed_free(asyncID, tid);
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 3 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\texit HI_free_async(hostPtr = %lx, asyncID = %d, thread ID = %d)\n", (long unsigned int)hostPtr, asyncID, tid);
@@ -1935,15 +2909,9 @@ public:
     }    
 #endif
     	asyncfreetable_t *postponedFreeTable = postponedFreeTableMap[tid];
-        std::multimap<int, const void*>::iterator hostPtrIter = postponedFreeTable->find(asyncID);
-
-        while(hostPtrIter != postponedFreeTable->end()) {
-            //fprintf(stderr, "[in HI_postponed_free()] Freeing on stream %d, address %x\n", asyncID, hostPtrIter->second);
-            HI_free(hostPtrIter->second, asyncID, tid);
-            hostPtrIter++;
-        }
-
-        postponedFreeTable->erase(asyncID);
+		postponedfreecount_t *freeCount = &(postponedFreeInfoMap[tid]->countMap[asyncID]);
+		reclaim_postponed_free(postponedFreeTable, asyncID, freeCount->freeInserted - freeCount->freeRetired, tid);
+		freeCount->freeRetired = freeCount->freeInserted;
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 3 ) {
         fprintf(stderr, "[OPENARCRT-INFO]\t\t\texit HI_postponed_free(asyncID = %d, thread ID = %d)\n", asyncID, tid);
@@ -1974,6 +2942,15 @@ public:
         	postponedTempFreeTable->insert(std::pair<int, void *>(asyncID, tempPtr));
     		asynctempfreetable2_t *postponedTempFreeTable2 = postponedTempFreeTableMap2[tid];
         	postponedTempFreeTable2->insert(std::pair<int, acc_device_t>(asyncID, devType));
+			postponedfreeinfo_t *freeInfo = postponedFreeInfoMap[tid];
+			freeInfo->countMap[asyncID].tempFreeInserted++;
+#ifdef _OPENARC_PROFILE_
+			freeInfo->size += get_postponed_tempFree_size(tempPtr, devType, tid);
+			if( freeInfo->peakSize < freeInfo->size ) {
+				freeInfo->peakSize = freeInfo->size;
+			}
+#endif
+			HI_schedule_postponed_free(asyncID, tid);
 		}
 #ifdef _OPENARC_PROFILE_
     	if( HI_openarcrt_verbosity > 3 ) {
@@ -1992,26 +2969,9 @@ public:
 		if( postponedTempFreeTableMap.count(tid) == 0 ) {
         	fprintf(stderr, "[ERROR in HI_postponed_tempFree()] No mapping found for thread ID = %d\n", tid);
 		} else {
-    		asynctempfreetable_t *postponedTempFreeTable = postponedTempFreeTableMap[tid];
-        	std::multimap<int, void*>::iterator tempPtrIter = postponedTempFreeTable->find(asyncID);
-    		asynctempfreetable2_t *postponedTempFreeTable2 = postponedTempFreeTableMap2[tid];
-        	std::multimap<int, acc_device_t>::iterator tempPtrIter2 = postponedTempFreeTable2->find(asyncID);
-
-        	while((tempPtrIter != postponedTempFreeTable->end()) && (tempPtrIter2 != postponedTempFreeTable2->end())) {
-            	//fprintf(stderr, "[in HI_postponed_TempFree()] Freeing on stream %d, address %x\n", asyncID, tempPtrIter->second);
-            	HI_tempFree(tempPtrIter->second, tempPtrIter2->second, tid);
-            	tempPtrIter++;
-            	tempPtrIter2++;
-        	}
-        	if(tempPtrIter != postponedTempFreeTable->end()) {
-        		fprintf(stderr, "[ERROR in HI_postponed_tempFree()] postponedTempFreeTable has more entries for thread ID = %d\n", tid);
-			}
-        	if(tempPtrIter2 != postponedTempFreeTable2->end()) {
-        		fprintf(stderr, "[ERROR in HI_postponed_tempFree()] postponedTempFreeTable2 has more entries for thread ID = %d\n", tid);
-			}
-
-        	postponedTempFreeTable->erase(asyncID);
-        	postponedTempFreeTable2->erase(asyncID);
+			postponedfreecount_t *freeCount = &(postponedFreeInfoMap[tid]->countMap[asyncID]);
+			reclaim_postponed_tempFree(asyncID, freeCount->tempFreeInserted - freeCount->tempFreeRetired, tid);
+			freeCount->tempFreeRetired = freeCount->tempFreeInserted;
 		}
 #ifdef _OPENARC_PROFILE_
     if( HI_openarcrt_verbosity > 3 ) {
@@ -2021,6 +2981,24 @@ public:
         return HI_success;
     }
 
+    //Free the postponed frees of the async queue that were added before the 
+    //queue had freeMark/tempFreeMark postponed frees in total; the ones 
+    //already freed by a synchronization call are skipped.
+    void HI_reclaim_postponed_free(int asyncID, unsigned long freeMark, unsigned long tempFreeMark, int tid) {
+		if( postponedFreeInfoMap.count(tid) == 0 ) {
+			return;
+		}
+		postponedfreecount_t *freeCount = &(postponedFreeInfoMap[tid]->countMap[asyncID]);
+		if( freeMark > freeCount->freeRetired ) {
+			reclaim_postponed_free(postponedFreeTableMap[tid], asyncID, freeMark - freeCount->freeRetired, tid);
+			freeCount->freeRetired = freeMark;
+		}
+		if( tempFreeMark > freeCount->tempFreeRetired ) {
+			reclaim_postponed_tempFree(asyncID, tempFreeMark - freeCount->tempFreeRetired, tid);
+			freeCount->tempFreeRetired = tempFreeMark;
+		}
+    }
+
     HI_error_t HI_get_temphost_address(const void *hostPtr, void **temphostPtr, int asyncID, int tid) {
         addresstable_t::iterator it = tempHostAddressTable.find(asyncID);
         addressmap_t::iterator it2 =	(it->second)->find(hostPtr);
@@ -2216,16 +3194,30 @@ extern void acc_delete_async_wait(h_void* hostPtr, size_t size, int async, int a
 // Runtime init/reset //
 ////////////////////////
 extern void HI_hostinit(int threadID);
+extern void HI_retire_hostthread(int threadID);
 
 //////////////////////
 // Kernel Execution //
 //////////////////////
+//Return the integer ID of a kernel, which can be passed to the kernel 
+//execution functions below instead of the kernel name to skip the name 
+//lookup on every call; the ID is valid for all host threads and devices.
+extern int HI_get_kernel_id(std::string kernel_name, int threadID=NO_THREAD_ID);
+//Same as above, but the ID is cached per name pointer, which skips the name
+//lookup when the same string (e.g., a string literal) is passed again.
+extern int HI_get_kernel_id(const char *kernel_name, int threadID=NO_THREAD_ID);
 //Set the number of arguments to be passed to a kernel.
 extern HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_register_kernel_numargs(const char *kernel_name, int num_args, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
 //Register an argument to be passed to a kernel.
 extern HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_register_kernel_arg(const char *kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
 //Launch a kernel.
 extern HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_kernel_call(const char *kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
 extern HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID);
 
 /////////////////////////////
@@ -2254,11 +3246,10 @@ extern HI_error_t HI_memcpy2D(void *dst, size_t dpitch, const void *src, size_t
                                     size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID);
 extern HI_error_t HI_memcpy2D_async(void *dst, size_t dpitch, const void *src,
         size_t spitch, size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int async, int num_waits, int *waits, int threadID=NO_THREAD_ID);
-//extern HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch,
-//	size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID);
-//extern HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src,
-//	size_t spitch, size_t widthInBytes, size_t height, size_t depth,
-//	HI_MemcpyKind_t kind, int async, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch,
+                                    size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID);
+extern HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src,
+        size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int async, int num_waits, int *waits, int threadID=NO_THREAD_ID);
 extern HI_error_t HI_memcpy_const(void *hostPtr, std::string constName, HI_MemcpyKind_t kind, size_t count, int threadID=NO_THREAD_ID);
 extern HI_error_t HI_memcpy_const_async(void *hostPtr, std::string constName, HI_MemcpyKind_t kind, size_t count, int async, int num_waits, int *waits, int threadID=NO_THREAD_ID);
 extern HI_error_t HI_present_or_memcpy_const(void *hostPtr, std::string constName, HI_MemcpyKind_t kind, size_t count, int threadID=NO_THREAD_ID);
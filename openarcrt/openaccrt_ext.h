@@ -41,6 +41,77 @@ typedef struct
 typedef std::map<int, argument_t> argmap_t;
 */
 
+#if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
+//Value last set to a kernel argument by clSetKernelArg().
+typedef struct
+{
+	size_t size; //0 if the argument has to be set again.
+	size_t capacity;
+	void* value;
+	//For a buffer argument, the device buffer release counter at the time 
+	//the argument was set.
+	unsigned long memGeneration;
+	int isBuffer;
+} kernelargstate_t;
+
+#ifdef _OPENARC_PROFILE_
+//Event of a kernel (kernelName != NULL) or a transfer enqueued by a host 
+//thread, whose device timestamps are not yet collected.
+typedef struct
+{
+	cl_event event;
+	const char* kernelName;
+} profevent_t;
+
+//Number of pending profiling events, at which the completed ones are 
+//collected without waiting for a synchronization point.
+#define PROFILING_EVENT_COLLECT_THRESHOLD 256
+#endif
+
+//Maximum number of events in a wait list built on the stack.
+#define INLINE_EVENT_WAIT_LIST_SIZE 16
+
+//Request to reclaim the postponed frees of an async queue, pushed to the 
+//reclaimTickets list of the host thread by the completion callback of the 
+//last command enqueued on the queue before the frees were added.
+typedef struct _reclaimticket
+{
+	struct _reclaimticket *next;
+	struct _reclaimticket **reclaimTickets;
+	Accelerator *device;
+	cl_event event;
+	int asyncID;
+	unsigned long freeMark;
+	unsigned long tempFreeMark;
+} reclaimticket_t;
+
+//Policies to map logical async queues onto the async queue pool.
+#define ASYNC_QUEUE_POOL_ROUNDROBIN 0
+#define ASYNC_QUEUE_POOL_LEASTLOADED 1
+
+//Physical command queue of the async queue pool.
+typedef struct
+{
+	cl_command_queue queue; //NULL until a logical async queue is mapped
+	int numBound; //number of logical async queues mapped to this queue
+} asyncqueuepoolentry_t;
+
+//Non-blocking commands enqueued by a host thread to its default queue, and
+//the marker that HI_set_async() last enqueued to order async queues after 
+//them.
+typedef struct _defaultqueuemarker
+{
+	unsigned long cmdCnt; //number of non-blocking commands enqueued
+	unsigned long doneCnt; //cmdCnt when the default queue was last finished
+	unsigned long markerCnt; //cmdCnt when marker was enqueued
+	cl_event marker; //NULL until the first marker is enqueued
+	//cmdCnt when each async queue (keyed as in queueMap) was last ordered 
+	//after the default queue.
+	std::map<int, unsigned long> orderedCnt;
+	_defaultqueuemarker() : cmdCnt(0), doneCnt(0), markerCnt(0), marker(NULL) {}
+} defaultqueuemarker_t;
+#endif
+
 typedef struct
 {
 	int num_args;
@@ -49,6 +120,7 @@ typedef struct
 	int* kernelParamsInfo;
 #if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
 	cl_mem* kernelParamSubBuffers;
+	kernelargstate_t* kernelArgStates;
 #endif
 #if defined(OPENARC_ARCH) && OPENARC_ARCH == 6
 #if defined(OPENARCRT_USE_BRISBANE) && OPENARCRT_USE_BRISBANE == 1
@@ -74,6 +146,30 @@ typedef std::map<Accelerator *, std::map<std::string, iris_kernel> > kernelmapir
 typedef std::map<Accelerator *, std::map<std::string, cl_kernel> > kernelmapopencl_t;
 #endif
 
+//Pre-resolved launch handle of a kernel on a device; HostConf keeps a vector 
+//of these per device, indexed by the integer kernel ID, so that the kernel 
+//registration and launch functions do not look up the kernel name in the 
+//kernelsMap and kernelArgsMap on every call.
+typedef struct _kernelhandle_t
+{
+#if !defined(OPENARC_ARCH) || OPENARC_ARCH == 0
+	CUfunction kernel;
+#elif defined(OPENARC_ARCH) && OPENARC_ARCH == 5
+	hipFunction_t kernel;
+#elif defined(OPENARC_ARCH) && OPENARC_ARCH == 6
+#if defined(OPENARCRT_USE_BRISBANE) && OPENARCRT_USE_BRISBANE == 1
+	brisbane_kernel kernel;
+#else
+	iris_kernel kernel;
+#endif
+#else
+	cl_kernel kernel;
+#endif
+	kernelParams_t *kernelParams;
+	//Points to the kernel name stored in HostConf::HI_kernelIDMap.
+	const char *kernelName;
+} kernelhandle_t;
+
 #if defined(OPENARC_ARCH) && OPENARC_ARCH == 6
 #if defined(OPENARCRT_USE_BRISBANE) && OPENARCRT_USE_BRISBANE == 1
 typedef std::map<int, int> threadasyncmapbrisbane_t;
@@ -96,15 +192,15 @@ typedef class HipDriver: public Accelerator
 private:
     std::map<int,  hipStream_t> queueMap;
     std::map<int, eventmap_hip_t> threadQueueEventMap;
+    //Per-thread events used by HI_set_async() to order async streams after the default stream.
+    std::map<int, hipEvent_t> threadMarkerEventMap;
     //HI_error_t pin_host_memory(const void* hostPtr, size_t size, int threadID=NO_THREAD_ID);
     HI_error_t pin_host_memory_if_unpinned(const void* hostPtr, size_t size, int threadID=NO_THREAD_ID);
     //void unpin_host_memory(const void* hostPtr, int threadID=NO_THREAD_ID);
     void dec_pinned_host_memory_counter(const void* hostPtr);
     void inc_pinned_host_memory_counter(const void* hostPtr);
-    void unpin_host_memory_all(int asyncID, int threadID=NO_THREAD_ID);
-    void unpin_host_memory_all(int threadID=NO_THREAD_ID);
-	void release_freed_device_memory(int asyncID, int threadID=NO_THREAD_ID);
-	void release_freed_device_memory(int threadID=NO_THREAD_ID);
+	size_t evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID=NO_THREAD_ID);
+	size_t evict_victim_cache_entries(size_t size, int threadID=NO_THREAD_ID);
 public:
 	//Moved to Accelerator class.
     //std::set<std::string> kernelNameSet;
@@ -113,15 +209,14 @@ public:
     hipModule_t hipModule;
     //A map of pinned memory and its usage count. If count value is 0, then the runtime can unpin the host memory.
     static std::map<const void *,int> pinnedHostMemCounter;
-    static std::vector<const void *> hostMemToUnpin;
 
 public:
     HipDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char *baseFileName);
     HI_error_t init(int threadID=NO_THREAD_ID);
     HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
-    HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+    HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID);
     HI_error_t destroy(int threadID=NO_THREAD_ID);
     HI_error_t HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags=HI_MEM_READ_WRITE, int threadID=NO_THREAD_ID);
@@ -205,6 +300,9 @@ public:
 #if defined(OPENARCRT_USE_BRISBANE) && OPENARCRT_USE_BRISBANE == 1
 typedef class BrisbaneDriver: public Accelerator
 {
+private:
+	size_t evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID=NO_THREAD_ID);
+
 public:
 	//Moved to Accelerator class.
 	//std::set<std::string> kernelNameSet;
@@ -229,9 +327,9 @@ public:
     BrisbaneDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char *baseFileName);
     HI_error_t init(int threadID=NO_THREAD_ID);
     HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
-    HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+    HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID);
     HI_error_t destroy(int threadID=NO_THREAD_ID);
     HI_error_t HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags=HI_MEM_READ_WRITE, int threadID=NO_THREAD_ID);
@@ -292,6 +390,9 @@ public:
 #else
 typedef class IrisDriver: public Accelerator
 {
+private:
+	size_t evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID=NO_THREAD_ID);
+
 public:
 	//Moved to Accelerator class.
 	//std::set<std::string> kernelNameSet;
@@ -324,9 +425,9 @@ public:
     IrisDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char *baseFileName);
     HI_error_t init(int threadID=NO_THREAD_ID);
     HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
-    HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+    HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID);
     HI_error_t destroy(int threadID=NO_THREAD_ID);
     HI_error_t HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags=HI_MEM_READ_WRITE, int threadID=NO_THREAD_ID);
@@ -393,16 +494,16 @@ typedef class CudaDriver: public Accelerator
 private:
     std::map<int,  CUstream> queueMap;
     std::map<int, eventmap_cuda_t > threadQueueEventMap;
+    //Per-thread events used by HI_set_async() to order async streams after the default stream.
+    std::map<int, CUevent> threadMarkerEventMap;
 
     //HI_error_t pin_host_memory(const void* hostPtr, size_t size, int threadID=NO_THREAD_ID);
     HI_error_t pin_host_memory_if_unpinned(const void* hostPtr, size_t size, int threadID=NO_THREAD_ID);
     //void unpin_host_memory(const void* hostPtr, int threadID=NO_THREAD_ID);
     void dec_pinned_host_memory_counter(const void* hostPtr);
     void inc_pinned_host_memory_counter(const void* hostPtr);
-    void unpin_host_memory_all(int asyncID, int threadID=NO_THREAD_ID);
-    void unpin_host_memory_all(int threadID=NO_THREAD_ID);
-	void release_freed_device_memory(int asyncID, int threadID=NO_THREAD_ID);
-	void release_freed_device_memory(int threadID=NO_THREAD_ID);
+	size_t evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID=NO_THREAD_ID);
+	size_t evict_victim_cache_entries(size_t size, int threadID=NO_THREAD_ID);
 public:
 	//[DEBUG] changed to non-static variable.
 	//Moved to Accelerator class.
@@ -410,7 +511,6 @@ public:
 
     //A map of pinned memory and its usage count. If count value is 0, then the runtime can unpin the host memory.
     static std::map<CUdeviceptr,int> pinnedHostMemCounter;
-    static std::vector<const void *> hostMemToUnpin;
 
 	//[DEBUG] changed to non-static variable.
     //std::map<std::string, CUfunction> kernelMap;
@@ -421,9 +521,9 @@ public:
     CudaDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char *baseFileName);
     HI_error_t init(int threadID=NO_THREAD_ID);
     HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
-    HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+    HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_synchronize( int forcedSync = 0, int threadID=NO_THREAD_ID);
     HI_error_t destroy(int threadID=NO_THREAD_ID);
     HI_error_t HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags=HI_MEM_READ_WRITE, int threadID=NO_THREAD_ID);
@@ -509,6 +609,27 @@ typedef class OpenCLDriver: public Accelerator
 private:
     std::map<int,  cl_command_queue> queueMap;
     std::map<int, eventmap_opencl_t > threadQueueEventMap;
+    //Per-thread async queues with pending work.
+    std::map<int, activequeueset_t > threadActiveQueueMap;
+    //Per-thread state of the default queue used by HI_set_async().
+    std::map<int, defaultqueuemarker_t > threadDefaultQueueMarkerMap;
+    //If asyncQueuePoolSize > 0, the logical async queues (keyed as in 
+    //queueMap) share asyncQueuePoolSize physical command queues of the 
+    //device; protected by the HI_set_async() lock.
+    int asyncQueuePoolSize;
+    int asyncQueuePoolPolicy;
+    int asyncQueuePoolNext;
+    std::vector<asyncqueuepoolentry_t> asyncQueuePool;
+    std::map<int, int> asyncQueuePoolMap;
+
+    HI_error_t HI_memcpy_rect(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, cl_bool blocking, int async, int num_waits, int *waits, const char *callerName, int threadID);
+    size_t evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID=NO_THREAD_ID);
+    cl_command_queue map_pooled_async_queue(int asyncKey, int threadID=NO_THREAD_ID);
+    void count_queue_command(int async, HostConf_t *tconf);
+#ifdef _OPENARC_PROFILE_
+    void add_profiling_event(cl_event event, const char *kernelName, int threadID=NO_THREAD_ID);
+    void collect_profiling_events(bool waitForAll, int threadID=NO_THREAD_ID);
+#endif
 
 public:
 	//[DEBUG] changed to non-static variable.
@@ -519,13 +640,15 @@ public:
     static cl_context clContext;
     cl_command_queue clQueue;
     cl_program clProgram;
+    //Alignment in bytes required for the origin of a sub-buffer.
+    size_t memBaseAddrAlign;
 
     OpenCLDriver(acc_device_t devType, int devNum, std::set<std::string>kernelNames, HostConf_t *conf, int numDevices, const char * baseFileName);
     HI_error_t init(int threadID=NO_THREAD_ID);
     HI_error_t HI_register_kernels(std::set<std::string>kernelNames, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID=NO_THREAD_ID);
-    HI_error_t HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
-    HI_error_t HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_numargs(int kernel_id, int num_args, int threadID=NO_THREAD_ID);
+    HI_error_t HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID=NO_THREAD_ID);
+    HI_error_t HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async=DEFAULT_QUEUE, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_synchronize( int forcedSync = 0 , int threadID=NO_THREAD_ID);
     HI_error_t destroy(int threadID=NO_THREAD_ID);
     HI_error_t HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags=HI_MEM_READ_WRITE, int threadID=NO_THREAD_ID);
@@ -540,6 +663,8 @@ public:
     HI_error_t HI_memcpy_asyncS(void *dst, const void *src, size_t count, HI_MemcpyKind_t kind, int trType, int async, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
     HI_error_t HI_memcpy2D(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID);
     HI_error_t HI_memcpy2D_async(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int async, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
+    HI_error_t HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID=NO_THREAD_ID);
+    HI_error_t HI_memcpy3D_async(void *dst, size_t dpitch, const void *src, size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int async, int num_waits=0, int *waits=NULL, int threadID=NO_THREAD_ID);
 
 	//[DEBUG on April 15, 2021] tempPtr is changed to void * type because tempPtr variable itself can be freed before the pointed data are actually freed.
     void HI_tempFree( void* tempPtr, acc_device_t devType, int threadID=NO_THREAD_ID);
@@ -572,6 +697,8 @@ public:
     int HI_async_test_ifpresent(int asyncId, int threadID=NO_THREAD_ID);
     int HI_async_test_all(int threadID=NO_THREAD_ID);
     void HI_wait_for_events(int async, int num_waits, int* waits, int threadID=NO_THREAD_ID);
+    void HI_schedule_postponed_free(int asyncID, int threadID=NO_THREAD_ID);
+    void HI_reclaim_completed_frees(int threadID=NO_THREAD_ID);
 
     cl_command_queue getQueue(int async, int threadID) {
 		if( queueMap.count(async + 2) == 0 ) {
@@ -597,6 +724,29 @@ public:
 		}
     }
 
+    //Return the event slot of the async queue for the next enqueued command; 
+    //the slot holds the only runtime reference to the event of the last 
+    //command, which is released here before being overwritten.
+    cl_event * getNextEvent(int async, int threadID) {
+        cl_event *event = getEvent(async, threadID);
+        if( *event != NULL ) {
+            clReleaseEvent(*event);
+            *event = NULL;
+        }
+        setQueueActive(async, threadID);
+        return event;
+    }
+
+    //Track whether the async queue has commands or postponed frees that 
+    //HI_wait_all() and HI_async_test_all() have to check.
+    void setQueueActive(int async, int threadID) {
+        threadActiveQueueMap.at(threadID).insert(async + 2);
+    }
+
+    void setQueueIdle(int async, int threadID) {
+        threadActiveQueueMap.at(threadID).erase(async + 2);
+    }
+
 
 } OpenCLDriver_t;
 #endif
@@ -629,6 +779,26 @@ public:
 #endif
     static std::set<std::string> HI_kernelnames;
     std::set<std::string> kernelnames;
+    //HI_kernelIDMap assigns a process-wide integer ID to each kernel name 
+    //used by any host thread, and HI_kernelIDNames maps the ID back to the 
+    //name; both are protected by the same lock as HI_kernelnames.
+    //kernelIDs caches the IDs looked up by the current host thread, and 
+    //kernelNameIDs caches them by name pointer with a copy of the name, 
+    //which is compared to detect a pointer reused for another name.
+    static std::map<std::string, int> HI_kernelIDMap;
+    static std::vector<const char *> HI_kernelIDNames;
+    std::map<std::string, int> kernelIDs;
+    std::unordered_map<const char *, std::pair<std::string, int> > kernelNameIDs;
+    //Per-device launch handles indexed by kernel ID; kernelHandles caches the 
+    //handle vector of kernelHandlesDevice.
+    std::map<Accelerator *, std::vector<kernelhandle_t> > kernelHandlesMap;
+    Accelerator *kernelHandlesDevice;
+    std::vector<kernelhandle_t> *kernelHandles;
+#if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
+    //Postponed free reclaim requests pushed by completion callbacks, which 
+    //run on OpenCL runtime threads; updated only with atomic operations.
+    reclaimticket_t *reclaimTickets;
+#endif
 	std::string baseFileName;
 	//[CAUTION] Device instances (Accelerator_t objects) in devMap is shared 
 	//by multiple host threads.
@@ -648,6 +818,11 @@ public:
 		asyncID_offset = 0;
 		threadID = 0;
 		baseFileName = "openarc_kernel";
+		kernelHandlesDevice = NULL;
+		kernelHandles = NULL;
+#if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
+		reclaimTickets = NULL;
+#endif
 #ifdef _OPENARC_PROFILE_
         H2DMemTrCnt = 0;
         H2HMemTrCnt = 0;
@@ -668,6 +843,11 @@ public:
 		IPresentTableCnt = 0;
 		WaitCnt = 0;
 		RegKernelArgCnt = 0;
+		KernelArgSetCnt = 0;
+		KernelArgSkipCnt = 0;
+		AsyncQueueCnt = 0;
+		LogicalAsyncQueueCnt = 0;
+		AsyncQueueContentionCnt = 0;
 		BTaskCnt = 0;
         H2DMemTrSize = 0;
         H2HMemTrSize = 0;
@@ -742,6 +922,11 @@ public:
 	long IPresentTableCnt;
 	long WaitCnt;
 	long RegKernelArgCnt;
+	long KernelArgSetCnt;
+	long KernelArgSkipCnt;
+	long AsyncQueueCnt;
+	long LogicalAsyncQueueCnt;
+	long AsyncQueueContentionCnt;
 	long BTaskCnt;
     unsigned long H2DMemTrSize;
     unsigned long H2HMemTrSize;
@@ -775,12 +960,14 @@ public:
 	double totalRegKernelArgTime;
 	kernelcnt_t KernelCNTMap;
 	kerneltiming_t KernelTimingMap;
+#if defined(OPENARC_ARCH) && OPENARC_ARCH != 0 && OPENARC_ARCH != 5 && OPENARC_ARCH != 6
+	std::vector<profevent_t> pendingProfEvents;
+#endif
 #endif
 
 
     memstatusmap_t *hostmemstatusmaptable;
     memstatusmap_t *devicememstatusmaptable;
-    countermap_t  *prtcntmaptable;
 
     void HI_init(int devNum);
     void HI_reset();
@@ -789,6 +976,19 @@ public:
     void initKernelNames();
     void initKernelNames(int kernels, std::string kernelNames[]);
     void addKernelNames(int kernels, std::string kernelNames[]);
+    int getKernelID(const std::string &kernelName);
+    int getKernelID(const char *kernelName);
+    kernelhandle_t * resolveKernelHandle(Accelerator *dev, int kernelID);
+    void resetKernelHandles(Accelerator *dev);
+    kernelhandle_t * getKernelHandle(Accelerator *dev, int kernelID) {
+        if( (dev == kernelHandlesDevice) && (kernelID >= 0) && (kernelID < (int)kernelHandles->size()) ) {
+            kernelhandle_t *kernelHandle = &((*kernelHandles)[kernelID]);
+            if( kernelHandle->kernelParams != NULL ) {
+                return kernelHandle;
+            }
+        }
+        return resolveKernelHandle(dev, kernelID);
+    }
 
     int genOCL;
     void setTranslationType();
@@ -1,9 +1,14 @@
 #include "openacc.h"
 #include "openaccrt_ext.h"
+#include "kernel_source.h"
 #include "string.h"
 #include <algorithm>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <ctype.h>
+#include <sys/mman.h>
 
-#define MAX_SOURCE_SIZE (0x100000)
 #define AOCL_ALIGNMENT 64
 #define SHOW_ERROR_CODE
 
@@ -109,6 +114,618 @@ cl_mem_flags convert2CLMemFlags(HI_MallocKind_t flags) {
 	return mem_flags;
 }
 
+//////////////////////////////////
+// Async Queue Pool             //
+//////////////////////////////////
+static const char *openarcrt_async_queue_pool_size_env = "OPENARCRT_ASYNC_QUEUE_POOL_SIZE";
+static const char *openarcrt_async_queue_pool_policy_env = "OPENARCRT_ASYNC_QUEUE_POOL_POLICY";
+static const char *async_queue_pool_policy_roundrobin = "roundrobin";
+static const char *async_queue_pool_policy_leastloaded = "leastloaded";
+
+//////////////////////////////////
+// Persistent Program Cache     //
+//////////////////////////////////
+static const char *openarcrt_program_cache_dir_env = "OPENARCRT_PROGRAM_CACHE_DIR";
+
+//64-bit FNV-1a hash, used to key the program cache.
+static unsigned long long HI_hash_bytes(unsigned long long hash, const void *data, size_t size) {
+	const unsigned char *bytes = (const unsigned char *)data;
+	for( size_t i=0; i<size; i++ ) {
+		hash ^= (unsigned long long)bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	//Separate consecutive fields so that ("ab","c") and ("a","bc") differ.
+	hash ^= 0xffULL;
+	hash *= 0x100000001b3ULL;
+	return hash;
+}
+
+static unsigned long long HI_hash_device_info(unsigned long long hash, cl_device_id device, cl_device_info param) {
+	size_t sz = 0;
+	if( clGetDeviceInfo(device, param, 0, NULL, &sz) != CL_SUCCESS ) {
+		return HI_hash_bytes(hash, NULL, 0);
+	}
+	char *info = new char[sz+1];
+	clGetDeviceInfo(device, param, sz, info, NULL);
+	hash = HI_hash_bytes(hash, info, sz);
+	delete [] info;
+	return hash;
+}
+
+//Return the directories searched for the files included by the kernel 
+//source: the current directory and the -I directories of the build options.
+static std::vector<std::string> HI_get_include_dirs(const char *options) {
+	std::vector<std::string> includeDirs;
+	includeDirs.push_back(std::string("."));
+	if( options == NULL ) {
+		return includeDirs;
+	}
+	const char *p = options;
+	while( *p != '\0' ) {
+		while( isspace((unsigned char)*p) ) { p++; }
+		const char *start = p;
+		while( (*p != '\0') && !isspace((unsigned char)*p) ) { p++; }
+		std::string token(start, p - start);
+		if( token.compare(0, 2, "-I") != 0 ) {
+			continue;
+		}
+		if( token.size() > 2 ) {
+			includeDirs.push_back(token.substr(2));
+		} else {
+			while( isspace((unsigned char)*p) ) { p++; }
+			start = p;
+			while( (*p != '\0') && !isspace((unsigned char)*p) ) { p++; }
+			if( p > start ) {
+				includeDirs.push_back(std::string(start, p - start));
+			}
+		}
+	}
+	return includeDirs;
+}
+
+//Hash the files included by the kernel source (and the files they include),
+//so that a change in an included file such as resilience.cl invalidates the
+//cache entry. An included file is searched in includeDirs; if not found, 
+//only its name is hashed.
+static unsigned long long HI_hash_included_files(unsigned long long hash, const char *source, size_t sourceSize,
+		const std::vector<std::string> &includeDirs, std::set<std::string> &visited) {
+	const char *end = source + sourceSize;
+	const char *p = source;
+	while( p < end ) {
+		const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+		if( lineEnd == NULL ) {
+			lineEnd = end;
+		}
+		const char *q = p;
+		while( (q < lineEnd) && isspace((unsigned char)*q) ) { q++; }
+		if( (q < lineEnd) && (*q == '#') ) {
+			q++;
+			while( (q < lineEnd) && isspace((unsigned char)*q) ) { q++; }
+			if( (lineEnd - q > 7) && (strncmp(q, "include", 7) == 0) ) {
+				q += 7;
+				while( (q < lineEnd) && isspace((unsigned char)*q) ) { q++; }
+				char closing = (*q == '<') ? '>' : '"';
+				const char *nameEnd = ((*q == '"') || (*q == '<')) ? (const char *)memchr(q+1, closing, lineEnd - q - 1) : NULL;
+				if( nameEnd != NULL ) {
+					std::string name(q+1, nameEnd - q - 1);
+					hash = HI_hash_bytes(hash, name.c_str(), name.size());
+					for( size_t i=0; i<includeDirs.size(); i++ ) {
+						std::string path = (name[0] == '/') ? name : includeDirs[i] + std::string("/") + name;
+						size_t incSize = 0;
+						char *incSource = HI_load_kernel_source(path.c_str(), &incSize);
+						if( incSource != NULL ) {
+							//A file included more than once is hashed only the first time.
+							if( visited.insert(path).second ) {
+								hash = HI_hash_bytes(hash, incSource, incSize);
+								hash = HI_hash_included_files(hash, incSource, incSize, includeDirs, visited);
+							}
+							free(incSource);
+							break;
+						}
+					}
+				}
+			}
+		}
+		p = lineEnd + 1;
+	}
+	return hash;
+}
+
+//Create the directory and any missing parents.
+static bool HI_make_directory(const std::string &dirName) {
+	struct stat st;
+	if( dirName.empty() ) {
+		return false;
+	}
+	if( stat(dirName.c_str(), &st) == 0 ) {
+		return S_ISDIR(st.st_mode);
+	}
+	size_t pos = dirName.find_last_of('/');
+	if( (pos != std::string::npos) && (pos > 0) ) {
+		if( !HI_make_directory(dirName.substr(0, pos)) ) {
+			return false;
+		}
+	}
+	//Another process may have created it in the meantime.
+	return (mkdir(dirName.c_str(), 0755) == 0) || (errno == EEXIST);
+}
+
+//Return the program cache directory, or an empty string if the cache is disabled.
+static std::string HI_get_program_cache_dir() {
+	const char *envVar = getenv(openarcrt_program_cache_dir_env);
+	if( envVar != NULL ) {
+		if( (envVar[0] == '\0') || (strcmp(envVar, "none") == 0) ) {
+			return std::string("");
+		}
+		return std::string(envVar);
+	}
+	envVar = getenv("XDG_CACHE_HOME");
+	if( (envVar != NULL) && (envVar[0] != '\0') ) {
+		return std::string(envVar) + std::string("/openarc");
+	}
+	envVar = getenv("HOME");
+	if( (envVar != NULL) && (envVar[0] != '\0') ) {
+		return std::string(envVar) + std::string("/.cache/openarc");
+	}
+	return std::string("");
+}
+
+//Return the cache file name for the given kernel source (including the files
+//it includes), device, and build options, or an empty string if the cache is disabled or unavailable.
+static std::string HI_get_program_cache_file(const std::string &fileNameBase, const char *source, size_t sourceSize,
+		cl_device_id device, const char *platformName, const char *options) {
+	std::string cacheDir = HI_get_program_cache_dir();
+	if( cacheDir.empty() || !HI_make_directory(cacheDir) ) {
+		return std::string("");
+	}
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+	hash = HI_hash_bytes(hash, source, sourceSize);
+	std::set<std::string> visited;
+	hash = HI_hash_included_files(hash, source, sourceSize, HI_get_include_dirs(options), visited);
+	hash = HI_hash_bytes(hash, platformName, (platformName == NULL) ? 0 : strlen(platformName));
+	hash = HI_hash_device_info(hash, device, CL_DEVICE_NAME);
+	hash = HI_hash_device_info(hash, device, CL_DEVICE_VERSION);
+	hash = HI_hash_device_info(hash, device, CL_DRIVER_VERSION);
+	hash = HI_hash_bytes(hash, options, (options == NULL) ? 0 : strlen(options));
+	std::string baseName = fileNameBase;
+	size_t pos = baseName.find_last_of('/');
+	if( pos != std::string::npos ) {
+		baseName = baseName.substr(pos+1);
+	}
+	char hashStr[32];
+	snprintf(hashStr, sizeof(hashStr), "%016llx", hash);
+	return cacheDir + std::string("/") + baseName + std::string("_") + hashStr + std::string(".clbin");
+}
+
+//Build the program from a cached binary; return false if there is no usable
+//cache entry so that the caller falls back to building from source.
+static bool HI_load_program_cache(const std::string &cacheFile, cl_context context, cl_device_id device,
+		const char *options, cl_program *program) {
+	FILE *fp = fopen(cacheFile.c_str(), "rb");
+	if( fp == NULL ) {
+		return false;
+	}
+	fseek(fp, 0, SEEK_END);
+	long fileSize = ftell(fp);
+	rewind(fp);
+	if( fileSize <= 0 ) {
+		fclose(fp);
+		return false;
+	}
+	size_t binarySize = (size_t)fileSize;
+	unsigned char *programBinary = new unsigned char[binarySize];
+	size_t readSize = fread(programBinary, 1, binarySize, fp);
+	fclose(fp);
+	if( readSize != binarySize ) {
+		delete [] programBinary;
+		return false;
+	}
+	cl_int err;
+	cl_int binaryStatus;
+	cl_program tProgram = clCreateProgramWithBinary(context, 1, &device, &binarySize, (const unsigned char**)&programBinary,
+			&binaryStatus, &err);
+	delete [] programBinary;
+	if( (err != CL_SUCCESS) || (binaryStatus != CL_SUCCESS) ) {
+		if( tProgram != NULL ) {
+			clReleaseProgram(tProgram);
+		}
+		return false;
+	}
+	err = clBuildProgram(tProgram, 1, &device, options, NULL, NULL);
+	if( err != CL_SUCCESS ) {
+		clReleaseProgram(tProgram);
+		return false;
+	}
+	*program = tProgram;
+	return true;
+}
+
+//Save the program binary into the cache. The binary is written to a unique 
+//temporary file and renamed into place, so concurrent processes populating 
+//the same entry never observe a partially written file.
+static void HI_store_program_cache(const std::string &cacheFile, cl_program program) {
+	size_t size = 0;
+	cl_int err = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &size, NULL);
+	if( (err != CL_SUCCESS) || (size == 0) ) {
+		return;
+	}
+	unsigned char *binary = new unsigned char[size];
+	err = clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char *), &binary, NULL);
+	if( err != CL_SUCCESS ) {
+		delete [] binary;
+		return;
+	}
+	std::string tmpFile = cacheFile + std::string(".XXXXXX");
+	char *tmpName = new char[tmpFile.size()+1];
+	strcpy(tmpName, tmpFile.c_str());
+	int fd = mkstemp(tmpName);
+	if( fd >= 0 ) {
+		bool success = (fchmod(fd, 0644) == 0);
+		size_t written = 0;
+		while( success && (written < size) ) {
+			ssize_t ret = write(fd, binary+written, size-written);
+			if( ret < 0 ) {
+				if( errno != EINTR ) {
+					success = false;
+				}
+			} else {
+				written += ret;
+			}
+		}
+		if( close(fd) != 0 ) {
+			success = false;
+		}
+		if( !success || (rename(tmpName, cacheFile.c_str()) != 0) ) {
+			unlink(tmpName);
+		}
+	}
+	delete [] tmpName;
+	delete [] binary;
+}
+
+//Fake device pointers, which identify OpenCL buffers in the device memory 
+//handle table, are carved out of PROT_NONE address-space reservations 
+//instead of being allocated from the host heap. They are unique and 
+//support interior-pointer arithmetic like real allocations, but consume 
+//no host memory, and their allocation cost does not depend on their size.
+//If no address space can be reserved, malloc() is used as before.
+#define FAKE_DEVICE_ADDRESS_ALIGNMENT 4096
+#define FAKE_DEVICE_ADDRESS_REGION_SIZE (((size_t)1) << 40)
+
+typedef std::map<char *, size_t> fakeaddressmap_t;
+//Reserved regions, fake pointers in use, and free ranges (address to size).
+static fakeaddressmap_t fakeAddressRegions;
+static fakeaddressmap_t fakeAddressUsed;
+static fakeaddressmap_t fakeAddressFree;
+static std::multimap<size_t, char *> fakeAddressFreeBySize;
+#ifdef _THREAD_SAFETY
+static pthread_mutex_t mutex_fake_address = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void HI_erase_fake_address_range(char *ptr, size_t size) {
+	std::pair<std::multimap<size_t, char *>::iterator, std::multimap<size_t, char *>::iterator> range = fakeAddressFreeBySize.equal_range(size);
+	for( std::multimap<size_t, char *>::iterator it = range.first; it != range.second; ++it ) {
+		if( it->second == ptr ) {
+			fakeAddressFreeBySize.erase(it);
+			break;
+		}
+	}
+	fakeAddressFree.erase(ptr);
+}
+
+//Add a free range, coalescing it with adjacent free ranges.
+static void HI_insert_fake_address_range(char *ptr, size_t size) {
+	fakeaddressmap_t::iterator next = fakeAddressFree.lower_bound(ptr);
+	if( (next != fakeAddressFree.end()) && (ptr + size == next->first) ) {
+		size += next->second;
+		HI_erase_fake_address_range(next->first, next->second);
+	}
+	fakeaddressmap_t::iterator prev = fakeAddressFree.lower_bound(ptr);
+	if( prev != fakeAddressFree.begin() ) {
+		--prev;
+		if( prev->first + prev->second == ptr ) {
+			ptr = prev->first;
+			size += prev->second;
+			HI_erase_fake_address_range(prev->first, prev->second);
+		}
+	}
+	fakeAddressFree[ptr] = size;
+	fakeAddressFreeBySize.insert(std::pair<size_t, char *>(size, ptr));
+}
+
+//Reserve a new region of at least size bytes; try smaller regions if the 
+//address space is limited (e.g., by ulimit -v).
+static bool HI_reserve_fake_address_region(size_t size) {
+	size_t regionSize = (size > FAKE_DEVICE_ADDRESS_REGION_SIZE) ? size : FAKE_DEVICE_ADDRESS_REGION_SIZE;
+	while( true ) {
+		void *region = mmap(NULL, regionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if( region != MAP_FAILED ) {
+			fakeAddressRegions[(char *)region] = regionSize;
+			HI_insert_fake_address_range((char *)region, regionSize);
+			return true;
+		}
+		if( regionSize == size ) {
+			return false;
+		}
+		regionSize = ((regionSize >> 1) > size) ? (regionSize >> 1) : size;
+	}
+}
+
+static void * HI_malloc_fake_device_address(size_t size) {
+	size_t alignedSize = (size == 0) ? FAKE_DEVICE_ADDRESS_ALIGNMENT : 
+		((size + FAKE_DEVICE_ADDRESS_ALIGNMENT - 1) / FAKE_DEVICE_ADDRESS_ALIGNMENT) * FAKE_DEVICE_ADDRESS_ALIGNMENT;
+	char *ptr = NULL;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_fake_address);
+#else
+#ifdef _OPENMP
+	#pragma omp critical(fake_address_critical)
+#endif
+#endif
+	{
+		//Best fit among the free ranges.
+		std::multimap<size_t, char *>::iterator it = fakeAddressFreeBySize.lower_bound(alignedSize);
+		if( (it == fakeAddressFreeBySize.end()) && HI_reserve_fake_address_region(alignedSize) ) {
+			it = fakeAddressFreeBySize.lower_bound(alignedSize);
+		}
+		if( it != fakeAddressFreeBySize.end() ) {
+			ptr = it->second;
+			size_t freeSize = it->first;
+			HI_erase_fake_address_range(ptr, freeSize);
+			if( freeSize > alignedSize ) {
+				HI_insert_fake_address_range(ptr + alignedSize, freeSize - alignedSize);
+			}
+			fakeAddressUsed[ptr] = alignedSize;
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_fake_address);
+#endif
+	if( ptr == NULL ) {
+		return malloc(size);
+	}
+	return (void *)ptr;
+}
+
+static void HI_free_fake_device_address(void *devPtr) {
+	char *ptr = (char *)devPtr;
+	bool reserved = false;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_fake_address);
+#else
+#ifdef _OPENMP
+	#pragma omp critical(fake_address_critical)
+#endif
+#endif
+	{
+		fakeaddressmap_t::iterator it = fakeAddressUsed.find(ptr);
+		if( it != fakeAddressUsed.end() ) {
+			HI_insert_fake_address_range(ptr, it->second);
+			fakeAddressUsed.erase(it);
+			reserved = true;
+		} else {
+			fakeaddressmap_t::iterator rit = fakeAddressRegions.upper_bound(ptr);
+			if( rit != fakeAddressRegions.begin() ) {
+				--rit;
+				reserved = (ptr < rit->first + rit->second);
+			}
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_fake_address);
+#endif
+	if( !reserved ) {
+		free(devPtr);
+	}
+}
+
+//Kernel arguments are memoized per kernel (and thus per host thread, since 
+//each host thread creates its own cl_kernel objects), and clSetKernelArg() 
+//is skipped if an argument is set to the same bytes again. A released 
+//buffer handle may be reused by a later allocation, so every buffer release 
+//bumps memObjectGeneration, which forces buffer arguments to be set again.
+static unsigned long memObjectGeneration = 0;
+
+//Sub-buffers created for kernel arguments that point into the middle of a 
+//device buffer are cached per parent buffer, keyed by region and flags, 
+//and reused by later launches; they are released together with their 
+//parent buffer, or one at a time in LRU order when the parent has too many 
+//of them. A sub-buffer is pinned from HI_register_kernel_arg() until the 
+//kernel is enqueued (the enqueued kernel retains it), and pinned 
+//sub-buffers are never evicted, since a kernel argument does not retain 
+//the memory object it is set to.
+#define SUB_BUFFER_CACHE_MAX_PER_BUFFER 64
+
+typedef struct _subbufferkey_t
+{
+	size_t origin;
+	size_t size;
+	cl_mem_flags flags;
+	bool operator<(const struct _subbufferkey_t &other) const {
+		if( origin != other.origin ) {
+			return origin < other.origin;
+		} else if( size != other.size ) {
+			return size < other.size;
+		} else {
+			return flags < other.flags;
+		}
+	}
+} subbufferkey_t;
+
+typedef struct _subbufferentry_t
+{
+	cl_mem subBuffer;
+	unsigned long lastUse;
+} subbufferentry_t;
+
+typedef std::map<subbufferkey_t, subbufferentry_t> subbuffermap_t;
+static std::map<cl_mem, subbuffermap_t> subBufferCache;
+//Number of pending kernel arguments set to each pinned sub-buffer.
+static std::map<cl_mem, int> pinnedSubBuffers;
+static unsigned long subBufferClock = 0;
+#ifdef _THREAD_SAFETY
+static pthread_mutex_t mutex_sub_buffer_cache = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static cl_int HI_release_mem_object(cl_mem memObject) {
+	std::vector<cl_mem> subBuffers;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_sub_buffer_cache);
+#else
+#ifdef _OPENMP
+	#pragma omp critical(sub_buffer_cache_critical)
+#endif
+#endif
+	{
+		std::map<cl_mem, subbuffermap_t>::iterator it = subBufferCache.find(memObject);
+		if( it != subBufferCache.end() ) {
+			for( subbuffermap_t::iterator sit = it->second.begin(); sit != it->second.end(); ++sit ) {
+				subBuffers.push_back(sit->second.subBuffer);
+				pinnedSubBuffers.erase(sit->second.subBuffer);
+			}
+			subBufferCache.erase(it);
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_sub_buffer_cache);
+#endif
+	for( size_t i=0; i<subBuffers.size(); i++ ) {
+		clReleaseMemObject(subBuffers[i]);
+	}
+	cl_int err = clReleaseMemObject(memObject);
+	__atomic_add_fetch(&memObjectGeneration, 1, __ATOMIC_RELAXED);
+	return err;
+}
+
+//Return a pinned sub-buffer of the parent buffer covering the given region, 
+//creating and caching it if needed; the caller should unpin it with 
+//HI_unpin_sub_buffer() once the kernel using it is enqueued.
+static cl_mem HI_get_sub_buffer(cl_mem parent, size_t origin, size_t size, cl_mem_flags flags, cl_int *err) {
+	subbufferkey_t key;
+	key.origin = origin;
+	key.size = size;
+	key.flags = flags;
+	cl_mem subBuffer = NULL;
+	cl_mem evictedSubBuffer = NULL;
+	*err = CL_SUCCESS;
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_sub_buffer_cache);
+#else
+#ifdef _OPENMP
+	#pragma omp critical(sub_buffer_cache_critical)
+#endif
+#endif
+	{
+		subbuffermap_t &subBuffers = subBufferCache[parent];
+		subbuffermap_t::iterator it = subBuffers.find(key);
+		if( it != subBuffers.end() ) {
+			subBuffer = it->second.subBuffer;
+			it->second.lastUse = subBufferClock++;
+		} else {
+			if( subBuffers.size() >= SUB_BUFFER_CACHE_MAX_PER_BUFFER ) {
+				//Evict the least recently used sub-buffer that is not pinned; 
+				//if all are pinned, the cache grows beyond the limit.
+				subbuffermap_t::iterator lruIt = subBuffers.end();
+				for( it = subBuffers.begin(); it != subBuffers.end(); ++it ) {
+					if( (pinnedSubBuffers.count(it->second.subBuffer) == 0) 
+						&& ((lruIt == subBuffers.end()) || (it->second.lastUse < lruIt->second.lastUse)) ) {
+						lruIt = it;
+					}
+				}
+				if( lruIt != subBuffers.end() ) {
+					evictedSubBuffer = lruIt->second.subBuffer;
+					subBuffers.erase(lruIt);
+				}
+			}
+			cl_buffer_region region;
+			region.origin = origin;
+			region.size = size;
+			subBuffer = clCreateSubBuffer(parent, flags, CL_BUFFER_CREATE_TYPE_REGION, &region, err);
+			if( *err == CL_SUCCESS ) {
+				subbufferentry_t entry;
+				entry.subBuffer = subBuffer;
+				entry.lastUse = subBufferClock++;
+				subBuffers[key] = entry;
+			}
+		}
+		if( *err == CL_SUCCESS ) {
+			pinnedSubBuffers[subBuffer]++;
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_sub_buffer_cache);
+#endif
+	//The evicted sub-buffer is not set to any pending kernel argument, and 
+	//kernels launched earlier retain it, so it can be released right away.
+	if( evictedSubBuffer != NULL ) {
+		HI_release_mem_object(evictedSubBuffer);
+	}
+	return subBuffer;
+}
+
+//Drop a pin taken by HI_get_sub_buffer().
+static void HI_unpin_sub_buffer(cl_mem subBuffer) {
+#ifdef _THREAD_SAFETY
+	pthread_mutex_lock(&mutex_sub_buffer_cache);
+#else
+#ifdef _OPENMP
+	#pragma omp critical(sub_buffer_cache_critical)
+#endif
+#endif
+	{
+		std::map<cl_mem, int>::iterator it = pinnedSubBuffers.find(subBuffer);
+		if( (it != pinnedSubBuffers.end()) && (--(it->second) == 0) ) {
+			pinnedSubBuffers.erase(it);
+		}
+	}
+#ifdef _THREAD_SAFETY
+	pthread_mutex_unlock(&mutex_sub_buffer_cache);
+#endif
+}
+
+//Return true if the argument already holds the given value; otherwise, 
+//record the value as the new argument state and return false.
+static bool HI_check_kernel_arg_state(kernelargstate_t *argState, size_t argSize, const void *argValue, int isBuffer) {
+	unsigned long generation = 0;
+	if( isBuffer ) {
+		generation = __atomic_load_n(&memObjectGeneration, __ATOMIC_RELAXED);
+	}
+	if( (argState->size == argSize) && (argState->isBuffer == isBuffer) && (argState->memGeneration == generation) 
+		&& (memcmp(argState->value, argValue, argSize) == 0) ) {
+		return true;
+	}
+	if( argState->capacity < argSize ) {
+		free(argState->value);
+		argState->value = malloc(argSize);
+		argState->capacity = argSize;
+	}
+	memcpy(argState->value, argValue, argSize);
+	argState->size = argSize;
+	argState->isBuffer = isBuffer;
+	argState->memGeneration = generation;
+	return false;
+}
+
+//Create a command queue; in profiling builds, event timestamps are enabled 
+//so that kernels and transfers can be timed without serializing the queues.
+static cl_command_queue HI_create_command_queue(cl_context context, cl_device_id device, cl_int *err) {
+#ifdef _OPENARC_PROFILE_
+	//[DEBUG on Feb. 9, 2021] clCreateCommandQueue() is deprecated on OpenCL V2.0
+#if defined(CL_VERSION_2_0)
+	cl_queue_properties properties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
+	return clCreateCommandQueueWithProperties(context, device, properties, err);
+#else
+	return clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, err);
+#endif
+#else
+#if defined(CL_VERSION_2_0)
+	return clCreateCommandQueueWithProperties(context, device, NULL, err);
+#else
+	return clCreateCommandQueue(context, device, 0, err);
+#endif
+#endif
+}
+
 ///////////////////////////
 // Device Initialization //
 ///////////////////////////
@@ -122,6 +739,41 @@ OpenCLDriver::OpenCLDriver(acc_device_t devType, int devNum, std::set<std::strin
     device_num = devNum;
 	num_devices = numDevices;
 	fileNameBase = std::string(baseFileName);
+	current_mempool_size = 0;
+	memBaseAddrAlign = 1;
+
+	//Map logical async queues onto a bounded pool of command queues if 
+	//requested.
+	asyncQueuePoolSize = 0;
+	asyncQueuePoolPolicy = ASYNC_QUEUE_POOL_ROUNDROBIN;
+	asyncQueuePoolNext = 0;
+	const char *envVar = getenv(openarcrt_async_queue_pool_size_env);
+	if( envVar != NULL ) {
+		asyncQueuePoolSize = atoi(envVar);
+		if( asyncQueuePoolSize < 0 ) {
+			asyncQueuePoolSize = 0;
+		}
+	}
+	envVar = getenv(openarcrt_async_queue_pool_policy_env);
+	if( envVar == NULL ) {
+		envVar = async_queue_pool_policy_roundrobin;
+	} else if( strcmp(envVar, async_queue_pool_policy_leastloaded) == 0 ) {
+		asyncQueuePoolPolicy = ASYNC_QUEUE_POOL_LEASTLOADED;
+	} else if( strcmp(envVar, async_queue_pool_policy_roundrobin) != 0 ) {
+		fprintf(stderr, "[OPENARCRT-WARNING in OpenCLDriver::OpenCLDriver()] unknown async queue pool policy (%s); %s is used instead.\n", envVar, async_queue_pool_policy_roundrobin);
+		envVar = async_queue_pool_policy_roundrobin;
+	}
+	if( asyncQueuePoolSize > 0 ) {
+		asyncqueuepoolentry_t poolEntry;
+		poolEntry.queue = NULL;
+		poolEntry.numBound = 0;
+		asyncQueuePool.resize(asyncQueuePoolSize, poolEntry);
+#ifdef _OPENARC_PROFILE_
+		if( HI_openarcrt_verbosity > 0 ) {
+			fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::OpenCLDriver(): async queues are mapped onto %d command queues (policy: %s)\n", asyncQueuePoolSize, envVar);
+		}
+#endif
+	}
 
     for (std::set<std::string>::iterator it = kernelNames.begin() ; it != kernelNames.end(); ++it) {
         kernelNameSet.insert(*it);
@@ -134,9 +786,8 @@ OpenCLDriver::OpenCLDriver(acc_device_t devType, int devNum, std::set<std::strin
 }
 
 HI_error_t OpenCLDriver::init(int threadID) {
-    FILE *fp;
-    char *source_str;
-    size_t source_size;
+    char *source_str = NULL;
+    size_t source_size = 0;
 	std::string outFile = fileNameBase + std::string(".cl");
     const char *filename = outFile.c_str();
 	char kernel_keyword[] = "__kernel";
@@ -344,21 +995,29 @@ HI_error_t OpenCLDriver::init(int threadID) {
     clDevice = devices[device_num];
     char cBuffer1[1024];
     clGetDeviceInfo(clDevice, CL_DEVICE_NAME, sizeof(cBuffer1), &cBuffer1, NULL);
+    cl_uint memBaseAddrAlignBits = 0;
+    if( (clGetDeviceInfo(clDevice, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &memBaseAddrAlignBits, NULL) == CL_SUCCESS) && (memBaseAddrAlignBits >= 8) ) {
+		memBaseAddrAlign = memBaseAddrAlignBits/8;
+	}
     int thread_id = tconf->threadID;
 #ifdef _OPENARC_PROFILE_
     fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::init(): host Thread %d initializes device %d: %s\n", thread_id, device_num, cBuffer1);
 #endif
-    fp = fopen(filename, "r");
-    if (!fp) {
+#ifdef _OPENARC_PROFILE_
+    double ltime = HI_get_localtime();
+#endif
+    source_str = HI_load_kernel_source(filename, &source_size);
+    if (source_str == NULL) {
     	if(dev != acc_device_altera || dev != acc_device_altera_emulator) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::init()] Failed to read the kernel file %s.\n", filename);
 			exit(1);
 		}
-    } else {
-    	source_str = (char*)malloc(MAX_SOURCE_SIZE);
-    	source_size = fread( source_str, 1, MAX_SOURCE_SIZE, fp);
-    	fclose( fp );
+    }
+#ifdef _OPENARC_PROFILE_
+	else if( HI_openarcrt_verbosity > 0 ) {
+    	fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::init(): host Thread %d loaded the kernel file %s (%lu bytes) in %lf sec\n", thread_id, filename, (unsigned long)source_size, HI_get_localtime() - ltime);
 	}
+#endif
 
 #ifdef _THREAD_SAFETY
         pthread_mutex_lock(&mutex_clContext);
@@ -406,61 +1065,56 @@ HI_error_t OpenCLDriver::init(int threadID) {
 		} else {
 			if( strstr(source_str, kernel_keyword) != NULL ) { 
 				//Compile the kernel file only if a kernel exists.
-        		clProgram = clCreateProgramWithSource(clContext, 1, (const char **)&source_str, (const size_t *)&source_size, &err);
-        		if(err != CL_SUCCESS) {
-            		fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL program with error %d (%s)\n", err, opencl_error_code(err));
-					exit(1);
-        		}
-
 				char *envVar;
 				envVar = getenv("OPENARC_JITOPTION");
-       			err = clBuildProgram(clProgram, 1, &clDevice, envVar, NULL, NULL);
-        		if(err != CL_SUCCESS)
-				{
-            		printf("[ERROR in OpenCLDriver::init()] Error in clBuildProgram, Line %u in file %s : %d (%s)!!!\n\n", __LINE__, __FILE__, err, opencl_error_code(err));
-            		if (err == CL_BUILD_PROGRAM_FAILURE)
-            		{
-                		// Determine the size of the log
-                		size_t log_size;
-                		clGetProgramBuildInfo(clProgram, clDevice, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+#ifdef _OPENARC_PROFILE_
+				ltime = HI_get_localtime();
+#endif
+				//Reuse the program binary cached by an earlier run if the kernel 
+				//source, the device, and the build options are all unchanged.
+				std::string cacheFile = HI_get_program_cache_file(fileNameBase, source_str, source_size, clDevice, platformName, envVar);
+				bool cacheHit = false;
+				if( !cacheFile.empty() ) {
+					cacheHit = HI_load_program_cache(cacheFile, clContext, clDevice, envVar, &clProgram);
+				}
+				if( !cacheHit ) {
+	        		clProgram = clCreateProgramWithSource(clContext, 1, (const char **)&source_str, (const size_t *)&source_size, &err);
+	        		if(err != CL_SUCCESS) {
+	            		fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL program with error %d (%s)\n", err, opencl_error_code(err));
+						exit(1);
+	        		}
+
+	       			err = clBuildProgram(clProgram, 1, &clDevice, envVar, NULL, NULL);
+	        		if(err != CL_SUCCESS)
+					{
+	            		printf("[ERROR in OpenCLDriver::init()] Error in clBuildProgram, Line %u in file %s : %d (%s)!!!\n\n", __LINE__, __FILE__, err, opencl_error_code(err));
+	            		if (err == CL_BUILD_PROGRAM_FAILURE)
+	            		{
+	                		// Determine the size of the log
+	                		size_t log_size;
+	                		clGetProgramBuildInfo(clProgram, clDevice, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
 	
-                		// Allocate memory for the log
-                		char *log = (char *) malloc(log_size);
+	                		// Allocate memory for the log
+	                		char *log = (char *) malloc(log_size);
 	
-                		// Get the log
-                		clGetProgramBuildInfo(clProgram, clDevice, CL_PROGRAM_BUILD_LOG, log_size, log, NULL);
+	                		// Get the log
+	                		clGetProgramBuildInfo(clProgram, clDevice, CL_PROGRAM_BUILD_LOG, log_size, log, NULL);
 	
-                		// Print the log
-                		printf("%s\n", log);
-            		}
-            		exit(1);
-        		}
-
-#if 0 /* disabled by JK */
-        		size_t size;
-        		err = clGetProgramInfo( clProgram, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &size, NULL );
-        		if(err != CL_SUCCESS) {
-            		fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to get OPENCL program info error %d (%s)\n", err, opencl_error_code(err));
-					exit(1);
-        		}
-
-        		unsigned char * binary = new unsigned char [size];
-
-#if !defined(OPENARC_ARCH) || OPENARC_ARCH == 0
-        		err = clGetProgramInfo( clProgram, CL_PROGRAM_BINARIES, size, &binary, NULL );
-#else
-        		err = clGetProgramInfo(clProgram, CL_PROGRAM_BINARIES, sizeof(unsigned char *), &binary, NULL);
-#endif
-
-        		if(err != CL_SUCCESS) {
-            		fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to dump OPENCL program binary error %d (%s)\n", err, opencl_error_code(err));
-					exit(1);
-        		}
-
-        		FILE * fpbin = fopen(binaryName.c_str(), "wb" );
-        		fwrite(binary, 1 , size, fpbin);
-        		fclose(fpbin);
-        		delete[] binary;
+	                		// Print the log
+	                		printf("%s\n", log);
+	            		}
+	            		exit(1);
+	        		}
+
+					if( !cacheFile.empty() ) {
+						HI_store_program_cache(cacheFile, clProgram);
+					}
+				}
+#ifdef _OPENARC_PROFILE_
+				if( HI_openarcrt_verbosity > 0 ) {
+    				fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::init(): host Thread %d built the kernel program for device %d in %lf sec (program cache %s%s)\n", thread_id, device_num, HI_get_localtime() - ltime, 
+						cacheFile.empty() ? "disabled" : (cacheHit ? "hit: " : "miss: "), cacheFile.c_str());
+				}
 #endif
 			} else {
 				clProgram = NULL;
@@ -521,25 +1175,20 @@ HI_error_t OpenCLDriver::init(int threadID) {
         }
 
     }
+	if( source_str != NULL ) {
+		free(source_str);
+	}
 
     cl_command_queue s0, s1;
     cl_event e0, e1;
 	//for ( int i=0; i<HI_num_hostthreads; i++ ) {
 		//[DEBUG on Feb. 9, 2021] clCreateCommandQueue() is deprecated on OpenCL V2.0
-#if defined(CL_VERSION_2_0) 
-    	s0 = clCreateCommandQueueWithProperties(clContext, clDevice, NULL, &err);
-#else
-    	s0 = clCreateCommandQueue(clContext, clDevice, 0, &err);
-#endif
+    	s0 = HI_create_command_queue(clContext, clDevice, &err);
     	if(err != CL_SUCCESS) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
 			exit(1);
     	}
-#if defined(CL_VERSION_2_0)
-    	s1 = clCreateCommandQueueWithProperties(clContext, clDevice, NULL, &err);
-#else
-    	s1 = clCreateCommandQueue(clContext, clDevice, 0, &err);
-#endif
+    	s1 = HI_create_command_queue(clContext, clDevice, &err);
     	if(err != CL_SUCCESS) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
 			exit(1);
@@ -568,12 +1217,15 @@ HI_error_t OpenCLDriver::init(int threadID) {
     	eventMap[0+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e0;
     	eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
     	threadQueueEventMap[thread_id] = eventMap;
-		masterAddressTableMap[thread_id] = new addresstable_t();
+    	threadActiveQueueMap[thread_id] = activequeueset_t(thread_id*MAX_NUM_QUEUES_PER_THREAD);
+    	threadDefaultQueueMarkerMap[thread_id] = defaultqueuemarker_t();
+		masterAddressTableMap[thread_id] = new presenttable_t();
 		masterHandleTable[thread_id] = new memhandlemap_t();
 		postponedFreeTableMap[thread_id] = new asyncfreetable_t();
 		postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
 		postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-		memPoolMap[thread_id] = new memPool_t();
+		postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+		memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
 		tempMallocSizeMap[thread_id] = new sizemap_t();
 	//}
 
@@ -645,24 +1297,17 @@ HI_error_t OpenCLDriver::createKernelArgMap(int threadID) {
     }
 	tconf->kernelArgsMap[this] = kernelArgs;
     tconf->kernelsMap[this]=kernelMap;
+    tconf->resetKernelHandles(this);
 
     int thread_id = tconf->threadID;
     if( queueMap.count(0+thread_id*MAX_NUM_QUEUES_PER_THREAD) == 0 ) {
     	cl_command_queue s0, s1;
-#if defined(CL_VERSION_2_0)
-    	s0 = clCreateCommandQueueWithProperties(clContext, clDevice, NULL, &err);
-#else
-    	s0 = clCreateCommandQueue(clContext, clDevice, 0, &err);
-#endif
+    	s0 = HI_create_command_queue(clContext, clDevice, &err);
     	if(err != CL_SUCCESS) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
 			exit(1);
     	}
-#if defined(CL_VERSION_2_0)
-    	s1 = clCreateCommandQueueWithProperties(clContext, clDevice, NULL, &err);
-#else
-    	s1 = clCreateCommandQueue(clContext, clDevice, 0, &err);
-#endif
+    	s1 = HI_create_command_queue(clContext, clDevice, &err);
     	if(err != CL_SUCCESS) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::init()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
 			exit(1);
@@ -695,12 +1340,15 @@ HI_error_t OpenCLDriver::createKernelArgMap(int threadID) {
     	eventMap[0+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e0;
     	eventMap[1+thread_id*MAX_NUM_QUEUES_PER_THREAD]= e1;
     	threadQueueEventMap[thread_id] = eventMap;
-		masterAddressTableMap[thread_id] = new addresstable_t();
+    	threadActiveQueueMap[thread_id] = activequeueset_t(thread_id*MAX_NUM_QUEUES_PER_THREAD);
+    	threadDefaultQueueMarkerMap[thread_id] = defaultqueuemarker_t();
+		masterAddressTableMap[thread_id] = new presenttable_t();
 		masterHandleTable[thread_id] = new memhandlemap_t();
 		postponedFreeTableMap[thread_id] = new asyncfreetable_t();
 		postponedTempFreeTableMap[thread_id] = new asynctempfreetable_t();
 		postponedTempFreeTableMap2[thread_id] = new asynctempfreetable2_t();
-		memPoolMap[thread_id] = new memPool_t();
+		postponedFreeInfoMap[thread_id] = new postponedfreeinfo_t();
+		memPoolMap[thread_id] = new memPool_t(HI_mempool_frag_limit);
 		tempMallocSizeMap[thread_id] = new sizemap_t();
 	}
 
@@ -981,6 +1629,10 @@ HI_error_t OpenCLDriver::destroy(int threadID) {
     cl_int err;
 
 	for( std::map<int, cl_command_queue >::iterator it= queueMap.begin(); it != queueMap.end(); ++it ) {
+		//Command queues of the async queue pool are shared; release them once below.
+		if( asyncQueuePoolMap.count(it->first) > 0 ) {
+			continue;
+		}
     	err = clFlush(it->second);
     	if(err != CL_SUCCESS) {
         	fprintf(stderr, "[ERROR in OpenCLDriver::destroy()] failed to flush OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
@@ -1000,6 +1652,26 @@ HI_error_t OpenCLDriver::destroy(int threadID) {
         	return HI_error;
     	}
 	}
+	for( std::vector<asyncqueuepoolentry_t>::iterator it= asyncQueuePool.begin(); it != asyncQueuePool.end(); ++it ) {
+		if( it->queue == NULL ) {
+			continue;
+		}
+    	err = clFinish(it->queue);
+    	if(err != CL_SUCCESS) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::destroy()] failed to finish OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
+			exit(1);
+        	return HI_error;
+    	}
+    	err = clReleaseCommandQueue(it->queue);
+    	if(err != CL_SUCCESS) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::destroy()] failed to release OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
+			exit(1);
+        	return HI_error;
+    	}
+		it->queue = NULL;
+		it->numBound = 0;
+	}
+	asyncQueuePoolMap.clear();
 
     std::map<std::string, cl_kernel> kernels = tconf->kernelsMap.at(this);
     for(std::map<std::string, cl_kernel>::iterator it=kernels.begin(); it!=kernels.end(); ++it) {
@@ -1053,6 +1725,43 @@ HI_error_t OpenCLDriver::destroy(int threadID) {
 }
 
 
+//Return the least recently freed chunks in the memory pool to the device, 
+//until at least size bytes are released or no entirely free chunk is left,
+//and return the number of bytes released.
+size_t OpenCLDriver::evict_mempool_chunks(memPool_t *memPool, size_t size, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::evict_mempool_chunks(%lu)\n", size);
+	}
+#endif
+	HostConf_t * tconf = getHostConf(threadID);
+	size_t releasedSize = 0;
+	void *tDevPtr;
+	size_t chunkSize;
+	while( (releasedSize < size) && memPool->popFreeChunk(&tDevPtr, &chunkSize) ) {
+		HI_device_mem_handle_t tHandle;
+		if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
+			cl_int err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
+			if( err != CL_SUCCESS ) {
+				fprintf(stderr, "[ERROR in OpenCLDriver::evict_mempool_chunks()] : failed to free on OpenCL\n");
+			}
+			HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
+		}
+		HI_free_fake_device_address(tDevPtr);
+		current_mempool_size -= chunkSize;
+		releasedSize += chunkSize;
+#ifdef _OPENARC_PROFILE_
+		tconf->IDFreeCnt++;
+#endif
+	}
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::evict_mempool_chunks(%lu)\n", releasedSize);
+	}
+#endif
+	return releasedSize;
+}
+
 HI_error_t  OpenCLDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t count, int asyncID, HI_MallocKind_t flags, int threadID) {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -1065,6 +1774,7 @@ HI_error_t  OpenCLDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t
         //fprintf(stderr, "[in HI_malloc1D()] : initing!\n");
         tconf->HI_init(DEVICE_NUM_UNDEFINED);
     }
+    HI_reclaim_completed_frees(tconf->threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1082,21 +1792,24 @@ HI_error_t  OpenCLDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t
 		}
     } else {
 		memPool_t *memPool = memPoolMap[tconf->threadID];
-		std::multimap<size_t, void *>::iterator it = memPool->find(count);
-		if( it != memPool->end()) {
+		size_t blockSize = 0;
+		if( memPool->allocate(count, devPtr, &blockSize) ) {
+			current_mempool_size -= blockSize;
 #ifdef _OPENARC_PROFILE_
 			if( HI_openarcrt_verbosity > 2 ) {
 				fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_malloc1D(%d, %lu, %d) reuses memories in the memPool\n", asyncID, count, flags);
 			}
 #endif
-			*devPtr = it->second;
-			memPool->erase(it);
             HI_set_device_address(hostPtr, *devPtr, count, asyncID, tconf->threadID);
 		} else {
-        	memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+			size_t allocSize = memPool->getAllocSize(count);
+			if( current_mempool_size > tconf->max_mempool_size ) {
+				evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
+			}
+        	memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
 #ifdef _OPENARC_PROFILE_
 			tconf->IDMallocCnt++;
-			tconf->IDMallocSize += count;
+			tconf->IDMallocSize += allocSize;
 #endif
         	if(err != CL_SUCCESS) {
             	//fprintf(stderr, "[ERROR in OpenCLDriver::HI_malloc1D()] : Malloc failed\n");
@@ -1105,41 +1818,19 @@ HI_error_t  OpenCLDriver::HI_malloc1D(const void *hostPtr, void **devPtr, size_t
 					fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_malloc1D(%d, %lu, %d) releases memories in the memPool\n", asyncID, count, flags);
 				}
 #endif
-				HI_device_mem_handle_t tHandle;
-				void * tDevPtr;
-				for (it = memPool->begin(); it != memPool->end(); ++it) {
-					tDevPtr = it->second;
-					if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) { 
-        				err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
-#ifdef _OPENARC_PROFILE_
-						tconf->IDFreeCnt++;
-#endif
-        				if(err != CL_SUCCESS) {
-            				fprintf(stderr, "[ERROR in OpenCLDriver::HI_malloc1D()] : failed to free on OpenCL\n");
-						}
-						free(tDevPtr);
-						HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-					}
+				while( (err != CL_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+					memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
 				}
-				memPool->clear();
-        		memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
 			}
         	if(err == CL_SUCCESS) {
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-				if( HI_openarcrt_memoryalignment > 0 ) {
-					posix_memalign(devPtr, AOCL_ALIGNMENT, count);
-				} else {
-					*devPtr = malloc(count); //redundant malloc to create a fake device pointer.
-				}
-#else
-				*devPtr = malloc(count); //redundant malloc to create a fake device pointer.
-#endif
+				*devPtr = HI_malloc_fake_device_address(allocSize);
 				if( *devPtr == NULL ) {
         			fprintf(stderr, "[ERROR in OpenCLDriver::HI_malloc1D()] :fake device malloc failed\n");
 					exit(1);
 				}
+				memPool->addChunk(*devPtr, allocSize, count);
             	HI_set_device_address(hostPtr, *devPtr, count, asyncID, tconf->threadID);
-            	HI_set_device_mem_handle(*devPtr, memHandle, count, tconf->threadID);
+            	HI_set_device_mem_handle(*devPtr, memHandle, allocSize, tconf->threadID);
 			}
 		}
         if(err == CL_SUCCESS) {
@@ -1323,12 +2014,12 @@ HI_error_t OpenCLDriver::HI_free( const void *hostPtr, int asyncID, int threadID
 			//We do not free the device memory; instead put it in the memory pool
 			//and remove host-pointer-to-device-pointer mapping
 			memPool_t *memPool = memPoolMap[tconf->threadID];
-			memPool->insert(std::pair<size_t, void *>(size, devPtr));
+			current_mempool_size += memPool->release(devPtr, size);
 			HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
 /*
 			HI_device_mem_handle_t tHandle;
 			if( HI_get_device_mem_handle(devPtr, &tHandle, tconf->threadID) == HI_success ) { 
-        		cl_int  err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
+        		cl_int  err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
         		if( err == CL_SUCCESS ) {
             		HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
 					free(devPtr);
@@ -1381,7 +2072,7 @@ HI_error_t OpenCLDriver::HI_free_unified( const void *hostPtr, int asyncID, int
 		} else {
 			HI_device_mem_handle_t tHandle;
 			if( HI_get_device_mem_handle(devPtr, &tHandle, tconf->threadID) == HI_success ) { 
-        		cl_int  err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
+        		cl_int  err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
         		if( err == CL_SUCCESS ) {
             		HI_remove_device_address(hostPtr, asyncID, tconf->threadID);
 					free(devPtr);
@@ -1422,6 +2113,7 @@ void OpenCLDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t d
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
+    HI_reclaim_completed_frees(tconf->threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1441,9 +2133,9 @@ void OpenCLDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t d
 			HI_device_mem_handle_t tHandle;
 			tempMallocSet.erase(*tempPtr);
 			if( HI_get_device_mem_handle(*tempPtr, &tHandle, tconf->threadID) == HI_success ) { 
-        		cl_int  err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
+        		cl_int  err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
         		if( err == CL_SUCCESS ) {
-					free(*tempPtr);
+					HI_free_fake_device_address(*tempPtr);
 					HI_remove_device_mem_handle(*tempPtr, tconf->threadID);
         		} 
 			}
@@ -1454,15 +2146,7 @@ void OpenCLDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t d
         cl_int err;
 		cl_mem_flags mem_flags = convert2CLMemFlags(flags);
         cl_mem memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-		if( HI_openarcrt_memoryalignment > 0 ) {
-			posix_memalign(tempPtr, AOCL_ALIGNMENT, count);
-		} else {
-			*tempPtr = malloc(count);
-		}
-#else
-		*tempPtr = malloc(count);
-#endif
+		*tempPtr = HI_malloc_fake_device_address(count);
         HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
 		tempMallocSet.insert(*tempPtr);
         if (err != CL_SUCCESS) {
@@ -1518,6 +2202,7 @@ void OpenCLDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_devi
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
+    HI_reclaim_completed_frees(tconf->threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1531,20 +2216,12 @@ void OpenCLDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_devi
     {   
     if(  devType == acc_device_gpu || devType == acc_device_nvidia || 
     devType == acc_device_radeon || devType == acc_device_xeonphi || 
-    devType == acc_device_not_host || devType == acc_device_intelgpu || 
-	devType == acc_device_altera || devType == acc_device_altera_emulator || devType == acc_device_current) {
-        cl_int err;
-		cl_mem_flags mem_flags = convert2CLMemFlags(flags);
-        cl_mem memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-		if( HI_openarcrt_memoryalignment > 0 ) {
-			posix_memalign(tempPtr, AOCL_ALIGNMENT, count);
-		} else {
-			*tempPtr = malloc(count);
-		}
-#else
-		*tempPtr = malloc(count);
-#endif
+    devType == acc_device_not_host || devType == acc_device_intelgpu || 
+	devType == acc_device_altera || devType == acc_device_altera_emulator || devType == acc_device_current) {
+        cl_int err;
+		cl_mem_flags mem_flags = convert2CLMemFlags(flags);
+        cl_mem memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+		*tempPtr = HI_malloc_fake_device_address(count);
         HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
 		tempMallocSet.insert(*tempPtr);
         if (err != CL_SUCCESS) {
@@ -1613,13 +2290,13 @@ void OpenCLDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threadI
 			HI_device_mem_handle_t tHandle;
 			tempMallocSet.erase(tempPtr);
 			if( HI_get_device_mem_handle(tempPtr, &tHandle, tconf->threadID) == HI_success ) { 
-        		cl_int  err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
+        		cl_int  err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
         		if( err == CL_SUCCESS ) {
-					free(tempPtr);
+					HI_free_fake_device_address(tempPtr);
 					HI_remove_device_mem_handle(tempPtr, tconf->threadID);
         		} 
 			} else {
-				free(tempPtr);
+				HI_free_fake_device_address(tempPtr);
 			}
 #ifdef _OPENARC_PROFILE_
             tconf->IDFreeCnt++;
@@ -1663,6 +2340,7 @@ void OpenCLDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t d
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
+    HI_reclaim_completed_frees(tconf->threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1682,56 +2360,37 @@ void OpenCLDriver::HI_tempMalloc1D( void** tempPtr, size_t count, acc_device_t d
 		cl_mem_flags mem_flags = convert2CLMemFlags(flags);
         cl_mem memHandle;
         memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if( it != memPool->end()) {
+        size_t blockSize = 0;
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
+        	current_mempool_size -= blockSize;
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_tempMalloc1D(%lu, %d) reuses memories in the memPool\n", count, flags);
             }    
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
         } else {
-            memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+            size_t allocSize = memPool->getAllocSize(count);
+            if( current_mempool_size > tconf->max_mempool_size ) {
+            	evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
+            }
+            memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
             if(err != CL_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_tempMalloc1D(%lu, %d) releases memories in the memPool\n", count, flags);
                 }
 #endif               
-                HI_device_mem_handle_t tHandle;
-                void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    tDevPtr = it->second;
-                    if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) {             
-                        err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
-#ifdef _OPENARC_PROFILE_     
-                        tconf->IDFreeCnt++;
-#endif                       
-                        if(err != CL_SUCCESS) {
-                            fprintf(stderr, "[ERROR in OpenCLDriver::HI_tempMalloc1D()] : failed to free on OpenCL\n");        
-                        }
-                        free(tDevPtr);
-                        HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-                    }        
-                }        
-                memPool->clear();
-                memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+                while( (err != CL_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
+                }
             }
             if(err == CL_SUCCESS) {
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-				if( HI_openarcrt_memoryalignment > 0 ) {
-					posix_memalign(tempPtr, AOCL_ALIGNMENT, count);
-				} else {
-					*tempPtr = malloc(count);
-				}
-#else
-				*tempPtr = malloc(count);
-#endif
-        		HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+				*tempPtr = HI_malloc_fake_device_address(allocSize);
+				memPool->addChunk(*tempPtr, allocSize, count);
+        		HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
         		tconf->IDMallocCnt++;
-        		tconf->IDMallocSize += count;
+        		tconf->IDMallocSize += allocSize;
 #endif
 			} else {
             	fprintf(stderr, "[ERROR in OpenCLDriver::HI_tempMalloc1D()] : Malloc failed\n");
@@ -1783,6 +2442,7 @@ void OpenCLDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_devi
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
+    HI_reclaim_completed_frees(tconf->threadID);
 #ifdef _OPENARC_PROFILE_
     double ltime = HI_get_localtime();
 #endif
@@ -1802,56 +2462,37 @@ void OpenCLDriver::HI_tempMalloc1D_async( void** tempPtr, size_t count, acc_devi
 		cl_mem_flags mem_flags = convert2CLMemFlags(flags);
         cl_mem memHandle;
         memPool_t *memPool = memPoolMap[tconf->threadID];
-        std::multimap<size_t, void *>::iterator it = memPool->find(count);
-        if( it != memPool->end()) {
+        size_t blockSize = 0;
+        if( memPool->allocate(count, tempPtr, &blockSize) ) {
+        	current_mempool_size -= blockSize;
 #ifdef _OPENARC_PROFILE_
             if( HI_openarcrt_verbosity > 2 ) {
                 fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_tempMalloc1D_async(%lu, %d) reuses memories in the memPool\n", count, flags);
             }    
 #endif
-            *tempPtr = it->second;
-            memPool->erase(it);
         } else {
-            memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+            size_t allocSize = memPool->getAllocSize(count);
+            if( current_mempool_size > tconf->max_mempool_size ) {
+            	evict_mempool_chunks(memPool, current_mempool_size - tconf->max_mempool_size, tconf->threadID);
+            }
+            memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
             if(err != CL_SUCCESS) {
 #ifdef _OPENARC_PROFILE_
                 if( HI_openarcrt_verbosity > 2 ) {
                     fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::HI_tempMalloc1D_async(%lu, %d) releases memories in the memPool\n", count, flags);
                 }
 #endif               
-                HI_device_mem_handle_t tHandle;
-                void * tDevPtr;
-                for (it = memPool->begin(); it != memPool->end(); ++it) {
-                    tDevPtr = it->second;
-                    if( HI_get_device_mem_handle(tDevPtr, &tHandle, tconf->threadID) == HI_success ) {             
-                        err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
-#ifdef _OPENARC_PROFILE_     
-                        tconf->IDFreeCnt++;
-#endif                       
-                        if(err != CL_SUCCESS) {
-                            fprintf(stderr, "[ERROR in OpenCLDriver::HI_tempMalloc1D_async()] : failed to free on OpenCL\n");        
-                        }
-                        free(tDevPtr);
-                        HI_remove_device_mem_handle(tDevPtr, tconf->threadID);
-                    }        
-                }        
-                memPool->clear();
-                memHandle = clCreateBuffer(clContext, mem_flags, count, NULL, &err);
+                while( (err != CL_SUCCESS) && (evict_mempool_chunks(memPool, allocSize, tconf->threadID) > 0) ) {
+                	memHandle = clCreateBuffer(clContext, mem_flags, allocSize, NULL, &err);
+                }
             }
             if(err == CL_SUCCESS) {
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-				if( HI_openarcrt_memoryalignment > 0 ) {
-					posix_memalign(tempPtr, AOCL_ALIGNMENT, count);
-				} else {
-					*tempPtr = malloc(count);
-				}
-#else
-				*tempPtr = malloc(count);
-#endif
-        		HI_set_device_mem_handle(*tempPtr, memHandle, count, tconf->threadID);
+				*tempPtr = HI_malloc_fake_device_address(allocSize);
+				memPool->addChunk(*tempPtr, allocSize, count);
+        		HI_set_device_mem_handle(*tempPtr, memHandle, allocSize, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
         		tconf->IDMallocCnt++;
-        		tconf->IDMallocSize += count;
+        		tconf->IDMallocSize += allocSize;
 #endif
 			} else {
             	fprintf(stderr, "[ERROR in OpenCLDriver::HI_tempMalloc1D_async()] : Malloc failed\n");
@@ -1925,7 +2566,7 @@ void OpenCLDriver::HI_tempFree( void* tempPtr, acc_device_t devType, int threadI
 			size_t size;
 			if( HI_get_device_mem_handle(tempPtr, &tHandle, &size, tconf->threadID) == HI_success ) { 
         		memPool_t *memPool = memPoolMap[tconf->threadID];
-        		memPool->insert(std::pair<size_t, void *>(size, tempPtr));
+        		current_mempool_size += memPool->release(tempPtr, size);
 			} else if( tempMallocSet.count(tempPtr) > 0 ) {
 				tempMallocSet.erase(tempPtr);
             	free(tempPtr);
@@ -2285,16 +2926,15 @@ HI_error_t OpenCLDriver::HI_memcpy_async(void *dst, const void *src, size_t coun
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
-#ifdef _OPENARC_PROFILE_
-    double ltime = HI_get_localtime();
-#endif
     HI_wait_for_events(async, num_waits, waits, tconf->threadID);
 
     //err = cudaMemcpy(dst, src, count, toCudaMemcpyKind(kind));
     cl_int  err = CL_SUCCESS;
     cl_command_queue queue = getQueue(async, tconf->threadID);
-    cl_event *event = getEvent(async, tconf->threadID);
+    cl_event *event = NULL;
 	if( dst != src ) {
+    	event = getNextEvent(async, tconf->threadID);
+    	count_queue_command(async, tconf);
     	switch( kind ) {
     	case HI_MemcpyHostToHost: {
         	fprintf(stderr, "[ERROR in OpenCLDriver::HI_memcpy_async()] Host to Host transfers not supported\n");
@@ -2308,7 +2948,7 @@ HI_error_t OpenCLDriver::HI_memcpy_async(void *dst, const void *src, size_t coun
 				if( HI_openarcrt_memoryalignment > 0 ) {
 					size_t prefix = AOCL_ALIGNMENT - ((size_t) src & (AOCL_ALIGNMENT - 1));
 					if( (prefix != AOCL_ALIGNMENT) && (prefix < count) ) {
-        				err = clEnqueueWriteBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, prefix, src, 0, NULL, event);
+        				err = clEnqueueWriteBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, prefix, src, 0, NULL, NULL);
         				err = clEnqueueWriteBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, (tHandle.offset + prefix), count-prefix, (const void *)((char*)(src) + prefix), 0, NULL, event);
 					} else {
         				err = clEnqueueWriteBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, count, src, 0, NULL, event);
@@ -2335,7 +2975,7 @@ HI_error_t OpenCLDriver::HI_memcpy_async(void *dst, const void *src, size_t coun
 				if( HI_openarcrt_memoryalignment > 0 ) {
 					size_t prefix = AOCL_ALIGNMENT - ((size_t) dst & (AOCL_ALIGNMENT - 1));
 					if( (prefix != AOCL_ALIGNMENT) && (prefix < count) ) {
-        				err = clEnqueueReadBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, prefix, dst, 0, NULL, event);
+        				err = clEnqueueReadBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, prefix, dst, 0, NULL, NULL);
         				err = clEnqueueReadBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, (tHandle.offset + prefix), count-prefix, (void *)((char*)(dst) + prefix), 0, NULL, event);
 					} else {
         				err = clEnqueueReadBuffer(queue, (cl_mem)(tHandle.memHandle), CL_FALSE, tHandle.offset, count, dst, 0, NULL, event);
@@ -2378,7 +3018,10 @@ HI_error_t OpenCLDriver::HI_memcpy_async(void *dst, const void *src, size_t coun
         	tconf->H2HMemTrSize += count;
     	}
 	}
-    tconf->totalMemTrTime += HI_get_localtime() - ltime;
+    //The transfer time is added to totalMemTrTime when the event is collected.
+    if( (err == CL_SUCCESS) && (dst != src) ) {
+        add_profiling_event(*event, NULL, tconf->threadID);
+    }
 #endif
     if( err == CL_SUCCESS ) {
 #ifdef _OPENARC_PROFILE_
@@ -2407,15 +3050,13 @@ HI_error_t OpenCLDriver::HI_memcpy_asyncS(void *dst, const void *src, size_t cou
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
-#ifdef _OPENARC_PROFILE_
-    double ltime = HI_get_localtime();
-#endif
     HI_wait_for_events(async, num_waits, waits, tconf->threadID);
 
     //err = cudaMemcpy(dst, src, count, toCudaMemcpyKind(kind));
     cl_int  err;
     cl_command_queue queue = getQueue(async, tconf->threadID);
-    cl_event *event = getEvent(async, tconf->threadID);
+    cl_event *event = getNextEvent(async, tconf->threadID);
+    count_queue_command(async, tconf);
     switch( kind ) {
     case HI_MemcpyHostToHost: {
         fprintf(stderr, "[ERROR in OpenCLDriver::HI_memcpy_asyncS()] Host to Host transfers not supported\n");
@@ -2474,7 +3115,10 @@ HI_error_t OpenCLDriver::HI_memcpy_asyncS(void *dst, const void *src, size_t cou
         tconf->H2HMemTrCnt++;
         tconf->H2HMemTrSize += count;
     }
-    tconf->totalMemTrTime += HI_get_localtime() - ltime;
+    //The transfer time is added to totalMemTrTime when the event is collected.
+    if( err == CL_SUCCESS ) {
+        add_profiling_event(*event, NULL, tconf->threadID);
+    }
 #endif
     if( err == CL_SUCCESS ) {
 #ifdef _OPENARC_PROFILE_
@@ -2496,42 +3140,142 @@ HI_error_t OpenCLDriver::HI_memcpy_asyncS(void *dst, const void *src, size_t cou
 }
 
 
-HI_error_t OpenCLDriver::HI_memcpy2D(void *dst, size_t dpitch, const void *src, size_t spitch,
-        size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int threadID) {
+//Convert a byte offset into a device buffer into the origin of a rectangular
+//region with the given row/slice pitches.
+static void HI_get_rect_origin(size_t offset, size_t rowPitch, size_t slicePitch, size_t origin[3]) {
+	origin[2] = offset / slicePitch;
+	offset -= origin[2] * slicePitch;
+	origin[1] = offset / rowPitch;
+	origin[0] = offset - origin[1] * rowPitch;
+}
+
+//Copy a 3D region of widthInBytes x height x depth bytes, whose rows are 
+//dpitch/spitch bytes apart and whose slices are dpitch*height/spitch*height 
+//bytes apart, using rectangular buffer reads/writes/copies.
+//If blocking is CL_TRUE, the copy is done on the default queue and completes 
+//before return; otherwise, it is enqueued to the async queue after the waits.
+HI_error_t OpenCLDriver::HI_memcpy_rect(void *dst, size_t dpitch, const void *src, size_t spitch,
+        size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, cl_bool blocking, int async, int num_waits, int *waits, const char *callerName, int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
 #ifdef _OPENARC_PROFILE_
-	if( HI_openarcrt_verbosity > 2 ) {
-		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_memcpy2D()\n");
+    double ltime = HI_get_localtime();
+#endif
+    cl_int  err = CL_SUCCESS;
+    cl_command_queue queue;
+    cl_event *event = NULL;
+	if( blocking == CL_TRUE ) {
+    	queue = getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID);
+	} else {
+    	HI_wait_for_events(async, num_waits, waits, tconf->threadID);
+    	queue = getQueue(async, tconf->threadID);
+    	event = getNextEvent(async, tconf->threadID);
+    	count_queue_command(async, tconf);
+	}
+    size_t region[3] = {widthInBytes, height, depth};
+    size_t hostOrigin[3] = {0, 0, 0};
+	size_t dOrigin[3];
+	size_t sOrigin[3];
+	HI_device_mem_handle_t dHandle;
+	HI_device_mem_handle_t sHandle;
+	switch( kind ) {
+	case HI_MemcpyHostToHost: {
+        fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Host to Host transfers not supported; exit!\n", callerName);
+		exit(1);
+        break;
 	}
+	case HI_MemcpyHostToDevice: {
+		if( HI_get_device_mem_handle(dst, &dHandle, tconf->threadID) != HI_success ) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Cannot find a device pointer (%lx) to memory handle mapping; exit!\n", callerName, (unsigned long)dst);
+#ifdef _OPENARC_PROFILE_
+			HI_print_device_address_mapping_entries(tconf->threadID);
 #endif
-    /*
-	//[TODO]
-    #ifdef _OPENARC_PROFILE_
+			exit(1);
+		}
+		HI_get_rect_origin(dHandle.offset, dpitch, dpitch*height, dOrigin);
+        err = clEnqueueWriteBufferRect(queue, (cl_mem)(dHandle.memHandle), blocking, dOrigin, hostOrigin, region, dpitch, dpitch*height, spitch, spitch*height, src, 0, NULL, event);
+        break;
+	}
+	case HI_MemcpyDeviceToHost: {
+		if( HI_get_device_mem_handle(src, &sHandle, tconf->threadID) != HI_success ) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Cannot find a device pointer (%lx) to memory handle mapping; exit!\n", callerName, (unsigned long)src);
+#ifdef _OPENARC_PROFILE_
+			HI_print_device_address_mapping_entries(tconf->threadID);
+#endif
+			exit(1);
+		}
+		HI_get_rect_origin(sHandle.offset, spitch, spitch*height, sOrigin);
+        err = clEnqueueReadBufferRect(queue, (cl_mem)(sHandle.memHandle), blocking, sOrigin, hostOrigin, region, spitch, spitch*height, dpitch, dpitch*height, dst, 0, NULL, event);
+        break;
+	}
+	case HI_MemcpyDeviceToDevice: {
+		if( HI_get_device_mem_handle(dst, &dHandle, tconf->threadID) != HI_success ) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Cannot find a device pointer (%lx) to memory handle mapping; exit!\n", callerName, (unsigned long)dst);
+#ifdef _OPENARC_PROFILE_
+			HI_print_device_address_mapping_entries(tconf->threadID);
+#endif
+			exit(1);
+		}
+		if( HI_get_device_mem_handle(src, &sHandle, tconf->threadID) != HI_success ) {
+        	fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Cannot find a device pointer (%lx) to memory handle mapping; exit!\n", callerName, (unsigned long)src);
+#ifdef _OPENARC_PROFILE_
+			HI_print_device_address_mapping_entries(tconf->threadID);
+#endif
+			exit(1);
+		}
+		HI_get_rect_origin(dHandle.offset, dpitch, dpitch*height, dOrigin);
+		HI_get_rect_origin(sHandle.offset, spitch, spitch*height, sOrigin);
+        err = clEnqueueCopyBufferRect(queue, (cl_mem)(sHandle.memHandle), (cl_mem)(dHandle.memHandle), sOrigin, dOrigin, region, spitch, spitch*height, dpitch, dpitch*height, 0, NULL, event);
+		//Buffer copies are not blocking.
+		if( (err == CL_SUCCESS) && (blocking == CL_TRUE) ) {
+			err = clFinish(queue);
+		}
+        break;
+	}
+	}
+#ifdef _OPENARC_PROFILE_
     if( kind == HI_MemcpyHostToDevice ) {
-    	tconf->H2DMemTrCnt++;
-    	tconf->H2DMemTrSize += widthInBytes*height;
+        tconf->H2DMemTrCnt++;
+        tconf->H2DMemTrSize += widthInBytes*height*depth;
     } else if( kind == HI_MemcpyDeviceToHost ) {
-    	tconf->D2HMemTrCnt++;
-    	tconf->D2HMemTrSize += widthInBytes*height;
+        tconf->D2HMemTrCnt++;
+        tconf->D2HMemTrSize += widthInBytes*height*depth;
     } else if( kind == HI_MemcpyDeviceToDevice ) {
-    	tconf->D2DMemTrCnt++;
-    	tconf->D2DMemTrSize += widthInBytes*height;
+        tconf->D2DMemTrCnt++;
+        tconf->D2DMemTrSize += widthInBytes*height*depth;
     } else {
-    	tconf->H2HMemTrCnt++;
-    	tconf->H2HMemTrSize += widthInBytes*height;
+        tconf->H2HMemTrCnt++;
+        tconf->H2HMemTrSize += widthInBytes*height*depth;
     }
-    tconf->totalMemTrTime += HI_get_localtime() - ltime;
-    #endif
+    if( event == NULL ) {
+        tconf->totalMemTrTime += HI_get_localtime() - ltime;
+    } else if( err == CL_SUCCESS ) {
+        //The transfer time is added to totalMemTrTime when the event is collected.
+        add_profiling_event(*event, NULL, tconf->threadID);
+    }
+#endif
     if( err == CL_SUCCESS ) {
-    	return HI_success;
+        return HI_success;
     } else {
-    	return HI_error;
-    }*/
+        fprintf(stderr, "[ERROR in OpenCLDriver::%s()] Memcpy failed with error %d (%s)\n", callerName, err, opencl_error_code(err));
+		exit(1);
+        return HI_error;
+    }
+}
+
+HI_error_t OpenCLDriver::HI_memcpy2D(void *dst, size_t dpitch, const void *src, size_t spitch,
+        size_t widthInBytes, size_t height, HI_MemcpyKind_t kind, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_memcpy2D()\n");
+	}
+#endif
+	HI_error_t result = HI_memcpy_rect(dst, dpitch, src, spitch, widthInBytes, height, 1, kind, CL_TRUE, DEFAULT_QUEUE, 0, NULL, "HI_memcpy2D", threadID);
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_memcpy2D()\n");
 	}
 #endif
-    return HI_success;
+    return result;
 }
 
 HI_error_t OpenCLDriver::HI_memcpy2D_async(void *dst, size_t dpitch, const void *src,
@@ -2542,15 +3286,48 @@ HI_error_t OpenCLDriver::HI_memcpy2D_async(void *dst, size_t dpitch, const void
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_memcpy2D_async(%d)\n", async);
 	}
 #endif
+	HI_error_t result = HI_memcpy_rect(dst, dpitch, src, spitch, widthInBytes, height, 1, kind, CL_FALSE, async, num_waits, waits, "HI_memcpy2D_async", threadID);
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_memcpy2D_async(%d)\n", async);
 	}
 #endif
-    return HI_success;
+    return result;
+}
+
+HI_error_t OpenCLDriver::HI_memcpy3D(void *dst, size_t dpitch, const void *src, size_t spitch,
+        size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_memcpy3D()\n");
+	}
+#endif
+	HI_error_t result = HI_memcpy_rect(dst, dpitch, src, spitch, widthInBytes, height, depth, kind, CL_TRUE, DEFAULT_QUEUE, 0, NULL, "HI_memcpy3D", threadID);
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_memcpy3D()\n");
+	}
+#endif
+    return result;
+}
+
+HI_error_t OpenCLDriver::HI_memcpy3D_async(void *dst, size_t dpitch, const void *src,
+        size_t spitch, size_t widthInBytes, size_t height, size_t depth, HI_MemcpyKind_t kind, int async, int num_waits, int *waits, int threadID) {
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_memcpy3D_async(%d)\n", async);
+	}
+#endif
+	HI_error_t result = HI_memcpy_rect(dst, dpitch, src, spitch, widthInBytes, height, depth, kind, CL_FALSE, async, num_waits, waits, "HI_memcpy3D_async", threadID);
+#ifdef _OPENARC_PROFILE_
+	if( HI_openarcrt_verbosity > 2 ) {
+		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_memcpy3D_async(%d)\n", async);
+	}
+#endif
+    return result;
 }
 
-HI_error_t OpenCLDriver::HI_register_kernel_numargs(std::string kernel_name, int num_args, int threadID)
+HI_error_t OpenCLDriver::HI_register_kernel_numargs(int kernel_id, int num_args, int threadID)
 {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2559,17 +3336,19 @@ HI_error_t OpenCLDriver::HI_register_kernel_numargs(std::string kernel_name, int
 #endif
 	//[DEBUG] below code is not used now.
     HostConf_t *tconf = getHostConf(threadID);
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
     //fprintf(stderr, "find kernelargs map for the current device\n");
-    kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
+    kernelParams_t *kernelParams = kernelHandle->kernelParams;
     if( kernelParams->num_args == 0 ) { 
         if( num_args > 0 ) { 
             kernelParams->num_args = num_args;
             kernelParams->kernelParams = (void**)malloc(sizeof(void*) * num_args);
       		kernelParams->kernelParamsOffset = (size_t*)malloc(sizeof(size_t) * num_args);
       		kernelParams->kernelParamsInfo = (int*)malloc(sizeof(int) * num_args);
-      		kernelParams->kernelParamSubBuffers = (cl_mem*)malloc(sizeof(cl_mem) * num_args);
+      		kernelParams->kernelParamSubBuffers = (cl_mem*)calloc(num_args, sizeof(cl_mem));
+      		kernelParams->kernelArgStates = (kernelargstate_t*)calloc(num_args, sizeof(kernelargstate_t));
         } else { 
-            fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernel_name.c_str(), num_args);
+            fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_numargs(%s, %d)] num_args should be greater than zero.\n",kernelHandle->kernelName, num_args);
             exit(1);
         }        
     }        
@@ -2582,7 +3361,7 @@ HI_error_t OpenCLDriver::HI_register_kernel_numargs(std::string kernel_name, int
 }
 
 
-HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
+HI_error_t OpenCLDriver::HI_register_kernel_arg(int kernel_id, int arg_index, size_t arg_size, void *arg_value, int arg_type, int arg_trait, size_t unitSize, int threadID)
 {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2590,10 +3369,27 @@ HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg
 	}
 #endif
     HostConf_t * tconf = getHostConf(threadID);
-	kernelParams_t * kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
-    cl_int err;
+    kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+	kernelParams_t * kernelParams = kernelHandle->kernelParams;
+    kernelargstate_t *argState = kernelParams->kernelArgStates + arg_index;
+    cl_int err = CL_SUCCESS;
+	//Drop the pin on a sub-buffer registered for this argument by a launch 
+	//that was never enqueued.
+	if( *(kernelParams->kernelParamSubBuffers + arg_index) != NULL ) {
+		HI_unpin_sub_buffer(*(kernelParams->kernelParamSubBuffers + arg_index));
+    	*(kernelParams->kernelParamSubBuffers + arg_index) = NULL;
+	}
 	if( arg_type == 0 ) { //scalar variable
-    	err = clSetKernelArg((cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, arg_size, arg_value);
+		if( HI_check_kernel_arg_state(argState, arg_size, arg_value, 0) ) {
+#ifdef _OPENARC_PROFILE_
+			tconf->KernelArgSkipCnt++;
+#endif
+		} else {
+    		err = clSetKernelArg((cl_kernel)(kernelHandle->kernel), arg_index, arg_size, arg_value);
+#ifdef _OPENARC_PROFILE_
+			tconf->KernelArgSetCnt++;
+#endif
+		}
     	*(kernelParams->kernelParams + arg_index) = arg_value;
     	*(kernelParams->kernelParamsOffset + arg_index) = 0; 
     	*(kernelParams->kernelParamsInfo + arg_index) = (int)arg_size;
@@ -2608,15 +3404,21 @@ HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg
 				*(kernelParams->kernelParamsOffset + arg_index) = 0;
 				*(kernelParams->kernelParamsInfo + arg_index) = arg_trait;
     			*(kernelParams->kernelParamSubBuffers + arg_index) = NULL;
-    			err = clSetKernelArg((cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, arg_size, &localMemHandle);
+				if( HI_check_kernel_arg_state(argState, arg_size, &localMemHandle, 1) ) {
+#ifdef _OPENARC_PROFILE_
+					tconf->KernelArgSkipCnt++;
+#endif
+				} else {
+    				err = clSetKernelArg((cl_kernel)(kernelHandle->kernel), arg_index, arg_size, &localMemHandle);
+#ifdef _OPENARC_PROFILE_
+					tconf->KernelArgSetCnt++;
+#endif
+				}
 			} else {
 				size_t localOffset = tHandle.offset;
 				*(kernelParams->kernelParams + arg_index) = (void *)&localMemHandle;
 				*(kernelParams->kernelParamsOffset + arg_index) = localOffset/unitSize;
 				*(kernelParams->kernelParamsInfo + arg_index) = arg_trait;
-				cl_buffer_region localRegion;
-				localRegion.origin = localOffset;
-				localRegion.size = dataSize - localOffset;
 				cl_mem_flags flags;
 				if( arg_trait == 0 ) { //read-only
 					flags = CL_MEM_READ_ONLY;
@@ -2627,12 +3429,29 @@ HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg
 				} else { //unknown or temporary
 					flags = CL_MEM_READ_WRITE;
 				}
-    			cl_mem subBuffer = clCreateSubBuffer((cl_mem)localMemHandle, flags, CL_BUFFER_CREATE_TYPE_REGION, &localRegion, &err);
+				if( (localOffset % memBaseAddrAlign) != 0 ) {
+        			fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] argument %d of kernel %s points to offset %lu of a device buffer, but OpenCL sub-buffers on this device should start at a multiple of %lu bytes (CL_DEVICE_MEM_BASE_ADDR_ALIGN)\n", arg_index, kernelHandle->kernelName, (unsigned long)localOffset, (unsigned long)memBaseAddrAlign);
+					exit(1);
+				}
+    			cl_mem subBuffer = HI_get_sub_buffer((cl_mem)localMemHandle, localOffset, dataSize - localOffset, flags, &err);
     			*(kernelParams->kernelParamSubBuffers + arg_index) = subBuffer;
-    			err = clSetKernelArg((cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), arg_index, arg_size, &subBuffer);
+				if( err != CL_SUCCESS ) {
+        			fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] failed to create a sub-buffer for argument %d of kernel %s with error %d (%s)\n", arg_index, kernelHandle->kernelName, err, opencl_error_code(err));
+					exit(1);
+				}
+				if( HI_check_kernel_arg_state(argState, arg_size, &subBuffer, 1) ) {
+#ifdef _OPENARC_PROFILE_
+					tconf->KernelArgSkipCnt++;
+#endif
+				} else {
+    				err = clSetKernelArg((cl_kernel)(kernelHandle->kernel), arg_index, arg_size, &subBuffer);
+#ifdef _OPENARC_PROFILE_
+					tconf->KernelArgSetCnt++;
+#endif
+				}
 			}
 		} else {
-        	fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (OPENCL Device)\n", arg_index, kernel_name.c_str());
+        	fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] Cannot find a device pointer to memory handle mapping; failed to add argument %d to kernel %s (OPENCL Device)\n", arg_index, kernelHandle->kernelName);
 #ifdef _OPENARC_PROFILE_
 			HI_print_device_address_mapping_entries(tconf->threadID);
 #endif
@@ -2641,7 +3460,7 @@ HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg
 	}
     if(err != CL_SUCCESS)
     {
-        fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] failed to add argument %d to kernel %s with error %d (%s)\n", arg_index, kernel_name.c_str(), err, opencl_error_code(err));
+        fprintf(stderr, "[ERROR in OpenCLDriver::HI_register_kernel_arg()] failed to add argument %d to kernel %s with error %d (%s)\n", arg_index, kernelHandle->kernelName, err, opencl_error_code(err));
 		exit(1);
         return HI_error;
     }
@@ -2653,17 +3472,15 @@ HI_error_t OpenCLDriver::HI_register_kernel_arg(std::string kernel_name, int arg
     return HI_success;
 }
 
-HI_error_t OpenCLDriver::HI_kernel_call(std::string kernel_name, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID)
+HI_error_t OpenCLDriver::HI_kernel_call(int kernel_id, size_t gridSize[3], size_t blockSize[3], int async, int num_waits, int *waits, int threadID)
 {
-	const char* c_kernel_name = kernel_name.c_str();
+	HostConf_t *tconf = getHostConf(threadID);
+	kernelhandle_t *kernelHandle = tconf->getKernelHandle(this, kernel_id);
+	const char* c_kernel_name = kernelHandle->kernelName;
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\tenter OpenCLDriver::HI_kernel_call(%s, %d)\n",c_kernel_name, async);
 	}
-#endif
-    HostConf_t * tconf = getHostConf(threadID);
-#ifdef _OPENARC_PROFILE_
-    double ltime = HI_get_localtime();
 #endif
     HI_wait_for_events(async, num_waits, waits, tconf->threadID);
 
@@ -2677,24 +3494,40 @@ HI_error_t OpenCLDriver::HI_kernel_call(std::string kernel_name, size_t gridSize
     localSize[1] = blockSize[1];
     localSize[2] = blockSize[2];
 
-	kernelParams_t *kernelParams = tconf->kernelArgsMap.at(this).at(kernel_name);
     cl_int err;
     cl_command_queue queue = getQueue(async, tconf->threadID);
     if(async != (DEFAULT_QUEUE+tconf->asyncID_offset)) {
-        cl_event *event = getEvent(async, tconf->threadID);
+        cl_event *event = getNextEvent(async, tconf->threadID);
 		//[DEBUG on June 9, 2021] passing kernelParamsOffset is generally incorrect.
-        //err = clEnqueueNDRangeKernel(queue, (cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), 3, kernelParams->kernelParamsOffset, globalSize, localSize, 0, NULL, event);
-        err = clEnqueueNDRangeKernel(queue, (cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), 3, NULL, globalSize, localSize, 0, NULL, event);
+        //err = clEnqueueNDRangeKernel(queue, (cl_kernel)(kernelHandle->kernel), 3, kernelParams->kernelParamsOffset, globalSize, localSize, 0, NULL, event);
+        err = clEnqueueNDRangeKernel(queue, (cl_kernel)(kernelHandle->kernel), 3, NULL, globalSize, localSize, 0, NULL, event);
+#ifdef _OPENARC_PROFILE_
+		if( err == CL_SUCCESS ) {
+			add_profiling_event(*event, c_kernel_name, tconf->threadID);
+		}
+#endif
     } else {
+        count_queue_command(async, tconf);
 		//[DEBUG on June 9, 2021] passing kernelParamsOffset is generally incorrect.
-        //err = clEnqueueNDRangeKernel(queue, (cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), 3, kernelParams->kernelParamsOffset, globalSize, localSize, 0, NULL, NULL);
-        err = clEnqueueNDRangeKernel(queue, (cl_kernel)(tconf->kernelsMap.at(this).at(kernel_name)), 3, NULL, globalSize, localSize, 0, NULL, NULL);
+        //err = clEnqueueNDRangeKernel(queue, (cl_kernel)(kernelHandle->kernel), 3, kernelParams->kernelParamsOffset, globalSize, localSize, 0, NULL, NULL);
+#ifdef _OPENARC_PROFILE_
+        cl_event event;
+        err = clEnqueueNDRangeKernel(queue, (cl_kernel)(kernelHandle->kernel), 3, NULL, globalSize, localSize, 0, NULL, &event);
+		if( err == CL_SUCCESS ) {
+			add_profiling_event(event, c_kernel_name, tconf->threadID);
+			clReleaseEvent(event);
+		}
+#else
+        err = clEnqueueNDRangeKernel(queue, (cl_kernel)(kernelHandle->kernel), 3, NULL, globalSize, localSize, 0, NULL, NULL);
+#endif
     }
-	int num_args = kernelParams->num_args;
-	for( int i=0; i<num_args; i++ ) {
-		cl_mem subBuffer = kernelParams->kernelParamSubBuffers[i];
-		if( subBuffer != NULL ) {
-			clReleaseMemObject(subBuffer);
+	//The enqueued kernel retains its sub-buffer arguments, which can now be 
+	//evicted from the sub-buffer cache.
+	kernelParams_t *kernelParams = kernelHandle->kernelParams;
+	for( int i=0; i<kernelParams->num_args; i++ ) {
+		if( *(kernelParams->kernelParamSubBuffers + i) != NULL ) {
+			HI_unpin_sub_buffer(*(kernelParams->kernelParamSubBuffers + i));
+			*(kernelParams->kernelParamSubBuffers + i) = NULL;
 		}
 	}
 #ifdef _OPENARC_PROFILE_
@@ -2712,15 +3545,15 @@ HI_error_t OpenCLDriver::HI_kernel_call(std::string kernel_name, size_t gridSize
         return HI_error;
     }
 #ifdef _OPENARC_PROFILE_
-    if(tconf->KernelCNTMap.count(kernel_name) == 0) {
-        tconf->KernelCNTMap[kernel_name] = 0.0;
+    if(tconf->KernelCNTMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelCNTMap[kernelHandle->kernelName] = 0.0;
     }        
-    tconf->KernelCNTMap[kernel_name] += 1;
-    if(tconf->KernelTimingMap.count(kernel_name) == 0) {
-        tconf->KernelTimingMap[kernel_name] = 0.0;
+    tconf->KernelCNTMap[kernelHandle->kernelName] += 1;
+    if(tconf->KernelTimingMap.count(kernelHandle->kernelName) == 0) {
+        tconf->KernelTimingMap[kernelHandle->kernelName] = 0.0;
     }        
-   	err = clFinish(queue);
-    tconf->KernelTimingMap[kernel_name] += HI_get_localtime() - ltime;
+	//The kernel execution time is added to KernelTimingMap when the kernel 
+	//event is collected at a later synchronization point.
 #endif   
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2730,6 +3563,60 @@ HI_error_t OpenCLDriver::HI_kernel_call(std::string kernel_name, size_t gridSize
     return HI_success;
 }
 
+#ifdef _OPENARC_PROFILE_
+//Keep a reference to the event of a kernel (kernelName != NULL) or a 
+//transfer (kernelName == NULL) until its device timestamps are collected.
+void OpenCLDriver::add_profiling_event(cl_event event, const char *kernelName, int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
+	profevent_t profEvent;
+	clRetainEvent(event);
+	profEvent.event = event;
+	profEvent.kernelName = kernelName;
+	tconf->pendingProfEvents.push_back(profEvent);
+	if( tconf->pendingProfEvents.size() >= PROFILING_EVENT_COLLECT_THRESHOLD ) {
+		collect_profiling_events(false, threadID);
+	}
+}
+
+//Add the device execution time (CL_PROFILING_COMMAND_START to _END) of each 
+//completed command in the pending event list to KernelTimingMap or 
+//totalMemTrTime, and release its event. If waitForAll is true, wait for 
+//all pending commands; otherwise, commands still running stay pending.
+void OpenCLDriver::collect_profiling_events(bool waitForAll, int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
+	std::vector<profevent_t> &pendingEvents = tconf->pendingProfEvents;
+	size_t numPending = 0;
+	for( size_t i=0; i<pendingEvents.size(); i++ ) {
+		profevent_t profEvent = pendingEvents[i];
+		cl_int status = CL_COMPLETE;
+		if( waitForAll ) {
+			clWaitForEvents(1, &(profEvent.event));
+		} else if( clGetEventInfo(profEvent.event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL) != CL_SUCCESS ) {
+			status = CL_COMPLETE;
+		}
+		if( status > CL_COMPLETE ) {
+			pendingEvents[numPending++] = profEvent;
+			continue;
+		}
+		cl_ulong startTime = 0;
+		cl_ulong endTime = 0;
+		if( (status == CL_COMPLETE) 
+			&& (clGetEventProfilingInfo(profEvent.event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &startTime, NULL) == CL_SUCCESS)
+			&& (clGetEventProfilingInfo(profEvent.event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &endTime, NULL) == CL_SUCCESS)
+			&& (endTime > startTime) ) {
+			double elapsedTime = ((double)(endTime - startTime))*1.0e-9;
+			if( profEvent.kernelName != NULL ) {
+				tconf->KernelTimingMap[profEvent.kernelName] += elapsedTime;
+			} else {
+				tconf->totalMemTrTime += elapsedTime;
+			}
+		}
+		clReleaseEvent(profEvent.event);
+	}
+	pendingEvents.resize(numPending);
+}
+#endif
+
 HI_error_t OpenCLDriver::HI_synchronize( int forcedSync, int threadID )
 {
     cl_int ciErr1;
@@ -2764,6 +3651,12 @@ HI_error_t OpenCLDriver::HI_synchronize( int forcedSync, int threadID )
 #endif
         	return HI_error;
 		}
+		defaultqueuemarker_t *defaultQueueMarker = &threadDefaultQueueMarkerMap.at(tconf->threadID);
+		defaultQueueMarker->doneCnt = defaultQueueMarker->cmdCnt;
+		HI_reclaim_completed_frees(tconf->threadID);
+#ifdef _OPENARC_PROFILE_
+		collect_profiling_events(false, tconf->threadID);
+#endif
     }
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2782,6 +3675,7 @@ void OpenCLDriver::HI_set_async(int asyncId, int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     int thread_id = tconf->threadID;
+    cl_command_queue asyncQueue;
 #ifdef _THREAD_SAFETY
         pthread_mutex_lock(&mutex_set_async);
 #else
@@ -2794,18 +3688,23 @@ void OpenCLDriver::HI_set_async(int asyncId, int threadID) {
         asyncId += 2;
         std::map<int, cl_command_queue >::iterator it= queueMap.find(asyncId);
 
-        if(it == queueMap.end()) {
+        if( asyncQueuePoolSize > 0 ) {
+            asyncQueue = map_pooled_async_queue(asyncId, thread_id);
+            queueMap[asyncId] = asyncQueue;
+        } else if(it == queueMap.end()) {
             cl_command_queue queue;
-#if defined(CL_VERSION_2_0)
-    		queue = clCreateCommandQueueWithProperties(clContext, clDevice, NULL, &err);
-#else
-            queue = clCreateCommandQueue(clContext, clDevice, 0, &err);
-#endif
+    		queue = HI_create_command_queue(clContext, clDevice, &err);
             if(err != CL_SUCCESS) {
                 fprintf(stderr, "[ERROR in OpenCLDriver::HI_set_async()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
 				exit(1);
             }
             queueMap[asyncId] = queue;
+            asyncQueue = queue;
+#ifdef _OPENARC_PROFILE_
+            tconf->AsyncQueueCnt++;
+#endif
+        } else {
+            asyncQueue = it->second;
         }
 
         std::map<int, std::map<int, cl_event> >::iterator threadIt;
@@ -2845,12 +3744,48 @@ void OpenCLDriver::HI_set_async(int asyncId, int threadID) {
 	if( unifiedMemSupported == 0 ) {
 		//We need explicit synchronization here since HI_synchronize() does not
 		//explicitly synchronize if unified memory is not used.
-    	//cl_int ciErr1 = clFinish(clQueue);
-    	cl_int ciErr1 = clFinish(getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID));
-    	if (ciErr1 != CL_SUCCESS)
-    	{
-        	printf("Error in clFinish, Line %u in file %s : %d\n\n", __LINE__, __FILE__, ciErr1);
-			exit(1);
+		//Instead of blocking the host until the default queue drains, the async 
+		//queue waits for a marker of the work enqueued so far to the default 
+		//queue. The default queue is flushed so that the marker is submitted 
+		//to the device before another queue waits on it.
+		//Nothing is enqueued if no non-blocking command was enqueued to the 
+		//default queue since it was last finished or since the async queue was
+		//last ordered after it; a new marker is enqueued only if commands were
+		//enqueued after the last marker.
+    	cl_command_queue defaultQueue = getQueue(DEFAULT_QUEUE+tconf->asyncID_offset, tconf->threadID);
+		defaultqueuemarker_t *defaultQueueMarker = &threadDefaultQueueMarkerMap.at(tconf->threadID);
+		unsigned long *orderedCnt = &defaultQueueMarker->orderedCnt[asyncId];
+		if( (asyncQueue != defaultQueue) && (defaultQueueMarker->doneCnt != defaultQueueMarker->cmdCnt) && (*orderedCnt != defaultQueueMarker->cmdCnt) ) {
+			cl_int ciErr1 = CL_SUCCESS;
+			if( (defaultQueueMarker->marker == NULL) || (defaultQueueMarker->markerCnt != defaultQueueMarker->cmdCnt) ) {
+				cl_event marker;
+#if defined(CL_VERSION_1_2)
+    			ciErr1 = clEnqueueMarkerWithWaitList(defaultQueue, 0, NULL, &marker);
+#else
+    			ciErr1 = clEnqueueMarker(defaultQueue, &marker);
+#endif
+				if( ciErr1 == CL_SUCCESS ) {
+					if( defaultQueueMarker->marker != NULL ) {
+						clReleaseEvent(defaultQueueMarker->marker);
+					}
+					defaultQueueMarker->marker = marker;
+					defaultQueueMarker->markerCnt = defaultQueueMarker->cmdCnt;
+					ciErr1 = clFlush(defaultQueue);
+				}
+			}
+			if( ciErr1 == CL_SUCCESS ) {
+#if defined(CL_VERSION_1_2)
+            	ciErr1 = clEnqueueMarkerWithWaitList(asyncQueue, 1, &(defaultQueueMarker->marker), NULL);
+#else
+            	ciErr1 = clEnqueueWaitForEvents(asyncQueue, 1, &(defaultQueueMarker->marker));
+#endif
+			}
+    		if (ciErr1 != CL_SUCCESS)
+    		{
+        		fprintf(stderr, "[ERROR in OpenCLDriver::HI_set_async()] failed to order async queue %d after the default queue with error %d (%s)\n", asyncId-2, ciErr1, opencl_error_code(ciErr1));
+				exit(1);
+			}
+			*orderedCnt = defaultQueueMarker->cmdCnt;
 		}
     }
 #ifdef _OPENARC_PROFILE_
@@ -2860,6 +3795,98 @@ void OpenCLDriver::HI_set_async(int asyncId, int threadID) {
 #endif
 }
 
+//Count a non-blocking command enqueued by the host thread to the queue of 
+//async; HI_set_async() uses the count of the default queue.
+void OpenCLDriver::count_queue_command(int async, HostConf_t *tconf) {
+	if( async == DEFAULT_QUEUE+tconf->asyncID_offset ) {
+		threadDefaultQueueMarkerMap.at(tconf->threadID).cmdCnt++;
+	}
+}
+
+//Map the logical async queue (asyncKey = async ID + 2) onto a command queue 
+//of the async queue pool; called with the HI_set_async() lock held.
+//A logical queue keeps its command queue under the round-robin policy. Under 
+//the least-loaded policy, it moves to the command queue with the fewest 
+//logical queues if that queue is less loaded even after the move; the moved 
+//queue's new command queue first waits for the last command enqueued on the 
+//logical queue, so the order within the logical queue is preserved.
+cl_command_queue OpenCLDriver::map_pooled_async_queue(int asyncKey, int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
+    std::map<int, int>::iterator it = asyncQueuePoolMap.find(asyncKey);
+    int current = (it == asyncQueuePoolMap.end()) ? -1 : it->second;
+    int target;
+    if( asyncQueuePoolPolicy == ASYNC_QUEUE_POOL_LEASTLOADED ) {
+        target = 0;
+        for( int i = 1; i < asyncQueuePoolSize; i++ ) {
+            if( asyncQueuePool[i].numBound < asyncQueuePool[target].numBound ) {
+                target = i;
+            }
+        }
+        if( (current >= 0) && (asyncQueuePool[current].numBound - 1 <= asyncQueuePool[target].numBound) ) {
+            return asyncQueuePool[current].queue;
+        }
+    } else {
+        if( current >= 0 ) {
+            return asyncQueuePool[current].queue;
+        }
+        target = asyncQueuePoolNext;
+        asyncQueuePoolNext = (asyncQueuePoolNext + 1) % asyncQueuePoolSize;
+    }
+
+    cl_int err;
+    asyncqueuepoolentry_t *poolEntry = &asyncQueuePool[target];
+    if( poolEntry->queue == NULL ) {
+        poolEntry->queue = HI_create_command_queue(clContext, clDevice, &err);
+        if(err != CL_SUCCESS) {
+            fprintf(stderr, "[ERROR in OpenCLDriver::map_pooled_async_queue()] failed to create OPENCL queue with error %d (%s)\n", err, opencl_error_code(err));
+            exit(1);
+        }
+#ifdef _OPENARC_PROFILE_
+        tconf->AsyncQueueCnt++;
+#endif
+    }
+    if( current >= 0 ) {
+        asyncQueuePool[current].numBound--;
+        cl_event *event = getEvent_ifpresent(asyncKey - 2, tconf->threadID);
+        if( (event != NULL) && (*event != NULL) ) {
+            cl_int status = CL_QUEUED;
+            clGetEventInfo(*event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+            if( status != CL_COMPLETE ) {
+                //Submit the previous command queue's work before the new 
+                //command queue waits on it.
+                err = clFlush(asyncQueuePool[current].queue);
+                if(err != CL_SUCCESS) {
+                    fprintf(stderr, "[ERROR in OpenCLDriver::map_pooled_async_queue()] failed to flush the previous command queue of async queue %d with error %d (%s)\n", asyncKey - 2, err, opencl_error_code(err));
+                    exit(1);
+                }
+#if defined(CL_VERSION_1_2)
+                err = clEnqueueMarkerWithWaitList(poolEntry->queue, 1, event, NULL);
+#else
+                err = clEnqueueWaitForEvents(poolEntry->queue, 1, event);
+#endif
+                if(err != CL_SUCCESS) {
+                    fprintf(stderr, "[ERROR in OpenCLDriver::map_pooled_async_queue()] failed to order async queue %d after its previous command queue with error %d (%s)\n", asyncKey - 2, err, opencl_error_code(err));
+                    exit(1);
+                }
+            }
+        }
+    }
+#ifdef _OPENARC_PROFILE_
+    else {
+        tconf->LogicalAsyncQueueCnt++;
+    }
+    if( poolEntry->numBound > 0 ) {
+        tconf->AsyncQueueContentionCnt++;
+    }
+    if( HI_openarcrt_verbosity > 1 ) {
+        fprintf(stderr, "[OPENARCRT-INFO]\t\tOpenCLDriver::map_pooled_async_queue(): async queue %d is mapped to command queue %d of the pool\n", asyncKey - 2 - tconf->asyncID_offset, target);
+    }
+#endif
+    poolEntry->numBound++;
+    asyncQueuePoolMap[asyncKey] = target;
+    return poolEntry->queue;
+}
+
 void OpenCLDriver::HI_set_context(int threadID) {
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -2900,7 +3927,9 @@ void OpenCLDriver::HI_wait(int arg, int threadID) {
 
 	HI_postponed_free(arg, tconf->threadID);
 	HI_postponed_tempFree(arg, tconf->acc_device_type_var, tconf->threadID);
+	setQueueIdle(arg, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait(%d)\n", arg);
 	}
@@ -2926,8 +3955,10 @@ void OpenCLDriver::HI_wait_ifpresent(int arg, int threadID) {
 
 		HI_postponed_free(arg, tconf->threadID);
 		HI_postponed_tempFree(arg, tconf->acc_device_type_var, tconf->threadID);
+		setQueueIdle(arg, tconf->threadID);
 	}
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait_ifpresent(%d)\n", arg);
 	}
@@ -2954,6 +3985,7 @@ void OpenCLDriver::HI_wait_async(int arg, int async, int threadID) {
 
 	HI_postponed_free(arg, tconf->threadID);
 	HI_postponed_tempFree(arg, tconf->acc_device_type_var, tconf->threadID);
+	setQueueIdle(arg, tconf->threadID);
 
     err = clWaitForEvents(1, event2);
 
@@ -2963,6 +3995,7 @@ void OpenCLDriver::HI_wait_async(int arg, int async, int threadID) {
     }
 
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait_async(%d, %d)\n", arg, async);
 	}
@@ -2990,6 +4023,7 @@ void OpenCLDriver::HI_wait_async_ifpresent(int arg, int async, int threadID) {
 
 		HI_postponed_free(arg, tconf->threadID);
 		HI_postponed_tempFree(arg, tconf->acc_device_type_var, tconf->threadID);
+		setQueueIdle(arg, tconf->threadID);
 
     	err = clWaitForEvents(1, event2);
 
@@ -3000,6 +4034,7 @@ void OpenCLDriver::HI_wait_async_ifpresent(int arg, int async, int threadID) {
 	}
 
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait_async_ifpresent(%d, %d)\n", arg, async);
 	}
@@ -3024,8 +4059,10 @@ void OpenCLDriver::HI_waitS1(int asyncId, int threadID) {
         fprintf(stderr, "[ERROR in OpenCLDriver::HI_waitS1()] failed wait on OpenCL queue %d with error %d (%s)\n", asyncId, err, opencl_error_code(err));
 		exit(1);
     }
+    HI_reclaim_completed_frees(tconf->threadID);
 
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_waitS1(%d)\n", asyncId);
 	}
@@ -3044,6 +4081,7 @@ void OpenCLDriver::HI_waitS2(int asyncId, int threadID) {
 	HI_postponed_free(asyncId, tconf->threadID);
 	HI_postponed_tempFree(asyncId, tconf->acc_device_type_var, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_waitS2(%d)\n", asyncId);
 	}
@@ -3058,21 +4096,28 @@ void OpenCLDriver::HI_wait_all(int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     eventmap_opencl_t *eventMap = &threadQueueEventMap.at(tconf->threadID);
+    activequeueset_t *activeQueues = &threadActiveQueueMap.at(tconf->threadID);
     cl_int err;
 
-    for(eventmap_opencl_t::iterator it = eventMap->begin(); it != eventMap->end(); ++it) {
-        //clGetEventInfo((it->second), CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(err), &err, NULL);
-        //fprintf(stderr, "[OpenCLDriver::HI_wait_all()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, it->first);
-        err = clWaitForEvents(1, &(it->second));
+    //Only the queues with pending work have to be waited on.
+    for(size_t i = 0; i < activeQueues->queues.size(); i++) {
+        int queueKey = activeQueues->queues[i];
+        //clGetEventInfo(eventMap->at(queueKey), CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(err), &err, NULL);
+        //fprintf(stderr, "[OpenCLDriver::HI_wait_all()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, queueKey);
+        err = clWaitForEvents(1, &(eventMap->at(queueKey)));
         if(err != CL_SUCCESS) {
-            fprintf(stderr, "[ERROR in OpenCLDriver::HI_wait_all()] failed wait on OpenCL queue %d with error %d (%s)\n", it->first, err, opencl_error_code(err));
+            fprintf(stderr, "[ERROR in OpenCLDriver::HI_wait_all()] failed wait on OpenCL queue %d with error %d (%s)\n", queueKey, err, opencl_error_code(err));
 			exit(1);
         }
-		HI_postponed_free(it->first-2, tconf->threadID);
-		HI_postponed_tempFree(it->first-2, tconf->acc_device_type_var, tconf->threadID);
+		HI_postponed_free(queueKey-2, tconf->threadID);
+		HI_postponed_tempFree(queueKey-2, tconf->acc_device_type_var, tconf->threadID);
     }
+    activeQueues->clear();
+    //Release the reclaim requests of the queues freed above.
+    HI_reclaim_completed_frees(tconf->threadID);
 
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(true, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait_all()\n");
 	}
@@ -3087,19 +4132,22 @@ void OpenCLDriver::HI_wait_all_async(int async, int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     eventmap_opencl_t *eventMap = &threadQueueEventMap.at(tconf->threadID);
+    activequeueset_t *activeQueues = &threadActiveQueueMap.at(tconf->threadID);
     cl_int err;
 
-    for(eventmap_opencl_t::iterator it = eventMap->begin(); it != eventMap->end(); ++it) {
-        //clGetEventInfo((it->second), CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(err), &err, NULL);
-        //fprintf(stderr, "[OpenCLDriver::HI_wait_all_async()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, it->first);
-        err = clWaitForEvents(1, &(it->second));
+    for(size_t i = 0; i < activeQueues->queues.size(); i++) {
+        int queueKey = activeQueues->queues[i];
+        //clGetEventInfo(eventMap->at(queueKey), CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(err), &err, NULL);
+        //fprintf(stderr, "[OpenCLDriver::HI_wait_all_async()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, queueKey);
+        err = clWaitForEvents(1, &(eventMap->at(queueKey)));
         if(err != CL_SUCCESS) {
-            fprintf(stderr, "[ERROR in OpenCLDriver::HI_wait_all_async()] failed wait on OpenCL queue %d with error %d (%s)\n", it->first, err, opencl_error_code(err));
+            fprintf(stderr, "[ERROR in OpenCLDriver::HI_wait_all_async()] failed wait on OpenCL queue %d with error %d (%s)\n", queueKey, err, opencl_error_code(err));
 			exit(1);
         }
-		HI_postponed_free(it->first-2, tconf->threadID);
-		HI_postponed_tempFree(it->first-2, tconf->acc_device_type_var, tconf->threadID);
+		HI_postponed_free(queueKey-2, tconf->threadID);
+		HI_postponed_tempFree(queueKey-2, tconf->acc_device_type_var, tconf->threadID);
     }
+    activeQueues->clear();
 
     cl_event *event2 = getEvent(async, tconf->threadID);
     err = clWaitForEvents(1, event2);
@@ -3110,6 +4158,7 @@ void OpenCLDriver::HI_wait_all_async(int async, int threadID) {
     }
 
 #ifdef _OPENARC_PROFILE_
+	collect_profiling_events(false, tconf->threadID);
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_wait_all_async(%d)\n", async);
 	}
@@ -3142,6 +4191,7 @@ int OpenCLDriver::HI_async_test(int asyncId, int threadID) {
     }
     HI_postponed_free(asyncId, tconf->threadID);
 	HI_postponed_tempFree(asyncId, tconf->acc_device_type_var, tconf->threadID);
+	setQueueIdle(asyncId, tconf->threadID);
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_async_test(%d)\n", asyncId);
@@ -3177,6 +4227,7 @@ int OpenCLDriver::HI_async_test_ifpresent(int asyncId, int threadID) {
     	}
     	HI_postponed_free(asyncId, tconf->threadID);
 		HI_postponed_tempFree(asyncId, tconf->acc_device_type_var, tconf->threadID);
+		setQueueIdle(asyncId, tconf->threadID);
 	}
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
@@ -3194,29 +4245,29 @@ int OpenCLDriver::HI_async_test_all(int threadID) {
 #endif
     HostConf_t * tconf = getHostConf(threadID);
     eventmap_opencl_t *eventMap = &threadQueueEventMap.at(tconf->threadID);
+    activequeueset_t *activeQueues = &threadActiveQueueMap.at(tconf->threadID);
     cl_int err, status;
 
-    std::set<int> queuesChecked;
-
-    for(eventmap_opencl_t::iterator it = eventMap->begin(); it != eventMap->end(); ++it) {
-        //fprintf(stderr, "[OpenCLDriver::HI_wait_all()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, it->first);
-        err = clGetEventInfo(it->second,  CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+    //Idle queues have nothing to test.
+    for(size_t i = 0; i < activeQueues->queues.size(); i++) {
+        int queueKey = activeQueues->queues[i];
+        //fprintf(stderr, "[OpenCLDriver::HI_wait_all()] status is %d on queue %d (NVIDIA CUDA GPU)\n", err, queueKey);
+        err = clGetEventInfo(eventMap->at(queueKey),  CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
         if(err != CL_SUCCESS) {
-            fprintf(stderr, "[ERROR in OpenCLDriver::HI_async_test_all()] failed test on OpenCL queue %d with error %d (%s)\n", it->first, err, opencl_error_code(err));
+            fprintf(stderr, "[ERROR in OpenCLDriver::HI_async_test_all()] failed test on OpenCL queue %d with error %d (%s)\n", queueKey, err, opencl_error_code(err));
 			exit(1);
         }
         if(status != CL_COMPLETE) {
             return 0;
         }
-        queuesChecked.insert(it->first);
     }
 
     //release the waiting frees
-    std::set<int>::iterator it;
-    for (it=queuesChecked.begin(); it!=queuesChecked.end(); ++it) {
-        HI_postponed_free(*it, tconf->threadID);
-		HI_postponed_tempFree(*it, tconf->acc_device_type_var, tconf->threadID);
+    for(size_t i = 0; i < activeQueues->queues.size(); i++) {
+        HI_postponed_free(activeQueues->queues[i]-2, tconf->threadID);
+		HI_postponed_tempFree(activeQueues->queues[i]-2, tconf->acc_device_type_var, tconf->threadID);
     }
+    activeQueues->clear();
 #ifdef _OPENARC_PROFILE_
 	if( HI_openarcrt_verbosity > 2 ) {
 		fprintf(stderr, "[OPENARCRT-INFO]\t\texit OpenCLDriver::HI_async_test_all()\n");
@@ -3239,11 +4290,18 @@ void OpenCLDriver::HI_wait_for_events(int async, int num_waits, int* waits, int
 //		exit(1);
 //#else
         cl_command_queue queue = getQueue(async, tconf->threadID);
-        cl_event* event_wait_list = new cl_event[num_waits];
+        //Short wait lists are kept on the stack.
+        cl_event inline_wait_list[INLINE_EVENT_WAIT_LIST_SIZE];
+        cl_event* event_wait_list = inline_wait_list;
+        if( num_waits > INLINE_EVENT_WAIT_LIST_SIZE ) {
+            event_wait_list = new cl_event[num_waits];
+        }
         cl_uint num_events_in_wait_list = 0;
         for (int i = 0; i < num_waits; i++) {
             if (waits[i] == async) continue;
-            event_wait_list[num_events_in_wait_list++] = *getEvent(waits[i], tconf->threadID);
+            cl_event waitEvent = *getEvent(waits[i], tconf->threadID);
+            if (waitEvent == NULL) continue;
+            event_wait_list[num_events_in_wait_list++] = waitEvent;
         }
         if (num_events_in_wait_list > 0) {
 #if defined(CL_VERSION_1_2)
@@ -3256,7 +4314,9 @@ void OpenCLDriver::HI_wait_for_events(int async, int num_waits, int* waits, int
                 exit(1);
             }
         }
-        //TODO: delete[] event_wait_list;
+        if( event_wait_list != inline_wait_list ) {
+            delete[] event_wait_list;
+        }
 //#endif
     }
 
@@ -3267,6 +4327,65 @@ void OpenCLDriver::HI_wait_for_events(int async, int num_waits, int* waits, int
 #endif
 }
 
+//Completion callback of the last command enqueued on an async queue before 
+//postponed frees were added to the queue. It runs on an OpenCL runtime 
+//thread, so it only pushes the reclaim request to the host thread, which 
+//frees the memory at its next device memory allocation or synchronization.
+static void CL_CALLBACK HI_postponed_free_callback(cl_event event, cl_int status, void *userData) {
+	reclaimticket_t *ticket = (reclaimticket_t *)userData;
+	reclaimticket_t *head = __atomic_load_n(ticket->reclaimTickets, __ATOMIC_RELAXED);
+	do {
+		ticket->next = head;
+	} while( !__atomic_compare_exchange_n(ticket->reclaimTickets, &head, ticket, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED) );
+}
+
+void OpenCLDriver::HI_schedule_postponed_free(int asyncID, int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
+    cl_event *event = getEvent_ifpresent(asyncID, tconf->threadID);
+    if( event == NULL ) {
+        return;
+    }
+    setQueueActive(asyncID, tconf->threadID);
+    //The queue is in-order, and thus the postponed frees can be reclaimed 
+    //once the last command enqueued so far completes.
+    if( (asyncID == DEFAULT_QUEUE+tconf->asyncID_offset) || (*event == NULL) ) {
+        return;
+    }
+    postponedfreecount_t *freeCount = &(postponedFreeInfoMap[tconf->threadID]->countMap[asyncID]);
+    reclaimticket_t *ticket = new reclaimticket_t;
+    ticket->next = NULL;
+    ticket->reclaimTickets = &(tconf->reclaimTickets);
+    ticket->device = this;
+    ticket->event = *event;
+    ticket->asyncID = asyncID;
+    ticket->freeMark = freeCount->freeInserted;
+    ticket->tempFreeMark = freeCount->tempFreeInserted;
+    clRetainEvent(ticket->event);
+    cl_int err = clSetEventCallback(ticket->event, CL_COMPLETE, HI_postponed_free_callback, ticket);
+    if( err != CL_SUCCESS ) {
+        //Leave the postponed frees to the next synchronization call.
+        clReleaseEvent(ticket->event);
+        delete ticket;
+    }
+}
+
+//Reclaim the postponed frees whose async queue commands have completed, as 
+//reported by HI_postponed_free_callback().
+void OpenCLDriver::HI_reclaim_completed_frees(int threadID) {
+    HostConf_t * tconf = getHostConf(threadID);
+    if( __atomic_load_n(&(tconf->reclaimTickets), __ATOMIC_RELAXED) == NULL ) {
+        return;
+    }
+    reclaimticket_t *ticket = __atomic_exchange_n(&(tconf->reclaimTickets), (reclaimticket_t *)NULL, __ATOMIC_ACQUIRE);
+    while( ticket != NULL ) {
+        reclaimticket_t *next = ticket->next;
+        ticket->device->HI_reclaim_postponed_free(ticket->asyncID, ticket->freeMark, ticket->tempFreeMark, tconf->threadID);
+        clReleaseEvent(ticket->event);
+        delete ticket;
+        ticket = next;
+    }
+}
+
 void OpenCLDriver::HI_malloc(void **devPtr, size_t size, HI_MallocKind_t flags, int threadID) {
     cl_int  err;
 #ifdef _OPENARC_PROFILE_
@@ -3289,15 +4408,7 @@ void OpenCLDriver::HI_malloc(void **devPtr, size_t size, HI_MallocKind_t flags,
         fprintf(stderr, "[ERROR in OpenCLDriver::HI_malloc()] :failed to malloc on OpenCL with clCreateBuffer error %d (%s)\n", err, opencl_error_code(err));
 		exit(1);
     }
-#if defined(OPENARC_ARCH) && OPENARC_ARCH == 3
-	if( HI_openarcrt_memoryalignment > 0 ) {
-		posix_memalign(devPtr, AOCL_ALIGNMENT, size);
-	} else {
-		*devPtr = malloc(size); //redundant malloc to create a fake device pointer.
-	}
-#else
-	*devPtr = malloc(size); //redundant malloc to create a fake device pointer.
-#endif
+	*devPtr = HI_malloc_fake_device_address(size);
 	if( *devPtr == NULL ) {
         fprintf(stderr, "[ERROR in OpenCLDriver::HI_malloc()] :fake device malloc failed\n");
 		exit(1);
@@ -3332,7 +4443,7 @@ void OpenCLDriver::HI_free(void *devPtr, int threadID) {
         //Free device memory if it is not on unified memory.
 		HI_device_mem_handle_t tHandle;
 		if( HI_get_device_mem_handle(devPtr, &tHandle, tconf->threadID) == HI_success ) { 
-       		err = clReleaseMemObject((cl_mem)(tHandle.memHandle));
+       		err = HI_release_mem_object((cl_mem)(tHandle.memHandle));
 #ifdef _OPENARC_PROFILE_
 			tconf->IDFreeCnt++;
 #endif
@@ -3340,7 +4451,7 @@ void OpenCLDriver::HI_free(void *devPtr, int threadID) {
         		fprintf(stderr, "[ERROR in OpenCLDriver::HI_free()] :failed to free on OpenCL with error %d (%s)\n", err, opencl_error_code(err));
 				exit(1);
 			}
-			free(devPtr);
+			HI_free_fake_device_address(devPtr);
 			HI_remove_device_mem_handle(devPtr, tconf->threadID);
 		}
 	}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt.h"
+
+//Unit test and benchmark of the device-address reverse index of the
+//per-thread present table (presenttable_t::findDevice()), which
+//HI_get_host_address uses to translate a device pointer back to its host
+//pointer. The benchmark compares the reverse index with a linear scan of
+//all mappings, which is how HI_get_host_address searched the present table
+//before the reverse index was added, for increasing numbers of mappings.
+
+#ifndef _MAX_ENTRIES_
+#define _MAX_ENTRIES_ 100000
+#endif
+#ifndef _LOOKUPS_
+#define _LOOKUPS_ 1000000
+#endif
+
+#define HOST_BASE 0x100000000UL
+#define DEVICE_BASE 0x700000000UL
+#define RANGE_STRIDE 4096
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static void *host_addr(size_t i) {
+	return (void *)(HOST_BASE + i*RANGE_STRIDE);
+}
+
+static void *dev_addr(size_t i) {
+	return (void *)(DEVICE_BASE + i*RANGE_STRIDE);
+}
+
+//Resolve devPtr to its host pointer on the asyncID queue; NULL if unmapped.
+static const void *to_host(presenttable_t *table, const void *devPtr, int asyncID) {
+	addresstable_entity_t aet(NULL, 0);
+	size_t offset = 0;
+	if( !table->findDevice(devPtr, asyncID, &aet, &offset) ) {
+		return NULL;
+	}
+	return (const void *)((const char *)aet.hostPtr + offset);
+}
+
+static void test_base_and_interior() {
+	presenttable_t table;
+	table.insert(host_addr(0), dev_addr(5), 1000, DEFAULT_QUEUE);
+	table.insert(host_addr(1), dev_addr(3), 1000, DEFAULT_QUEUE);
+	CHECK( to_host(&table, dev_addr(5), DEFAULT_QUEUE) == host_addr(0) );
+	CHECK( to_host(&table, (char *)dev_addr(5) + 999, DEFAULT_QUEUE) == (char *)host_addr(0) + 999 );
+	CHECK( to_host(&table, (char *)dev_addr(3) + 10, DEFAULT_QUEUE) == (char *)host_addr(1) + 10 );
+	//The end of a range and gaps between ranges are not mapped.
+	CHECK( to_host(&table, (char *)dev_addr(5) + 1000, DEFAULT_QUEUE) == NULL );
+	CHECK( to_host(&table, dev_addr(4), DEFAULT_QUEUE) == NULL );
+	CHECK( to_host(&table, dev_addr(0), DEFAULT_QUEUE) == NULL );
+	//A zero-sized mapping resolves only its base address.
+	table.insert(host_addr(2), dev_addr(7), 0, DEFAULT_QUEUE);
+	CHECK( to_host(&table, dev_addr(7), DEFAULT_QUEUE) == host_addr(2) );
+	CHECK( to_host(&table, (char *)dev_addr(7) + 1, DEFAULT_QUEUE) == NULL );
+}
+
+static void test_async_queues() {
+	presenttable_t table;
+	table.insert(host_addr(0), dev_addr(0), 100, DEFAULT_QUEUE);
+	table.insert(host_addr(1), dev_addr(1), 100, 3);
+	CHECK( to_host(&table, dev_addr(0), DEFAULT_QUEUE) == host_addr(0) );
+	CHECK( to_host(&table, dev_addr(0), 3) == NULL );
+	CHECK( to_host(&table, dev_addr(1), 3) == host_addr(1) );
+	CHECK( to_host(&table, dev_addr(1), DEFAULT_QUEUE) == NULL );
+}
+
+static void test_replace_and_erase() {
+	presenttable_t table;
+	//Remapping a host pointer drops the reverse entry of the old mapping.
+	table.insert(host_addr(0), dev_addr(0), 100, DEFAULT_QUEUE);
+	table.insert(host_addr(0), dev_addr(9), 100, DEFAULT_QUEUE);
+	CHECK( table.size() == 1 );
+	CHECK( to_host(&table, dev_addr(0), DEFAULT_QUEUE) == NULL );
+	CHECK( to_host(&table, dev_addr(9), DEFAULT_QUEUE) == host_addr(0) );
+	CHECK( table.erase(host_addr(0), DEFAULT_QUEUE) );
+	CHECK( to_host(&table, dev_addr(9), DEFAULT_QUEUE) == NULL );
+	CHECK( !table.erase(host_addr(0), DEFAULT_QUEUE) );
+
+	//If a device address is re-registered by another host pointer, removing
+	//the first host pointer keeps the reverse entry of the second one.
+	table.insert(host_addr(1), dev_addr(2), 100, DEFAULT_QUEUE);
+	table.insert(host_addr(2), dev_addr(2), 100, DEFAULT_QUEUE);
+	CHECK( to_host(&table, dev_addr(2), DEFAULT_QUEUE) == host_addr(2) );
+	CHECK( table.erase(host_addr(1), DEFAULT_QUEUE) );
+	CHECK( to_host(&table, dev_addr(2), DEFAULT_QUEUE) == host_addr(2) );
+	CHECK( table.erase(host_addr(2), DEFAULT_QUEUE) );
+	CHECK( to_host(&table, dev_addr(2), DEFAULT_QUEUE) == NULL );
+	CHECK( table.size() == 0 );
+}
+
+//Linear scan over all mappings of the asyncID queue.
+static const void *to_host_linear(const std::vector<addresstable_entity_t> &entries, const void *devPtr) {
+	for( size_t i=0; i<entries.size(); i++ ) {
+		const addresstable_entity_t &aet = entries[i];
+		if( ((size_t)devPtr >= (size_t)aet.basePtr) && ((size_t)devPtr < (size_t)aet.basePtr + aet.size) ) {
+			return (const void *)((const char *)aet.hostPtr + ((size_t)devPtr - (size_t)aet.basePtr));
+		}
+	}
+	return NULL;
+}
+
+static void benchmark(size_t numEntries) {
+	presenttable_t table;
+	//Device ranges are placed in a different order from host ranges.
+	std::vector<size_t> devSlots(numEntries);
+	for( size_t i=0; i<numEntries; i++ ) {
+		devSlots[i] = i;
+	}
+	srand(numEntries);
+	for( size_t i=numEntries; i>1; i-- ) {
+		size_t j = rand() % i;
+		size_t t = devSlots[i-1];
+		devSlots[i-1] = devSlots[j];
+		devSlots[j] = t;
+	}
+	for( size_t i=0; i<numEntries; i++ ) {
+		table.insert(host_addr(i), dev_addr(devSlots[i]), RANGE_STRIDE/2, DEFAULT_QUEUE);
+	}
+	std::vector<addresstable_entity_t> entries;
+	table.getEntries(entries);
+
+	//Random interior device pointers of mapped ranges.
+	std::vector<const void *> queries(1024);
+	for( size_t q=0; q<queries.size(); q++ ) {
+		queries[q] = (const char *)dev_addr(rand() % numEntries) + (rand() % (RANGE_STRIDE/2));
+	}
+
+	size_t numLookups = _LOOKUPS_;
+	size_t mismatches = 0;
+	double stime = my_timer();
+	for( size_t l=0; l<numLookups; l++ ) {
+		const void *devPtr = queries[l % queries.size()];
+		if( to_host(&table, devPtr, DEFAULT_QUEUE) == NULL ) {
+			mismatches++;
+		}
+	}
+	double indexTime = my_timer() - stime;
+
+	//The linear scan is timed with fewer lookups to bound the run time.
+	size_t numLinearLookups = _LOOKUPS_ / numEntries;
+	if( numLinearLookups < queries.size() ) {
+		numLinearLookups = queries.size();
+	}
+	size_t numFound = 0;
+	stime = my_timer();
+	for( size_t l=0; l<numLinearLookups; l++ ) {
+		if( to_host_linear(entries, queries[l % queries.size()]) != NULL ) {
+			numFound++;
+		}
+	}
+	double linearTime = my_timer() - stime;
+	CHECK( numFound == numLinearLookups );
+	for( size_t q=0; q<queries.size(); q++ ) {
+		if( to_host_linear(entries, queries[q]) != to_host(&table, queries[q], DEFAULT_QUEUE) ) {
+			mismatches++;
+		}
+	}
+	CHECK( mismatches == 0 );
+
+	printf("%10lu entries: reverse index %10.1lf ns/lookup, linear scan %12.1lf ns/lookup\n", (unsigned long)numEntries,
+		indexTime*1.0e9/numLookups, linearTime*1.0e9/numLinearLookups);
+}
+
+int main(int argc, char** argv) {
+	test_base_and_interior();
+	test_async_queues();
+	test_replace_and_erase();
+	for( size_t n=10; n<=_MAX_ENTRIES_; n*=10 ) {
+		benchmark(n);
+	}
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
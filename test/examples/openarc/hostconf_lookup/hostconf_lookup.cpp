@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt_ext.h"
+
+//Runtime benchmark of the per-call overhead of getHostConf(), which almost
+//every OpenARC runtime API calls to find the host configuration of the
+//calling host thread. Each thread times getHostConf(), a light runtime API
+//(acc_get_device_type()), and, for comparison, a search of hostConfMap
+//under a mutex, which is what a lookup costs without the per-thread cache.
+//The benchmark is run for 1, 2, 4, ... _MAX_THREADS_ host threads; all
+//threads of a run start timing at the same time.
+
+#ifndef _MAX_THREADS_
+#define _MAX_THREADS_ 8
+#endif
+#ifndef _ITER_
+#define _ITER_ 10000000
+#endif
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static pthread_mutex_t mapMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t barrier;
+static int errors = 0;
+
+typedef struct {
+	double confTime;
+	double apiTime;
+	double mapTime;
+} thread_result_t;
+
+static void *worker(void *arg) {
+	thread_result_t *result = (thread_result_t *)arg;
+	//The first call creates and initializes the host configuration of
+	//this thread.
+	acc_device_t devType = acc_get_device_type();
+	HostConf_t *tconf = getHostConf();
+	int threadID = tconf->threadID;
+	long mismatches = 0;
+	pthread_barrier_wait(&barrier);
+
+	double stime = my_timer();
+	for( long i=0; i<_ITER_; i++ ) {
+		if( getHostConf() != tconf ) {
+			mismatches++;
+		}
+	}
+	result->confTime = my_timer() - stime;
+
+	stime = my_timer();
+	for( long i=0; i<_ITER_; i++ ) {
+		if( acc_get_device_type() != devType ) {
+			mismatches++;
+		}
+	}
+	result->apiTime = my_timer() - stime;
+
+	stime = my_timer();
+	for( long i=0; i<_ITER_; i++ ) {
+		HostConf_t *mconf = NULL;
+		pthread_mutex_lock(&mapMutex);
+		std::map<int, HostConf_t *>::iterator it = hostConfMap.find(threadID);
+		if( it != hostConfMap.end() ) {
+			mconf = it->second;
+		}
+		pthread_mutex_unlock(&mapMutex);
+		if( mconf != tconf ) {
+			mismatches++;
+		}
+	}
+	result->mapTime = my_timer() - stime;
+
+	if( mismatches > 0 ) {
+		printf("[FAILED] %ld lookups returned a wrong host configuration\n", mismatches);
+		__atomic_fetch_add(&errors, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	acc_init(acc_device_default);
+	printf("%7s %22s %22s %22s\n", "threads", "getHostConf (ns/call)", "acc_get_device_type", "locked map search");
+	for( int numThreads=1; numThreads<=_MAX_THREADS_; numThreads*=2 ) {
+		std::vector<pthread_t> threads(numThreads);
+		std::vector<thread_result_t> results(numThreads);
+		pthread_barrier_init(&barrier, NULL, numThreads);
+		for( int t=0; t<numThreads; t++ ) {
+			pthread_create(&threads[t], NULL, worker, &results[t]);
+		}
+		double confTime = 0.0, apiTime = 0.0, mapTime = 0.0;
+		for( int t=0; t<numThreads; t++ ) {
+			pthread_join(threads[t], NULL);
+			confTime += results[t].confTime;
+			apiTime += results[t].apiTime;
+			mapTime += results[t].mapTime;
+		}
+		pthread_barrier_destroy(&barrier);
+		double numCalls = (double)numThreads * _ITER_;
+		printf("%7d %22.2lf %22.2lf %22.2lf\n", numThreads, confTime*1.0e9/numCalls, apiTime*1.0e9/numCalls, mapTime*1.0e9/numCalls);
+	}
+	acc_shutdown(acc_device_default);
+
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+	}
+	return 0;
+}
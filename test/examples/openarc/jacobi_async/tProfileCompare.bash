@@ -0,0 +1,92 @@
+#! /bin/bash
+
+#####################################################################
+# Compare the wall time of the async Jacobi example built with the  #
+# normal runtime (MODE=normal) and with the profiling runtime       #
+# (MODE=profile); since the profiling runtime times kernels and     #
+# async transfers with device event timestamps, both runs should    #
+# keep the same async overlap and take similar time.                #
+#                                                                   #
+# Usage: tProfileCompare.bash [inputSize [inputFile [iterations]]]  #
+#   inputSize: array size (default: 4096)                           #
+#   inputFile: input version (default: jacobi.c_ver4)               #
+#   iterations: Jacobi iterations (default: 1000)                   #
+#####################################################################
+numRuns=3
+baseExeName="jacobi_ACC"
+
+if [ $# -ge 1 ]; then
+	inputSize=$1
+else
+	inputSize=4096
+fi
+if [ $# -ge 2 ]; then
+	inputFile=$2
+else
+	inputFile="jacobi.c_ver4"
+fi
+if [ $# -ge 3 ]; then
+	numIters=$3
+else
+	numIters=1000
+fi
+
+if [ "$openarc" = "" ] || [ ! -d "$openarc" ]; then
+	echo "Environment variable, openarc, should be set up correctly to run this script; exit."
+	exit
+fi
+
+workDir="$openarc/test/examples/openarc/jacobi_async"
+logFile="${workDir}/jacobi_async_ProfileCompare.log"
+
+cd ${workDir}
+echo "## Profile Comparison Starts .... " > ${logFile}
+date >> ${logFile}
+echo "## Input: ${inputFile}, size = ${inputSize}, iterations = ${numIters}" >> ${logFile}
+
+make purge > /dev/null 2>&1
+./O2GBuild.script ${inputSize} ${inputFile} >> ${logFile} 2>&1
+
+for mode in normal profile
+do
+	make clean > /dev/null 2>&1
+	make MODE=${mode} ASIZE=${inputSize} >> ${logFile} 2>&1
+	if [ ! -f "./bin/${baseExeName}" ]; then
+		echo "====> Failed to build ${baseExeName} with MODE=${mode}; see ${logFile}"
+		exit
+	fi
+	cd ./bin
+	best=""
+	j=0
+	while [ $j -lt $numRuns ]
+	do
+		echo "## MODE=${mode}, run ${j}" >> ${logFile}
+		OPENARCRT_VERBOSITY=0 ./${baseExeName} -i ${numIters} > run.log 2>&1
+		cat run.log >> ${logFile}
+		etime=`grep "Accelerator Elapsed time" run.log | head -1 | awk '{print $5}'`
+		if [ "$etime" = "" ]; then
+			echo "====> ${baseExeName} failed with MODE=${mode}; see ${logFile}"
+			exit
+		fi
+		if [ "$best" = "" ]; then
+			best=$etime
+		else
+			best=`echo "$etime $best" | awk '{ if ($1 < $2) print $1; else print $2 }'`
+		fi
+		j=$((j+1))
+	done
+	rm -f run.log
+	cd ../
+	if [ "$mode" = "normal" ]; then
+		normalTime=$best
+	else
+		profileTime=$best
+	fi
+done
+
+echo "Accelerator elapsed time (best of ${numRuns} runs)" | tee -a ${logFile}
+echo "  MODE=normal : ${normalTime} sec" | tee -a ${logFile}
+echo "  MODE=profile: ${profileTime} sec" | tee -a ${logFile}
+echo "  profile / normal = `echo "${profileTime} ${normalTime}" | awk '{ printf("%.3f", $1 / $2) }'`" | tee -a ${logFile}
+date >> ${logFile}
+echo "## Profile Comparison Ends .... " >> ${logFile}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "kernel_source.h"
+
+//Unit test and benchmark of the kernel source loader (HI_load_kernel_source()),
+//which the OpenCL driver and binBuilder use to read the kernel file.
+//Generated kernel files of sizes around the buffer boundaries and well
+//beyond the old 1 MB limit are loaded and compared with the written data;
+//a file whose size is not known in advance (/proc/self/smaps, for which
+//stat() reports 0 bytes) exercises the path that grows the buffer while
+//reading. The load time of large files is reported.
+
+#ifndef _MAX_SIZE_MB_
+#define _MAX_SIZE_MB_ 64
+#endif
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static char fileName[] = "./kernel_source_test.cl";
+
+//Fill the buffer with kernel-like text that differs at every line.
+static void fill_source(char *buf, size_t size) {
+	size_t pos = 0;
+	long line = 0;
+	while( pos < size ) {
+		char lineBuf[64];
+		int len = snprintf(lineBuf, sizeof(lineBuf), "__global float *a%ld; // line %ld\n", line, line);
+		for( int i=0; (i<len) && (pos<size); i++ ) {
+			buf[pos++] = lineBuf[i];
+		}
+		line++;
+	}
+}
+
+static char *write_source(size_t size) {
+	char *buf = (char *)malloc(size + 1);
+	fill_source(buf, size);
+	FILE *fp = fopen(fileName, "wb");
+	CHECK( fp != NULL );
+	if( fp != NULL ) {
+		CHECK( fwrite(buf, 1, size, fp) == size );
+		fclose(fp);
+	}
+	return buf;
+}
+
+static void test_size(size_t size) {
+	char *expected = write_source(size);
+	size_t loadedSize = (size_t)-1;
+	char *source = HI_load_kernel_source(fileName, &loadedSize);
+	CHECK( source != NULL );
+	if( source != NULL ) {
+		CHECK( loadedSize == size );
+		CHECK( memcmp(source, expected, size) == 0 );
+		CHECK( source[loadedSize] == '\0' );
+		free(source);
+	}
+	free(expected);
+}
+
+static void test_unknown_size() {
+	//stat() reports 0 bytes for /proc files, so the loader starts with a 
+	//4 KB buffer and grows it; the file is larger than that.
+	size_t loadedSize = 0;
+	char *source = HI_load_kernel_source("/proc/self/smaps", &loadedSize);
+	CHECK( source != NULL );
+	if( source != NULL ) {
+		CHECK( loadedSize > 4096 );
+		CHECK( strlen(source) == loadedSize );
+		free(source);
+	}
+}
+
+static void test_missing_file() {
+	size_t loadedSize = 12345;
+	CHECK( HI_load_kernel_source("./no_such_kernel_file.cl", &loadedSize) == NULL );
+	CHECK( loadedSize == 12345 );
+	//A directory can be opened but not read.
+	CHECK( HI_load_kernel_source(".", &loadedSize) == NULL );
+}
+
+static void benchmark(size_t size) {
+	char *expected = write_source(size);
+	size_t loadedSize = 0;
+	double stime = my_timer();
+	char *source = HI_load_kernel_source(fileName, &loadedSize);
+	double etime = my_timer() - stime;
+	CHECK( (source != NULL) && (loadedSize == size) );
+	if( source != NULL ) {
+		CHECK( memcmp(source, expected, size) == 0 );
+		free(source);
+	}
+	free(expected);
+	printf("%6lu MB kernel file: loaded in %lf sec (%.1lf MB/s)\n", (unsigned long)(size >> 20), etime, (size/1048576.0)/etime);
+}
+
+int main(int argc, char** argv) {
+	size_t sizes[] = {0, 1, 4095, 4096, 4097, (1 << 20) - 1, 1 << 20, (1 << 20) + 1, 3000000};
+	for( size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++ ) {
+		test_size(sizes[i]);
+	}
+	test_unknown_size();
+	test_missing_file();
+	for( size_t mb=1; mb<=_MAX_SIZE_MB_; mb*=4 ) {
+		benchmark(mb << 20);
+	}
+	unlink(fileName);
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
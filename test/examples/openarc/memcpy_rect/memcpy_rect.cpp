@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt.h"
+
+//Runtime test for the rectangular memory transfer API (HI_memcpy2D,
+//HI_memcpy2D_async, and HI_memcpy3D). Each rectangular transfer is compared
+//with the same region copied row by row with HI_memcpy(), for host-to-device,
+//device-to-host, and device-to-device transfers. The test also compares the
+//time of row-by-row and rectangular copies of halo-exchange-shaped regions
+//(a few columns of a large 2D grid).
+
+#ifndef _W_
+#define _W_ 1000
+#endif
+#ifndef _H_
+#define _H_ 512
+#endif
+#ifndef _D_
+#define _D_ 8
+#endif
+#ifndef _HALO_
+#define _HALO_ 2
+#endif
+#ifndef _ITER_
+#define _ITER_ 20
+#endif
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static char *dev_ptr(d_void *base, size_t offset) {
+	return ((char *)base) + offset;
+}
+
+//Copy a region of width bytes x height rows x depth slices one row at a time.
+static void copy_rows(void *dst, size_t dpitch, const void *src, size_t spitch,
+		size_t width, size_t height, size_t depth, HI_MemcpyKind_t kind) {
+	for( size_t k=0; k<depth; k++ ) {
+		for( size_t j=0; j<height; j++ ) {
+			HI_memcpy(((char *)dst) + (k*height + j)*dpitch, ((const char *)src) + (k*height + j)*spitch, width, kind, 0);
+		}
+	}
+}
+
+static int compare(const char *label, const char *a, const char *b, size_t size) {
+	for( size_t i=0; i<size; i++ ) {
+		if( a[i] != b[i] ) {
+			printf("%s: mismatch at byte %lu\n", label, (unsigned long)i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	//Region: width columns of floats, starting at column 3 of each row,
+	//out of rows with different host and device pitches.
+	size_t spitch = (_W_ + 24) * sizeof(float);
+	size_t dpitch = (_W_ + 56) * sizeof(float);
+	size_t width = (_W_ - 6) * sizeof(float);
+	size_t offset = 3 * sizeof(float);
+	size_t height = _H_;
+	size_t depth = _D_;
+	size_t hsize = spitch * height * depth;
+	size_t dsize = dpitch * height * depth;
+	int errors = 0;
+
+	char *hsrc = (char *)malloc(hsize);
+	char *hzero = (char *)calloc(dsize > hsize ? dsize : hsize, 1);
+	char *hout1 = (char *)malloc(dsize);
+	char *hout2 = (char *)malloc(dsize);
+	for( size_t i=0; i<hsize; i++ ) {
+		hsrc[i] = (char)((i * 7 + 3) % 251);
+	}
+
+	acc_init(acc_device_default);
+	d_void *d1 = acc_malloc(dsize);
+	d_void *d2 = acc_malloc(dsize);
+	d_void *d3 = acc_malloc(dsize);
+
+	//Host to device (2D, 2D async, and 3D)
+	for( int mode=0; mode<3; mode++ ) {
+		size_t tdepth = (mode == 2) ? depth : 1;
+		HI_memcpy(d1, hzero, dsize, HI_MemcpyHostToDevice, 0);
+		HI_memcpy(d2, hzero, dsize, HI_MemcpyHostToDevice, 0);
+		copy_rows(dev_ptr(d1, offset), dpitch, hsrc + offset, spitch, width, height, tdepth, HI_MemcpyHostToDevice);
+		if( mode == 0 ) {
+			HI_memcpy2D(dev_ptr(d2, offset), dpitch, hsrc + offset, spitch, width, height, HI_MemcpyHostToDevice);
+		} else if( mode == 1 ) {
+			HI_memcpy2D_async(dev_ptr(d2, offset), dpitch, hsrc + offset, spitch, width, height, HI_MemcpyHostToDevice, 1, 0, NULL);
+			acc_wait(1);
+		} else {
+			HI_memcpy3D(dev_ptr(d2, offset), dpitch, hsrc + offset, spitch, width, height, depth, HI_MemcpyHostToDevice);
+		}
+		HI_memcpy(hout1, d1, dsize, HI_MemcpyDeviceToHost, 0);
+		HI_memcpy(hout2, d2, dsize, HI_MemcpyDeviceToHost, 0);
+		errors += compare((mode == 0) ? "H2D 2D" : ((mode == 1) ? "H2D 2D async" : "H2D 3D"), hout1, hout2, dsize);
+	}
+
+	//Device to host (2D, 2D async, and 3D); d1 holds the 3D region.
+	for( int mode=0; mode<3; mode++ ) {
+		size_t tdepth = (mode == 2) ? depth : 1;
+		memset(hout1, 0, dsize);
+		memset(hout2, 0, dsize);
+		copy_rows(hout1 + offset, spitch, dev_ptr(d1, offset), dpitch, width, height, tdepth, HI_MemcpyDeviceToHost);
+		if( mode == 0 ) {
+			HI_memcpy2D(hout2 + offset, spitch, dev_ptr(d1, offset), dpitch, width, height, HI_MemcpyDeviceToHost);
+		} else if( mode == 1 ) {
+			HI_memcpy2D_async(hout2 + offset, spitch, dev_ptr(d1, offset), dpitch, width, height, HI_MemcpyDeviceToHost, 1, 0, NULL);
+			acc_wait(1);
+		} else {
+			HI_memcpy3D(hout2 + offset, spitch, dev_ptr(d1, offset), dpitch, width, height, depth, HI_MemcpyDeviceToHost);
+		}
+		errors += compare((mode == 0) ? "D2H 2D" : ((mode == 1) ? "D2H 2D async" : "D2H 3D"), hout1, hout2, hsize);
+	}
+
+	//Device to device (2D, 2D async, and 3D)
+	for( int mode=0; mode<3; mode++ ) {
+		size_t tdepth = (mode == 2) ? depth : 1;
+		HI_memcpy(d2, hzero, dsize, HI_MemcpyHostToDevice, 0);
+		HI_memcpy(d3, hzero, dsize, HI_MemcpyHostToDevice, 0);
+		copy_rows(dev_ptr(d2, offset), dpitch, dev_ptr(d1, offset), dpitch, width, height, tdepth, HI_MemcpyDeviceToDevice);
+		if( mode == 0 ) {
+			HI_memcpy2D(dev_ptr(d3, offset), dpitch, dev_ptr(d1, offset), dpitch, width, height, HI_MemcpyDeviceToDevice);
+		} else if( mode == 1 ) {
+			HI_memcpy2D_async(dev_ptr(d3, offset), dpitch, dev_ptr(d1, offset), dpitch, width, height, HI_MemcpyDeviceToDevice, 1, 0, NULL);
+			acc_wait(1);
+		} else {
+			HI_memcpy3D(dev_ptr(d3, offset), dpitch, dev_ptr(d1, offset), dpitch, width, height, depth, HI_MemcpyDeviceToDevice);
+		}
+		HI_memcpy(hout1, d2, dsize, HI_MemcpyDeviceToHost, 0);
+		HI_memcpy(hout2, d3, dsize, HI_MemcpyDeviceToHost, 0);
+		errors += compare((mode == 0) ? "D2D 2D" : ((mode == 1) ? "D2D 2D async" : "D2D 3D"), hout1, hout2, dsize);
+	}
+
+	//Halo exchange: the last _HALO_ columns of every row are sent to the
+	//device and received back, row by row and as one rectangular region.
+	size_t haloWidth = _HALO_ * sizeof(float);
+	size_t haloOffset = width + offset - haloWidth;
+	size_t haloHeight = height * depth;
+	double rowTime, rectTime, stime;
+	stime = my_timer();
+	for( int i=0; i<_ITER_; i++ ) {
+		copy_rows(dev_ptr(d1, haloOffset), dpitch, hsrc + haloOffset, spitch, haloWidth, haloHeight, 1, HI_MemcpyHostToDevice);
+		copy_rows(hout1 + haloOffset, spitch, dev_ptr(d1, haloOffset), dpitch, haloWidth, haloHeight, 1, HI_MemcpyDeviceToHost);
+	}
+	rowTime = my_timer() - stime;
+	stime = my_timer();
+	for( int i=0; i<_ITER_; i++ ) {
+		HI_memcpy2D(dev_ptr(d2, haloOffset), dpitch, hsrc + haloOffset, spitch, haloWidth, haloHeight, HI_MemcpyHostToDevice);
+		HI_memcpy2D(hout2 + haloOffset, spitch, dev_ptr(d2, haloOffset), dpitch, haloWidth, haloHeight, HI_MemcpyDeviceToHost);
+	}
+	rectTime = my_timer() - stime;
+	for( size_t j=0; j<haloHeight; j++ ) {
+		errors += compare("Halo", hout1 + j*spitch + haloOffset, hout2 + j*spitch + haloOffset, haloWidth);
+	}
+	printf("Halo region: %lu bytes x %lu rows, %d iterations\n", (unsigned long)haloWidth, (unsigned long)haloHeight, _ITER_);
+	printf("Row-by-row copies: %lf sec (%lf MB/s)\n", rowTime, (2.0*_ITER_*haloWidth*haloHeight)/(rowTime*1.0e6));
+	printf("Rectangular copies: %lf sec (%lf MB/s)\n", rectTime, (2.0*_ITER_*haloWidth*haloHeight)/(rectTime*1.0e6));
+
+	acc_free(d1);
+	acc_free(d2);
+	acc_free(d3);
+	acc_shutdown(acc_device_default);
+	free(hsrc);
+	free(hzero);
+	free(hout1);
+	free(hout2);
+
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+	}
+	return 0;
+}
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt.h"
+
+//Unit test and benchmark of the device memory handle table
+//(DeviceMemHandleMap), which resolves base and interior device pointers to
+//their memory handles through an exact-match index and a hashed index of
+//address blocks per size level.
+//The test checks the size levels, including the clamping to the last level
+//for sizes above 2^60, lookups of entries straddling block boundaries, and
+//random insertions/removals against a brute-force search. The benchmark
+//compares find() with a linear scan of all entries, which is how interior
+//pointers were resolved before the hashed index was added.
+
+#ifndef _MAX_ENTRIES_
+#define _MAX_ENTRIES_ 100000
+#endif
+#ifndef _LOOKUPS_
+#define _LOOKUPS_ 1000000
+#endif
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static void insert(memhandlemap_t *map, unsigned long devPtr, size_t size) {
+	map->insert((const void *)devPtr, new memhandletable_entity_t(MEM_HANDLE_TYPE(), size));
+}
+
+//Return the base address of the entry containing devPtr (0 if none), and
+//check the offset reported by find().
+static unsigned long find_base(memhandlemap_t *map, unsigned long devPtr) {
+	size_t offset = 1;
+	memhandletable_entity_t *aet = map->find((const void *)devPtr, &offset);
+	if( aet == NULL ) {
+		CHECK( offset == 0 );
+		return 0;
+	}
+	CHECK( (unsigned long)aet->devPtr + offset == devPtr );
+	return (unsigned long)aet->devPtr;
+}
+
+static void test_levels() {
+	CHECK( memhandlemap_t::getLevel(0) == MEMHANDLE_INDEX_MIN_LEVEL );
+	CHECK( memhandlemap_t::getLevel(1) == MEMHANDLE_INDEX_MIN_LEVEL );
+	CHECK( memhandlemap_t::getLevel(4096) == 12 );
+	CHECK( memhandlemap_t::getLevel(4097) == 15 );
+	CHECK( memhandlemap_t::getLevel(1UL << 15) == 15 );
+	CHECK( memhandlemap_t::getLevel((1UL << 15) + 1) == 18 );
+	CHECK( memhandlemap_t::getLevel(1UL << 60) == 60 );
+	//Sizes above 2^60 would round up to level 63 or beyond; they are
+	//clamped to the last level.
+	CHECK( memhandlemap_t::getLevel((1UL << 60) + 1) == 63 );
+	CHECK( memhandlemap_t::getLevel(1UL << 61) == 63 );
+	CHECK( memhandlemap_t::getLevel((1UL << 61) + 1) == 63 );
+	CHECK( memhandlemap_t::getLevel(1UL << 63) == 63 );
+	CHECK( memhandlemap_t::getLevel((1UL << 63) + 1) == 63 );
+	CHECK( memhandlemap_t::getLevel(~0UL) == 63 );
+	for( int i=0; i<64; i++ ) {
+		int level = memhandlemap_t::getLevel(1UL << i);
+		CHECK( (level >= MEMHANDLE_INDEX_MIN_LEVEL) && (level < MEMHANDLE_INDEX_NUM_LEVELS) );
+	}
+}
+
+static void test_lookup() {
+	memhandlemap_t map;
+	//Small entry within one block, and entries straddling block boundaries.
+	insert(&map, 0x10000, 100);
+	insert(&map, 0x20000 - 16, 32);
+	insert(&map, 0x100000 - 4096, 3*4096);
+	CHECK( find_base(&map, 0x10000) == 0x10000 );
+	CHECK( find_base(&map, 0x10000 + 99) == 0x10000 );
+	CHECK( find_base(&map, 0x10000 + 100) == 0 );
+	CHECK( find_base(&map, 0x20000 - 16) == 0x20000 - 16 );
+	CHECK( find_base(&map, 0x20000 + 15) == 0x20000 - 16 );
+	CHECK( find_base(&map, 0x20000 + 16) == 0 );
+	CHECK( find_base(&map, 0x100000 - 1) == 0x100000 - 4096 );
+	CHECK( find_base(&map, 0x100000 + 2*4096 - 1) == 0x100000 - 4096 );
+	CHECK( find_base(&map, 0x100000 + 2*4096) == 0 );
+	CHECK( find_base(&map, 0xffff) == 0 );
+
+	//A zero-sized entry resolves only its base address.
+	insert(&map, 0x30000, 0);
+	CHECK( find_base(&map, 0x30000) == 0x30000 );
+	CHECK( find_base(&map, 0x30001) == 0 );
+
+	//An entry of the last level (larger than 2^61 bytes).
+	unsigned long hugeBase = 1UL << 62;
+	size_t hugeSize = (1UL << 61) + 4096;
+	insert(&map, hugeBase, hugeSize);
+	CHECK( map.levelMask & (1UL << 63) );
+	CHECK( find_base(&map, hugeBase + (1UL << 60)) == hugeBase );
+	CHECK( find_base(&map, hugeBase + hugeSize - 1) == hugeBase );
+	CHECK( find_base(&map, hugeBase + hugeSize) == 0 );
+	CHECK( find_base(&map, 0x10000 + 50) == 0x10000 );
+	CHECK( map.erase((const void *)hugeBase) );
+	CHECK( !(map.levelMask & (1UL << 63)) );
+	CHECK( find_base(&map, hugeBase + 1) == 0 );
+
+	//Replacing an entry with the same base address updates its size.
+	insert(&map, 0x10000, 8192);
+	CHECK( map.size() == 4 );
+	CHECK( find_base(&map, 0x10000 + 8000) == 0x10000 );
+
+	//Entries are iterated in address order.
+	unsigned long prev = 0;
+	for( memhandlemap_t::iterator it = map.begin(); it != map.end(); ++it ) {
+		CHECK( (unsigned long)it->first > prev );
+		prev = (unsigned long)it->first;
+	}
+
+	CHECK( map.erase((const void *)0x10000) );
+	CHECK( !map.erase((const void *)0x10000) );
+	CHECK( find_base(&map, 0x10000) == 0 );
+	map.clear();
+	CHECK( map.empty() );
+	CHECK( map.levelMask == 0 );
+	CHECK( map.blockIndex.empty() );
+}
+
+//Non-overlapping ranges of random sizes in slots of 64 MB.
+#define SLOT_SIZE (64UL << 20)
+#define SLOT_BASE (1UL << 40)
+
+static size_t random_size() {
+	int shift = rand() % 25;
+	return ((size_t)rand() % (1UL << shift)) + 1;
+}
+
+static unsigned long brute_force_find(const std::vector<size_t> &sizes, unsigned long addr) {
+	if( addr < SLOT_BASE ) {
+		return 0;
+	}
+	size_t slot = (addr - SLOT_BASE) / SLOT_SIZE;
+	if( (slot >= sizes.size()) || (sizes[slot] == 0) ) {
+		return 0;
+	}
+	unsigned long base = SLOT_BASE + slot*SLOT_SIZE + (slot % 7)*4096;
+	return ((addr >= base) && (addr < base + sizes[slot])) ? base : 0;
+}
+
+static void test_random() {
+	memhandlemap_t map;
+	size_t numSlots = 4096;
+	std::vector<size_t> sizes(numSlots, 0);
+	srand(1234);
+	for( int round=0; round<20000; round++ ) {
+		size_t slot = rand() % numSlots;
+		unsigned long base = SLOT_BASE + slot*SLOT_SIZE + (slot % 7)*4096;
+		if( sizes[slot] == 0 ) {
+			sizes[slot] = random_size();
+			insert(&map, base, sizes[slot]);
+		} else {
+			CHECK( map.erase((const void *)base) );
+			sizes[slot] = 0;
+		}
+		for( int q=0; q<4; q++ ) {
+			size_t qSlot = rand() % numSlots;
+			unsigned long addr = SLOT_BASE + qSlot*SLOT_SIZE + (rand() % (SLOT_SIZE/2));
+			CHECK( find_base(&map, addr) == brute_force_find(sizes, addr) );
+		}
+	}
+}
+
+static unsigned long linear_find(memhandlemap_t *map, unsigned long addr) {
+	for( memhandlemap_t::iterator it = map->begin(); it != map->end(); ++it ) {
+		unsigned long base = (unsigned long)it->first;
+		if( (addr >= base) && (addr < base + it->second->size) ) {
+			return base;
+		}
+	}
+	return 0;
+}
+
+static void benchmark(size_t numEntries) {
+	memhandlemap_t map;
+	std::vector<size_t> sizes(numEntries);
+	srand(numEntries);
+	for( size_t i=0; i<numEntries; i++ ) {
+		sizes[i] = random_size();
+		insert(&map, SLOT_BASE + i*SLOT_SIZE + (i % 7)*4096, sizes[i]);
+	}
+	//Random interior pointers of the entries.
+	std::vector<unsigned long> queries(1024);
+	for( size_t q=0; q<queries.size(); q++ ) {
+		size_t i = rand() % numEntries;
+		queries[q] = SLOT_BASE + i*SLOT_SIZE + (i % 7)*4096 + (rand() % sizes[i]);
+	}
+	size_t numFound = 0;
+	double stime = my_timer();
+	for( size_t l=0; l<_LOOKUPS_; l++ ) {
+		size_t offset;
+		if( map.find((const void *)queries[l % queries.size()], &offset) != NULL ) {
+			numFound++;
+		}
+	}
+	double indexTime = my_timer() - stime;
+	CHECK( numFound == _LOOKUPS_ );
+
+	//The linear scan is timed with fewer lookups to bound the run time.
+	size_t numLinearLookups = _LOOKUPS_ / numEntries;
+	if( numLinearLookups < queries.size() ) {
+		numLinearLookups = queries.size();
+	}
+	numFound = 0;
+	stime = my_timer();
+	for( size_t l=0; l<numLinearLookups; l++ ) {
+		if( linear_find(&map, queries[l % queries.size()]) != 0 ) {
+			numFound++;
+		}
+	}
+	double linearTime = my_timer() - stime;
+	CHECK( numFound == numLinearLookups );
+	printf("%10lu entries: hashed index %10.1lf ns/lookup, linear scan %12.1lf ns/lookup\n", (unsigned long)numEntries,
+		indexTime*1.0e9/_LOOKUPS_, linearTime*1.0e9/numLinearLookups);
+}
+
+int main(int argc, char** argv) {
+	test_levels();
+	test_lookup();
+	test_random();
+	for( size_t n=10; n<=_MAX_ENTRIES_; n*=10 ) {
+		benchmark(n);
+	}
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
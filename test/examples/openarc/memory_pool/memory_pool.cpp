@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include "openacc.h"
+#include "openaccrt.h"
+
+//Unit test of the device memory pool (devicememorypool_t) with a mock
+//device allocator, which hands out fake device addresses and tracks the
+//chunks allocated from the "device". The pool is driven the same way as the
+//runtime drivers do: a request is served from the pool if possible;
+//otherwise, a chunk of getAllocSize() bytes is allocated from the device
+//and registered with addChunk(); entirely free chunks are returned to the
+//device through popFreeChunk().
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+//Mock device allocator; chunks are placed 1 MB apart from each other so
+//that chunks are never adjacent.
+class MockAllocator
+{
+public:
+	std::map<char *, size_t> chunks;
+	char *next;
+	long allocCnt;
+	long freeCnt;
+
+	MockAllocator() : next((char *)0x100000000UL), allocCnt(0), freeCnt(0) {}
+
+	void *allocate(size_t size) {
+		char *ptr = next;
+		next += ((size >> 20) + 2) << 20;
+		chunks[ptr] = size;
+		allocCnt++;
+		return (void *)ptr;
+	}
+
+	void free(void *ptr, size_t size) {
+		std::map<char *, size_t>::iterator it = chunks.find((char *)ptr);
+		CHECK( it != chunks.end() );
+		if( it != chunks.end() ) {
+			CHECK( it->second == size );
+			chunks.erase(it);
+		}
+		freeCnt++;
+	}
+};
+
+static void *pool_malloc(memPool_t *pool, MockAllocator *device, size_t count) {
+	void *devPtr = NULL;
+	if( !pool->allocate(count, &devPtr, NULL) ) {
+		size_t size = pool->getAllocSize(count);
+		devPtr = device->allocate(size);
+		pool->addChunk(devPtr, size, count);
+	}
+	return devPtr;
+}
+
+static void pool_free(memPool_t *pool, void *devPtr) {
+	pool->release(devPtr, 0);
+}
+
+//Return all entirely free chunks to the device.
+static void pool_evict_all(memPool_t *pool, MockAllocator *device) {
+	void *devPtr;
+	size_t size;
+	while( pool->popFreeChunk(&devPtr, &size) ) {
+		device->free(devPtr, size);
+	}
+}
+
+static void test_size_classes() {
+	memPool_t pool(MEMPOOL_DEFAULT_FRAG_LIMIT, 256, true);
+	CHECK( pool.getAllocSize(1) == MEMPOOL_MIN_BLOCK_SIZE );
+	CHECK( pool.getAllocSize(MEMPOOL_MIN_BLOCK_SIZE) == MEMPOOL_MIN_BLOCK_SIZE );
+	//Between 64 KB and 128 KB, classes are 16 KB apart.
+	CHECK( pool.getAllocSize(65537) == 65536 + 16384 );
+	//Above MEMPOOL_SMALL_BLOCK_SIZE, classes are MEMPOOL_MIN_BLOCK_SIZE apart.
+	CHECK( pool.getAllocSize(MEMPOOL_SMALL_BLOCK_SIZE + 1) == MEMPOOL_SMALL_BLOCK_SIZE + MEMPOOL_MIN_BLOCK_SIZE );
+	memPool_t exactPool(MEMPOOL_DEFAULT_FRAG_LIMIT, 0, false);
+	CHECK( exactPool.getAllocSize(1000) == 1000 );
+}
+
+static void test_split_and_coalesce() {
+	MockAllocator device;
+	memPool_t pool(MEMPOOL_DEFAULT_FRAG_LIMIT, 256, true);
+	size_t chunkSize = 4 << 20;
+	char *chunk = (char *)pool_malloc(&pool, &device, chunkSize);
+	CHECK( device.allocCnt == 1 );
+	pool_free(&pool, chunk);
+	CHECK( pool.getFreeBytes() == chunkSize );
+
+	//Three requests are split from the free chunk, in address order.
+	char *a = (char *)pool_malloc(&pool, &device, 1 << 20);
+	char *b = (char *)pool_malloc(&pool, &device, 1 << 20);
+	char *c = (char *)pool_malloc(&pool, &device, 1 << 20);
+	CHECK( device.allocCnt == 1 );
+	CHECK( a == chunk );
+	CHECK( b == chunk + (1 << 20) );
+	CHECK( c == chunk + (2 << 20) );
+	CHECK( pool.getFreeBytes() == (size_t)(1 << 20) );
+	CHECK( pool.size() == 1 );
+
+	//The chunk cannot be returned to the device while parts are in use.
+	void *devPtr;
+	size_t size;
+	CHECK( !pool.popFreeChunk(&devPtr, &size) );
+	pool_free(&pool, b);
+	CHECK( pool.size() == 2 );
+	CHECK( pool.getExternalFragBytes() == (size_t)(2 << 20) );
+
+	//Releasing a coalesces it with b; releasing c coalesces all blocks.
+	pool_free(&pool, a);
+	CHECK( pool.size() == 2 );
+	pool_free(&pool, c);
+	CHECK( pool.size() == 1 );
+	CHECK( pool.getFreeBytes() == chunkSize );
+	CHECK( pool.getExternalFragBytes() == 0 );
+	CHECK( pool.popFreeChunk(&devPtr, &size) );
+	CHECK( devPtr == (void *)chunk );
+	CHECK( size == chunkSize );
+	CHECK( pool.getReservedBytes() == 0 );
+}
+
+static void test_best_fit() {
+	MockAllocator device;
+	memPool_t pool(MEMPOOL_DEFAULT_FRAG_LIMIT, 256, true);
+	char *large = (char *)pool_malloc(&pool, &device, 8 << 20);
+	char *medium = (char *)pool_malloc(&pool, &device, 2 << 20);
+	char *small = (char *)pool_malloc(&pool, &device, 1 << 20);
+	pool_free(&pool, large);
+	pool_free(&pool, medium);
+	pool_free(&pool, small);
+	CHECK( device.allocCnt == 3 );
+
+	//The smallest free block that fits is used as a whole, if the unused
+	//part is within the fragmentation limit.
+	char *p = (char *)pool_malloc(&pool, &device, (2 << 20) - (1 << 18));
+	CHECK( p == medium );
+	CHECK( pool.getInternalFragBytes() == (size_t)(1 << 18) );
+	char *q = (char *)pool_malloc(&pool, &device, 1 << 20);
+	CHECK( q == small );
+	CHECK( device.allocCnt == 3 );
+
+	//A request much smaller than the remaining free block is split from it.
+	char *r = (char *)pool_malloc(&pool, &device, 1 << 20);
+	CHECK( r == large );
+	CHECK( device.allocCnt == 3 );
+	pool_free(&pool, p);
+	pool_free(&pool, q);
+	pool_free(&pool, r);
+	pool_evict_all(&pool, &device);
+	CHECK( device.chunks.empty() );
+}
+
+static void test_no_split() {
+	//Drivers that cannot address the interior of a chunk do not split; a
+	//free block beyond the fragmentation limit is not used.
+	MockAllocator device;
+	memPool_t pool(MEMPOOL_DEFAULT_FRAG_LIMIT, 0, false);
+	char *big = (char *)pool_malloc(&pool, &device, 1 << 20);
+	pool_free(&pool, big);
+	char *p = (char *)pool_malloc(&pool, &device, 1 << 18);
+	CHECK( p != big );
+	CHECK( device.allocCnt == 2 );
+	char *q = (char *)pool_malloc(&pool, &device, (1 << 20) - 1000);
+	CHECK( q == big );
+	CHECK( device.allocCnt == 2 );
+	pool_free(&pool, p);
+	pool_free(&pool, q);
+	pool_evict_all(&pool, &device);
+	CHECK( device.chunks.empty() );
+}
+
+static void test_lru_eviction() {
+	MockAllocator device;
+	memPool_t pool(MEMPOOL_DEFAULT_FRAG_LIMIT, 256, true);
+	char *a = (char *)pool_malloc(&pool, &device, 1 << 20);
+	char *b = (char *)pool_malloc(&pool, &device, 1 << 20);
+	char *c = (char *)pool_malloc(&pool, &device, 1 << 20);
+	pool_free(&pool, b);
+	pool_free(&pool, a);
+	pool_free(&pool, c);
+
+	//Reusing a chunk removes it from the LRU list; freeing it again makes
+	//it the most recently freed one.
+	char *p = (char *)pool_malloc(&pool, &device, 1 << 20);
+	CHECK( (p == a) || (p == b) || (p == c) );
+	pool_free(&pool, p);
+
+	std::vector<char *> order;
+	order.push_back(b);
+	order.push_back(a);
+	order.push_back(c);
+	for( size_t i=0; i<order.size(); i++ ) {
+		if( order[i] == p ) {
+			order.erase(order.begin() + i);
+			order.push_back(p);
+			break;
+		}
+	}
+	void *devPtr;
+	size_t size;
+	for( size_t i=0; i<order.size(); i++ ) {
+		CHECK( pool.popFreeChunk(&devPtr, &size) );
+		CHECK( devPtr == (void *)order[i] );
+		device.free(devPtr, size);
+	}
+	CHECK( !pool.popFreeChunk(&devPtr, &size) );
+	CHECK( device.chunks.empty() );
+	CHECK( pool.getReservedBytes() == 0 );
+	CHECK( pool.getFreeBytes() == 0 );
+}
+
+int main(int argc, char** argv) {
+	test_size_classes();
+	test_split_and_coalesce();
+	test_best_fit();
+	test_no_split();
+	test_lru_eviction();
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt_ext.h"
+
+//Runtime test and benchmark of postponed frees, i.e., device memory freed
+//by HI_free_async() after the commands enqueued on its async queue. The
+//buffers are mapped, copied, and freed on the async queue with the runtime
+//calls that OpenARC generates for an async data region.
+//The test checks that the postponed frees of a queue are reclaimed by
+//acc_wait() and acc_wait_all(), and, on backends that reclaim them from a
+//completion callback (the OpenCL driver), by HI_reclaim_completed_frees()
+//once the queue commands have completed, without a synchronization call.
+//A host buffer stays mapped until its postponed free is reclaimed, so a
+//buffer is mapped again only after that.
+//The benchmark repeatedly maps and unmaps a set of buffers on an async
+//queue, and waits on the queue only when the next buffer is still mapped.
+//It reports the time per map/copy/free sequence, the number of such waits,
+//and the largest number of postponed frees that were waiting to be
+//reclaimed.
+
+#ifndef _NUM_BUFS_
+#define _NUM_BUFS_ 16
+#endif
+#ifndef _BUF_SIZE_KB_
+#define _BUF_SIZE_KB_ 1024
+#endif
+#ifndef _ITER_
+#define _ITER_ 2000
+#endif
+//Seconds to wait for the completion callbacks.
+#ifndef _TIMEOUT_
+#define _TIMEOUT_ 10
+#endif
+
+#define BUF_SIZE ((size_t)_BUF_SIZE_KB_ << 10)
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+//Number of postponed frees of the async queue that are not reclaimed yet.
+static unsigned long pending_frees(int async) {
+	HostConf_t *tconf = getHostConf();
+	Accelerator_t *device = tconf->device;
+	int asyncID = async + tconf->asyncID_offset;
+	postponedfreecount_t *freeCount = &(device->postponedFreeInfoMap[tconf->threadID]->countMap[asyncID]);
+	unsigned long pending = freeCount->freeInserted - freeCount->freeRetired;
+	CHECK( device->postponedFreeTableMap[tconf->threadID]->count(asyncID) == pending );
+	return pending;
+}
+
+//Map the buffer on the async queue, copy it in, and free it after the copy.
+static void map_copy_free(char *hostPtr, int async) {
+	void *devPtr;
+	HI_malloc1D(hostPtr, &devPtr, BUF_SIZE, async, HI_MEM_READ_WRITE);
+	HI_set_async(async);
+	HI_memcpy_async(devPtr, hostPtr, BUF_SIZE, HI_MemcpyHostToDevice, 0, async, 0, NULL);
+	HI_free_async(hostPtr, async);
+}
+
+static bool is_mapped(char *hostPtr, int async) {
+	void *devPtr;
+	return HI_get_device_address(hostPtr, &devPtr, async) == HI_success;
+}
+
+//Map, copy, and free every stride-th buffer, starting from the first one.
+static void map_and_free(std::vector<char *> &bufs, int async, size_t first, size_t stride) {
+	for( size_t i=first; i<bufs.size(); i+=stride ) {
+		map_copy_free(bufs[i], async);
+	}
+}
+
+static void test_wait(std::vector<char *> &bufs) {
+	map_and_free(bufs, 1, 0, 1);
+	acc_wait(1);
+	CHECK( pending_frees(1) == 0 );
+	for( size_t i=0; i<bufs.size(); i++ ) {
+		CHECK( !is_mapped(bufs[i], 1) );
+	}
+}
+
+static void test_wait_all(std::vector<char *> &bufs) {
+	for( int async=1; async<=4; async++ ) {
+		map_and_free(bufs, async, async-1, 4);
+	}
+	acc_wait_all();
+	for( int async=1; async<=4; async++ ) {
+		CHECK( pending_frees(async) == 0 );
+	}
+	for( size_t i=0; i<bufs.size(); i++ ) {
+		CHECK( !is_mapped(bufs[i], (i % 4) + 1) );
+	}
+}
+
+//Only the OpenCL driver reclaims postponed frees from a completion callback.
+static void test_completion_reclaim(std::vector<char *> &bufs) {
+#if (OPENARC_ARCH != 0) && (OPENARC_ARCH != 5) && (OPENARC_ARCH != 6)
+	HostConf_t *tconf = getHostConf();
+	map_and_free(bufs, 2, 0, 1);
+	CHECK( pending_frees(2) > 0 );
+	double stime = my_timer();
+	while( (pending_frees(2) > 0) && (my_timer() - stime < _TIMEOUT_) ) {
+		usleep(1000);
+		tconf->device->HI_reclaim_completed_frees(tconf->threadID);
+	}
+	CHECK( pending_frees(2) == 0 );
+	for( size_t i=0; i<bufs.size(); i++ ) {
+		CHECK( !is_mapped(bufs[i], 2) );
+	}
+	acc_wait(2);
+#endif
+}
+
+static void benchmark(std::vector<char *> &bufs) {
+	unsigned long maxPending = 0;
+	int numWaits = 0;
+	double stime = my_timer();
+	for( int l=0; l<_ITER_; l++ ) {
+		int i = l % _NUM_BUFS_;
+		if( is_mapped(bufs[i], 3) ) {
+			acc_wait(3);
+			numWaits++;
+		}
+		map_copy_free(bufs[i], 3);
+		unsigned long pending = pending_frees(3);
+		if( maxPending < pending ) {
+			maxPending = pending;
+		}
+	}
+	double issueTime = my_timer() - stime;
+	acc_wait(3);
+	double etime = my_timer() - stime;
+	CHECK( pending_frees(3) == 0 );
+	printf("%d map/copy/free sequences of %d KB: %10.2lf us per sequence (%10.2lf us including acc_wait)\n",
+		_ITER_, _BUF_SIZE_KB_, issueTime*1.0e6/_ITER_, etime*1.0e6/_ITER_);
+	printf("%d acc_wait calls for buffers still mapped, at most %lu postponed frees waiting to be reclaimed\n", numWaits, maxPending);
+}
+
+int main(int argc, char** argv) {
+	std::vector<char *> bufs(_NUM_BUFS_);
+	for( int i=0; i<_NUM_BUFS_; i++ ) {
+		bufs[i] = (char *)malloc(BUF_SIZE);
+		memset(bufs[i], i, BUF_SIZE);
+	}
+	acc_init(acc_device_default);
+	test_wait(bufs);
+	test_wait_all(bufs);
+	test_completion_reclaim(bufs);
+	benchmark(bufs);
+	acc_shutdown(acc_device_default);
+	for( int i=0; i<_NUM_BUFS_; i++ ) {
+		free(bufs[i]);
+	}
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#ifdef _OPENARC_
+#include <openacc.h>
+#endif
+
+#ifndef _N_
+#define _N_ 4096
+#endif
+
+#ifndef NUM_THREADS
+#define NUM_THREADS 4
+#endif
+
+#ifndef NUM_ROUNDS
+#define NUM_ROUNDS 50
+#endif
+
+//Stress test for the pthread-based OpenARC runtime (OMP=0).
+//In each round, NUM_THREADS pthreads are created, run copyin/kernel/copyout
+//data regions concurrently, and are joined; since threads of a later round
+//reuse the runtime thread IDs of the finished ones, each thread also leaves
+//its leftover array mapped at exit and checks that no leftover array mapped
+//by a finished thread is present in its own present table.
+float leftover[NUM_THREADS][_N_];
+
+typedef struct {
+	int tid;
+	int round;
+	int errors;
+} task_t;
+
+void *worker(void *arg) {
+	task_t *task = (task_t *)arg;
+	int N = _N_;
+	float *A, *B, *C;
+	float scale = (float)(task->tid + task->round + 1);
+	int i, k;
+
+#ifdef _OPENARC_
+	for(k=0; k<NUM_THREADS; k++) {
+		if( acc_is_present(leftover[k], N*sizeof(float)) ) {
+			task->errors++;
+		}
+	}
+#endif
+
+	A = (float *)malloc(N*sizeof(float));
+	B = (float *)malloc(N*sizeof(float));
+	C = (float *)malloc(N*sizeof(float));
+	for(i=0; i<N; i++) {
+		A[i] = (float)i;
+		B[i] = (float)(N-i);
+		C[i] = 0.0F;
+	}
+
+	for(k=0; k<4; k++) {
+		#pragma acc data copyin(A[0:N], B[0:N]) copyout(C[0:N])
+		{
+			#pragma acc kernels loop gang worker
+			for(i=0; i<N; i++) {
+				C[i] = scale*A[i] + B[i];
+			}
+		}
+		for(i=0; i<N; i++) {
+			if( C[i] != scale*((float)i) + (float)(N-i) ) {
+				task->errors++;
+			}
+		}
+	}
+
+	for(i=0; i<N; i++) {
+		leftover[task->tid][i] = scale;
+	}
+	#pragma acc enter data copyin(leftover[task->tid][0:N])
+
+	free(A);
+	free(B);
+	free(C);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	pthread_t threads[NUM_THREADS];
+	task_t tasks[NUM_THREADS];
+	int r, t;
+	int errors = 0;
+
+#ifdef _OPENARC_
+	acc_init(acc_device_default);
+#endif
+	for(r=0; r<NUM_ROUNDS; r++) {
+		for(t=0; t<NUM_THREADS; t++) {
+			tasks[t].tid = t;
+			tasks[t].round = r;
+			tasks[t].errors = 0;
+			if( pthread_create(&threads[t], NULL, worker, &tasks[t]) != 0 ) {
+				printf("Failed to create thread %d in round %d\n", t, r);
+				return 1;
+			}
+		}
+		for(t=0; t<NUM_THREADS; t++) {
+			pthread_join(threads[t], NULL);
+			errors += tasks[t].errors;
+		}
+	}
+#ifdef _OPENARC_
+	acc_shutdown(acc_device_default);
+#endif
+
+	printf("threads:%d, rounds:%d, size:%d, error:%d\n", NUM_THREADS, NUM_ROUNDS, _N_, errors);
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+	} else {
+		printf("Verification Failed\n");
+	}
+	return 0;
+}
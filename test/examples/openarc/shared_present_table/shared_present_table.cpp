@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+//The shared present table is enabled only if this is defined before
+//openaccrt.h is included.
+#define _USE_SHARED_PRESENT_TABLE 1
+#include "openacc.h"
+#include "openaccrt.h"
+
+//Stress test and scaling benchmark of the shared present table
+//(sharedpresenttable_t), which all host threads of a device use when the
+//runtime is built with _USE_SHARED_PRESENT_TABLE.
+//Each thread repeatedly maps, looks up (by host and by device pointer),
+//updates the present counter of, and unmaps its own ranges, while also
+//looking up a set of ranges shared by all threads. Every mapping follows a
+//fixed rule (device address = host address + DEVICE_OFFSET, and the size is
+//a function of the host address), so that any torn or stale lookup result
+//is detected. Some ranges are larger than a shard region, so that they are
+//mapped in several shards.
+//The benchmark reports the throughput for 1, 2, 4, ... _MAX_THREADS_ threads.
+
+#ifndef _MAX_THREADS_
+#define _MAX_THREADS_ 8
+#endif
+#ifndef _ITER_
+#define _ITER_ 200000
+#endif
+//Number of live mappings of each thread.
+#ifndef _WINDOW_
+#define _WINDOW_ 64
+#endif
+//Number of mappings shared by all threads.
+#ifndef _NUM_SHARED_
+#define _NUM_SHARED_ 1024
+#endif
+
+#define RANGE_STRIDE (4UL << 20)
+#define THREAD_SPACE (1UL << 40)
+#define DEVICE_OFFSET (1UL << 46)
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		__atomic_fetch_add(&errors, 1, __ATOMIC_RELAXED); \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static sharedpresenttable_t *table;
+
+//Host address of the i-th range of owner (owner 0 holds the shared ranges).
+static const void *host_addr(int owner, size_t i) {
+	return (const void *)((owner + 1)*THREAD_SPACE + i*RANGE_STRIDE);
+}
+
+static size_t range_size(const void *hostPtr) {
+	size_t i = ((size_t)hostPtr % THREAD_SPACE) / RANGE_STRIDE;
+	return (i % 4 == 0) ? (3UL << 20) : 4096*(1 + i%7);
+}
+
+static void *dev_addr(const void *hostPtr) {
+	return (void *)((size_t)hostPtr + DEVICE_OFFSET);
+}
+
+static void map(const void *hostPtr) {
+	table->insert(hostPtr, dev_addr(hostPtr), range_size(hostPtr), DEFAULT_QUEUE);
+}
+
+//Look up an interior pointer of a mapped range by host and device pointer,
+//and check the result against the mapping rule.
+static bool check_mapped(const void *hostPtr, size_t offset) {
+	addresstable_entity_t aet(NULL, 0);
+	size_t tOffset = 0;
+	bool found = table->find((const char *)hostPtr + offset, DEFAULT_QUEUE, &aet, &tOffset);
+	if( found ) {
+		CHECK( aet.hostPtr == hostPtr );
+		CHECK( aet.basePtr == dev_addr(hostPtr) );
+		CHECK( aet.size == range_size(hostPtr) );
+		CHECK( tOffset == offset );
+	}
+	bool devFound = table->findDevice((const char *)dev_addr(hostPtr) + offset, DEFAULT_QUEUE, &aet, &tOffset);
+	if( devFound ) {
+		CHECK( aet.hostPtr == hostPtr );
+		CHECK( aet.size == range_size(hostPtr) );
+		CHECK( tOffset == offset );
+	}
+	return found && devFound;
+}
+
+typedef struct {
+	int tid;
+	long numOps;
+} thread_arg_t;
+
+static void *worker(void *arg) {
+	thread_arg_t *targ = (thread_arg_t *)arg;
+	int owner = targ->tid + 1;
+	unsigned int seed = targ->tid;
+	long numOps = 0;
+	for( size_t i=0; i<_ITER_; i++ ) {
+		//Map a new range, and unmap the oldest one of the window.
+		const void *hostPtr = host_addr(owner, i);
+		map(hostPtr);
+		numOps++;
+		if( i >= _WINDOW_ ) {
+			CHECK( table->erase(host_addr(owner, i - _WINDOW_), DEFAULT_QUEUE) );
+			CHECK( !table->findExact(host_addr(owner, i - _WINDOW_), DEFAULT_QUEUE) );
+			numOps += 2;
+		}
+		//Remapping with the same values replaces the mapping in place.
+		if( i % 16 == 0 ) {
+			map(hostPtr);
+			numOps++;
+		}
+		size_t offset = rand_r(&seed) % range_size(hostPtr);
+		CHECK( check_mapped(hostPtr, offset) );
+		int cnt;
+		CHECK( table->updatePresentCnt(hostPtr, DEFAULT_QUEUE, true, &cnt, NULL, NULL) );
+		CHECK( cnt == 1 );
+		CHECK( table->updatePresentCnt(hostPtr, DEFAULT_QUEUE, false, &cnt, NULL, NULL) );
+		CHECK( cnt == 1 );
+		numOps += 4;
+		//Read-mostly lookups of the shared ranges.
+		for( int r=0; r<4; r++ ) {
+			const void *sharedPtr = host_addr(0, rand_r(&seed) % _NUM_SHARED_);
+			CHECK( check_mapped(sharedPtr, rand_r(&seed) % range_size(sharedPtr)) );
+			numOps += 2;
+		}
+	}
+	for( size_t i=(_ITER_ > _WINDOW_) ? _ITER_ - _WINDOW_ : 0; i<_ITER_; i++ ) {
+		CHECK( table->erase(host_addr(owner, i), DEFAULT_QUEUE) );
+	}
+	targ->numOps = numOps;
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	table = new sharedpresenttable_t();
+	for( size_t i=0; i<_NUM_SHARED_; i++ ) {
+		map(host_addr(0, i));
+	}
+	double baseRate = 0.0;
+	for( int numThreads=1; numThreads<=_MAX_THREADS_; numThreads*=2 ) {
+		std::vector<pthread_t> threads(numThreads);
+		std::vector<thread_arg_t> args(numThreads);
+		double stime = my_timer();
+		for( int t=0; t<numThreads; t++ ) {
+			args[t].tid = t;
+			args[t].numOps = 0;
+			pthread_create(&threads[t], NULL, worker, &args[t]);
+		}
+		long numOps = 0;
+		for( int t=0; t<numThreads; t++ ) {
+			pthread_join(threads[t], NULL);
+			numOps += args[t].numOps;
+		}
+		double etime = my_timer() - stime;
+		double rate = numOps/(etime*1.0e6);
+		if( numThreads == 1 ) {
+			baseRate = rate;
+		}
+		printf("%3d threads: %lf sec, %8.2lf Mops/s (%.2lfx of 1 thread)\n", numThreads, etime, rate, rate/baseRate);
+		//Only the shared ranges remain mapped.
+		CHECK( table->size() == _NUM_SHARED_ );
+	}
+	for( size_t i=0; i<_NUM_SHARED_; i++ ) {
+		CHECK( table->erase(host_addr(0, i), DEFAULT_QUEUE) );
+	}
+	CHECK( table->size() == 0 );
+	table->clear();
+	delete table;
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <sys/time.h>
+#include "openacc.h"
+#include "openaccrt_ext.h"
+
+//Unit test of the victim cache shard (VictimCacheShard) and runtime churn
+//benchmark of acc_create()/acc_delete(), whose device memory is served by
+//the victim cache when the runtime is built with VICTIM_CACHE_MODE = 2.
+//The unit test checks hits on the same host pointer and on the default
+//queue, size-compatible reuse within the fragmentation limit, LRU eviction,
+//and that a buffer larger than its mapping is cached again with its
+//allocation size.
+//The benchmark repeatedly maps and unmaps a set of recurring host buffers
+//(served by entries of the same host pointer), and freshly allocated host
+//buffers (served by entries of other host pointers if the host memory is
+//not prepinned). It reports the time per acc_create()/acc_delete() pair,
+//checks that the cache stays within max_mempool_size, and checks the data
+//of reused device buffers with acc_copyin()/acc_copyout().
+
+#ifndef _NUM_BUFS_
+#define _NUM_BUFS_ 64
+#endif
+#ifndef _MAX_SIZE_KB_
+#define _MAX_SIZE_KB_ 4096
+#endif
+#ifndef _ITER_
+#define _ITER_ 20000
+#endif
+
+static int errors = 0;
+
+#define CHECK(cond) do { \
+	if( !(cond) ) { \
+		printf("[FAILED] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		errors++; \
+	} \
+} while(0)
+
+static double my_timer() {
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+static const void *fake_ptr(unsigned long addr) {
+	return (const void *)addr;
+}
+
+static void test_shard() {
+	victimcacheshard_t shard;
+	void *devPtr = NULL;
+	size_t allocSize = 0;
+	int defaultQueue = DEFAULT_QUEUE;
+
+	//A hit on the same host pointer can return a larger buffer.
+	shard.put(fake_ptr(0x1000), (void *)fake_ptr(0x90000), 1000, 1);
+	CHECK( shard.getCachedBytes() == 1000 );
+	CHECK( !shard.take(fake_ptr(0x1000), 1001, 1, defaultQueue, false, 0, &devPtr, &allocSize) );
+	CHECK( !shard.take(fake_ptr(0x1000), 800, 2, defaultQueue, false, 0, &devPtr, &allocSize) );
+	CHECK( shard.take(fake_ptr(0x1000), 800, 1, defaultQueue, false, 0, &devPtr, &allocSize) );
+	CHECK( devPtr == fake_ptr(0x90000) );
+	CHECK( allocSize == 1000 );
+	CHECK( shard.getCachedBytes() == 0 );
+
+	//An entry cached on the default queue serves any queue.
+	shard.put(fake_ptr(0x2000), (void *)fake_ptr(0xa0000), 500, defaultQueue);
+	CHECK( shard.take(fake_ptr(0x2000), 500, 3, defaultQueue, false, 0, &devPtr, &allocSize) );
+	CHECK( (devPtr == fake_ptr(0xa0000)) && (allocSize == 500) );
+
+	//Size-compatible reuse is limited to fragLimit percent of the request.
+	shard.put(fake_ptr(0x3000), (void *)fake_ptr(0xb0000), 1100, 1);
+	CHECK( !shard.take(fake_ptr(0x4000), 1000, 1, defaultQueue, false, 20, &devPtr, &allocSize) );
+	CHECK( !shard.take(fake_ptr(0x4000), 500, 1, defaultQueue, true, 20, &devPtr, &allocSize) );
+	CHECK( shard.take(fake_ptr(0x4000), 1000, 1, defaultQueue, true, 20, &devPtr, &allocSize) );
+	CHECK( (devPtr == fake_ptr(0xb0000)) && (allocSize == 1100) );
+	CHECK( shard.getCachedBytes() == 0 );
+
+	//The buffer is mapped with 1000 bytes; it is cached again with its
+	//allocation size, as the drivers do in HI_malloc1D() and HI_free().
+	shard.setAllocSize(devPtr, allocSize);
+	CHECK( shard.removeAllocSize(fake_ptr(0xc0000), 64) == 64 );
+	size_t size = shard.removeAllocSize(devPtr, 1000);
+	CHECK( size == 1100 );
+	CHECK( shard.removeAllocSize(devPtr, 1000) == 1000 );
+	shard.put(fake_ptr(0x4000), devPtr, size, 1);
+	CHECK( shard.getCachedBytes() == 1100 );
+
+	//Entries are evicted in the order they were cached.
+	shard.put(fake_ptr(0x5000), (void *)fake_ptr(0xd0000), 300, 1);
+	shard.put(fake_ptr(0x6000), (void *)fake_ptr(0xe0000), 200, 1);
+	CHECK( shard.getCachedBytes() == 1600 );
+	victimcache_entry_t entry;
+	CHECK( shard.popLRUEntry(&entry) );
+	CHECK( (entry.hostPtr == fake_ptr(0x4000)) && (entry.size == 1100) );
+	CHECK( shard.popLRUEntry(&entry) );
+	CHECK( (entry.hostPtr == fake_ptr(0x5000)) && (entry.size == 300) );
+	CHECK( shard.getCachedBytes() == 200 );
+	shard.setAllocSize(fake_ptr(0xf0000), 4096);
+	shard.clear();
+	CHECK( shard.getCachedBytes() == 0 );
+	CHECK( shard.removeAllocSize(fake_ptr(0xf0000), 10) == 10 );
+	CHECK( !shard.popLRUEntry(&entry) );
+}
+
+static size_t buffer_size(int i) {
+	//Sizes from 4 KB to _MAX_SIZE_KB_ KB, with some sizes only slightly
+	//larger than others so that size-compatible reuse applies.
+	size_t size = (4096UL << (i % 11)) + (i % 3)*1024;
+	if( size > (_MAX_SIZE_KB_ << 10) ) {
+		size = (_MAX_SIZE_KB_ << 10) - (i % 3)*1024;
+	}
+	return size;
+}
+
+static void check_budget() {
+#if VICTIM_CACHE_MODE == 2
+	HostConf_t *tconf = getHostConf();
+	CHECK( tconf->device->HI_get_victim_cache_size(tconf->threadID) <= (size_t)tconf->max_mempool_size );
+#endif
+}
+
+//Map a host buffer with acc_copyin(), and check its data with acc_copyout().
+static void check_data(char *hostPtr, size_t size, int seed) {
+	for( size_t i=0; i<size; i++ ) {
+		hostPtr[i] = (char)(i*7 + seed);
+	}
+	acc_copyin(hostPtr, size);
+	memset(hostPtr, 0, size);
+	acc_copyout(hostPtr, size);
+	size_t mismatches = 0;
+	for( size_t i=0; i<size; i++ ) {
+		if( hostPtr[i] != (char)(i*7 + seed) ) {
+			mismatches++;
+		}
+	}
+	CHECK( mismatches == 0 );
+}
+
+static void benchmark() {
+	std::vector<char *> bufs(_NUM_BUFS_);
+	for( int i=0; i<_NUM_BUFS_; i++ ) {
+		bufs[i] = (char *)malloc(buffer_size(i));
+	}
+	srand(_NUM_BUFS_);
+
+	//Recurring host buffers.
+	double stime = my_timer();
+	for( int l=0; l<_ITER_; l++ ) {
+		int i = rand() % _NUM_BUFS_;
+		acc_create(bufs[i], buffer_size(i));
+		CHECK( acc_is_present(bufs[i], buffer_size(i)) );
+		acc_delete(bufs[i], buffer_size(i));
+		check_budget();
+	}
+	double recurringTime = my_timer() - stime;
+
+	//Freshly allocated host buffers.
+	double hostAllocTime = 0.0;
+	stime = my_timer();
+	for( int l=0; l<_ITER_; l++ ) {
+		int i = rand() % _NUM_BUFS_;
+		double htime = my_timer();
+		char *hostPtr = (char *)malloc(buffer_size(i));
+		hostAllocTime += my_timer() - htime;
+		acc_create(hostPtr, buffer_size(i));
+		acc_delete(hostPtr, buffer_size(i));
+		check_budget();
+		htime = my_timer();
+		free(hostPtr);
+		hostAllocTime += my_timer() - htime;
+	}
+	double freshTime = my_timer() - stime - hostAllocTime;
+
+	//Reused device buffers keep the mapped data intact.
+	for( int l=0; l<256; l++ ) {
+		int i = rand() % _NUM_BUFS_;
+		char *hostPtr = (l % 2 == 0) ? bufs[i] : (char *)malloc(buffer_size(i));
+		check_data(hostPtr, buffer_size(i), l);
+		check_budget();
+		if( hostPtr != bufs[i] ) {
+			free(hostPtr);
+		}
+	}
+
+	printf("recurring host buffers: %10.2lf us per acc_create/acc_delete\n", recurringTime*1.0e6/_ITER_);
+	printf("fresh host buffers:     %10.2lf us per acc_create/acc_delete\n", freshTime*1.0e6/_ITER_);
+#if (VICTIM_CACHE_MODE == 2) && defined(_OPENARC_PROFILE_)
+	HostConf_t *tconf = getHostConf();
+	victimcacheshard_t *shard = tconf->device->HI_get_victim_cache_shard(tconf->threadID);
+	printf("victim cache: %ld hits, %ld size-compatible hits, %ld misses, %ld evictions (%lu bytes), %lu bytes cached (budget %ld bytes)\n",
+		shard->hitCnt, shard->sizeHitCnt, shard->missCnt, shard->evictCnt, (unsigned long)shard->evictBytes,
+		(unsigned long)shard->getCachedBytes(), tconf->max_mempool_size);
+#endif
+	for( int i=0; i<_NUM_BUFS_; i++ ) {
+		free(bufs[i]);
+	}
+}
+
+int main(int argc, char** argv) {
+	test_shard();
+	acc_init(acc_device_default);
+	benchmark();
+	acc_shutdown(acc_device_default);
+	if( errors == 0 ) {
+		printf("Verification Successful\n");
+		return 0;
+	} else {
+		printf("Verification Failed with %d errors\n", errors);
+		return 1;
+	}
+}